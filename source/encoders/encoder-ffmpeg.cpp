@@ -21,11 +21,13 @@
 
 #include "encoder-ffmpeg.hpp"
 #include "strings.hpp"
+#include <filesystem>
 #include <sstream>
 #include "codecs/hevc.hpp"
 #include "ffmpeg/tools.hpp"
 #include "handlers/debug_handler.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/obs-tools.hpp"
 #include "plugin.hpp"
 
 #ifdef ENABLE_ENCODER_FFMPEG_AMF
@@ -42,6 +44,22 @@
 #include "handlers/prores_aw_handler.hpp"
 #endif
 
+#ifdef ENABLE_ENCODER_FFMPEG_X264
+#include "handlers/x264_handler.hpp"
+#endif
+
+#ifdef ENABLE_ENCODER_FFMPEG_X265
+#include "handlers/x265_handler.hpp"
+#endif
+
+#ifdef ENABLE_ENCODER_FFMPEG_SVTAV1
+#include "handlers/svtav1_handler.hpp"
+#endif
+
+#ifdef ENABLE_ENCODER_FFMPEG_VPX
+#include "handlers/vpx_handler.hpp"
+#endif
+
 extern "C" {
 #pragma warning(push)
 #pragma warning(disable : 4244)
@@ -65,12 +83,23 @@ extern "C" {
 #define KEY_FFMPEG_CUSTOMSETTINGS "FFmpeg.CustomSettings"
 #define ST_FFMPEG_THREADS "FFmpegEncoder.Threads"
 #define KEY_FFMPEG_THREADS "FFmpeg.Threads"
+#define ST_FFMPEG_THREADTUNING "FFmpegEncoder.ThreadTuning"
+#define ST_FFMPEG_THREADTUNING_(x) "FFmpegEncoder.ThreadTuning." D_VSTR(x)
+#define KEY_FFMPEG_THREADTUNING "FFmpeg.ThreadTuning"
 #define ST_FFMPEG_COLORFORMAT "FFmpegEncoder.ColorFormat"
 #define KEY_FFMPEG_COLORFORMAT "FFmpeg.ColorFormat"
 #define ST_FFMPEG_STANDARDCOMPLIANCE "FFmpegEncoder.StandardCompliance"
 #define KEY_FFMPEG_STANDARDCOMPLIANCE "FFmpeg.StandardCompliance"
 #define ST_FFMPEG_GPU "FFmpegEncoder.GPU"
 #define KEY_FFMPEG_GPU "FFmpeg.GPU"
+#define ST_FFMPEG_GPUCONVERSION "FFmpegEncoder.GPUConversion"
+#define KEY_FFMPEG_GPUCONVERSION "FFmpeg.GPUConversion"
+#define ST_FFMPEG_PARALLELCONTEXTS "FFmpegEncoder.ParallelContexts"
+#define KEY_FFMPEG_PARALLELCONTEXTS "FFmpeg.ParallelContexts"
+#define ST_FFMPEG_QUALITYGOVERNOR "FFmpegEncoder.QualityGovernor"
+#define KEY_FFMPEG_QUALITYGOVERNOR "FFmpeg.QualityGovernor"
+#define ST_FFMPEG_ROI "FFmpegEncoder.ROI"
+#define KEY_FFMPEG_ROI "FFmpeg.ROI"
 
 #define ST_KEYFRAMES "FFmpegEncoder.KeyFrames"
 #define ST_KEYFRAMES_INTERVALTYPE "FFmpegEncoder.KeyFrames.IntervalType"
@@ -94,7 +123,11 @@ ffmpeg_instance::ffmpeg_instance(obs_data_t* settings, obs_encoder_t* self, bool
 
 	  _codec(_factory->get_avcodec()), _context(nullptr), _handler(ffmpeg_manager::get()->get_handler(_codec->name)),
 
-	  _scaler(), _packet(),
+	  _scaler(), _packet(), _gpu_convert(), _raw_frame_time(0), _have_frame_time_origin(false), _frame_time_origin(0),
+
+	  _parallel(), _packet_pool(), _governor(), _template_context(nullptr), _retired_context(nullptr),
+
+	  _roi_offset(0.), _roi_regions(),
 
 	  _hwapi(), _hwinst(),
 
@@ -132,9 +165,8 @@ ffmpeg_instance::ffmpeg_instance(obs_data_t* settings, obs_encoder_t* self, bool
 		throw std::runtime_error("Failed to create encoder context.");
 	}
 
-	// Create 8MB of precached Packet data for use later on.
+	// Packet buffers are provided by the encoder or the packet pool, as receiving a packet drops the old one.
 	av_init_packet(&_packet);
-	av_new_packet(&_packet, 8 * 1024 * 1024); // 8 MB precached Packet size.
 
 	// Initialize
 	if (is_hw) {
@@ -146,16 +178,78 @@ ffmpeg_instance::ffmpeg_instance(obs_data_t* settings, obs_encoder_t* self, bool
 	// Update settings
 	update(settings);
 
+	// Replace the automatic thread count with a measured one, if requested. Until one has been measured in the
+	// background, the automatic thread count is used.
+	if (!is_hw && (obs_data_get_int(settings, KEY_FFMPEG_THREADS) == 0)) {
+		auto target = static_cast<::ffmpeg::thread_target>(obs_data_get_int(settings, KEY_FFMPEG_THREADTUNING));
+
+		::ffmpeg::thread_tuner::result tuned;
+		if (!::ffmpeg::thread_tuner::lookup(_codec, _context, target, tuned)) {
+			::ffmpeg::thread_tuner::schedule(_codec, _context, target);
+		} else {
+			_context->thread_type  = tuned.type;
+			_context->thread_count = tuned.count;
+			_context->delay        = (tuned.type & FF_THREAD_FRAME) ? tuned.count : 0;
+			DLOG_INFO("[%s]     Threading: %s (with %i threads, tuned for %s)", _codec->name,
+					  ::ffmpeg::tools::get_thread_type_name(_context->thread_type), _context->thread_count,
+					  ::ffmpeg::thread_tuner::get_target_name(target));
+		}
+	}
+
+	// Recycle packet buffers instead of allocating one per packet, if the encoder allows it.
+	_packet_pool = std::make_shared<::ffmpeg::packet_pool>();
+	if (!_packet_pool->install(_context)) {
+		DLOG_DEBUG("[%s] Encoder allocates its own packets, packet pool disabled.", _codec->name);
+		_packet_pool.reset();
+	}
+
+	// Keep the configuration around, so that the quality governor can reopen the encoder with faster options.
+	if (!is_hw && obs_data_get_bool(settings, KEY_FFMPEG_QUALITYGOVERNOR) && _handler)
+		_template_context = ::ffmpeg::tools::context_clone(_codec, _context);
+
 	// Initialize Encoder
 	auto gctx = gs::context();
 	int  res  = avcodec_open2(_context, _codec, NULL);
 	if (res < 0) {
 		throw std::runtime_error(::ffmpeg::tools::get_error_description(res));
 	}
+
+	// Spread intra-only encoding across multiple contexts, if requested.
+	if (!is_hw && ::ffmpeg::parallel_encoder::is_supported(_codec)) {
+		if (int64_t count = obs_data_get_int(settings, KEY_FFMPEG_PARALLELCONTEXTS); count > 1) {
+			_parallel = std::make_shared<::ffmpeg::parallel_encoder>(_codec, _context, static_cast<size_t>(count));
+			DLOG_INFO("[%s] Encoding in parallel on %zu contexts.", _codec->name, _parallel->count());
+		}
+	}
+
+	// Watch the time spent per frame and step the encoder preset when it can't keep up, if requested.
+	if (_template_context && !_parallel) {
+		_governor = std::make_shared<::ffmpeg::quality_governor>(static_cast<double>(_context->time_base.num)
+																 / static_cast<double>(_context->time_base.den));
+	} else if (_template_context) {
+		avcodec_free_context(&_template_context);
+	}
+
+	// Start feeding the GPU conversion path, if it is in use.
+	if (_gpu_convert)
+		obs_add_tick_callback(gpu_convert_tick, this);
+
+	// Frames do not carry their video time, so watch the raw output that feeds this encoder. This connects before the
+	// encoder itself, so each frame reaches the callback right before it is encoded.
+	if (!is_hw)
+		video_output_connect(obs_encoder_video(_self), nullptr, raw_frame_time, this);
 }
 
 ffmpeg_instance::~ffmpeg_instance()
 {
+	if (!is_hardware_encode())
+		video_output_disconnect(obs_encoder_video(_self), raw_frame_time, this);
+
+	if (_gpu_convert)
+		obs_remove_tick_callback(gpu_convert_tick, this);
+
+	_parallel.reset();
+
 	auto gctx = gs::context();
 	if (_context) {
 		// Flush encoders that require it.
@@ -171,9 +265,21 @@ ffmpeg_instance::~ffmpeg_instance()
 		avcodec_close(_context);
 		avcodec_free_context(&_context);
 	}
+	if (_retired_context)
+		avcodec_free_context(&_retired_context);
+	if (_template_context)
+		avcodec_free_context(&_template_context);
 
 	av_packet_unref(&_packet);
 
+	if (_packet_pool) {
+		DLOG_INFO("[%s] Packet pool: %" PRIu64 " packets, %" PRIu64 " allocations (%.1f%% reused), %.2f MiB allocated.",
+				  _codec->name, _packet_pool->requests(), _packet_pool->allocations(),
+				  _packet_pool->hit_rate() * 100., static_cast<double>(_packet_pool->memory()) / (1024. * 1024.));
+		_packet_pool.reset();
+	}
+
+	_gpu_convert.reset();
 	_scaler.finalize();
 }
 
@@ -188,8 +294,12 @@ void ffmpeg_instance::get_properties(obs_properties_t* props)
 
 	obs_property_set_enabled(obs_properties_get(props, KEY_FFMPEG_COLORFORMAT), false);
 	obs_property_set_enabled(obs_properties_get(props, KEY_FFMPEG_THREADS), false);
+	obs_property_set_enabled(obs_properties_get(props, KEY_FFMPEG_THREADTUNING), false);
 	obs_property_set_enabled(obs_properties_get(props, KEY_FFMPEG_STANDARDCOMPLIANCE), false);
 	obs_property_set_enabled(obs_properties_get(props, KEY_FFMPEG_GPU), false);
+	obs_property_set_enabled(obs_properties_get(props, KEY_FFMPEG_GPUCONVERSION), false);
+	obs_property_set_enabled(obs_properties_get(props, KEY_FFMPEG_PARALLELCONTEXTS), false);
+	obs_property_set_enabled(obs_properties_get(props, KEY_FFMPEG_QUALITYGOVERNOR), false);
 }
 
 void ffmpeg_instance::migrate(obs_data_t* settings, uint64_t version)
@@ -213,22 +323,32 @@ bool ffmpeg_instance::update(obs_data_t* settings)
 		if (_codec->capabilities & AV_CODEC_CAP_SLICE_THREADS) {
 			_context->thread_type |= FF_THREAD_SLICE;
 		}
+		int64_t threads = obs_data_get_int(settings, KEY_FFMPEG_THREADS);
 		if (_context->thread_type != 0) {
-			int64_t threads = obs_data_get_int(settings, ST_FFMPEG_THREADS);
 			if (threads > 0) {
 				_context->thread_count = static_cast<int>(threads);
 			} else {
 				_context->thread_count = static_cast<int>(std::thread::hardware_concurrency());
 			}
+		} else if (::ffmpeg::tools::has_internal_threading(_codec)) {
+			// A count of 0 lets the encoder pick its own, which it knows better than we do.
+			_context->thread_count = static_cast<int>(std::max<int64_t>(threads, 0));
 		} else {
 			_context->thread_count = 1;
 		}
-		// Frame Delay (Lag In Frames)
-		_context->delay = _context->thread_count;
+		// Frame Delay (Lag In Frames), only frame threading holds frames back.
+		_context->delay = (_context->thread_type & FF_THREAD_FRAME) ? _context->thread_count : 0;
 	} else {
 		_context->delay = 0;
 	}
 
+	// Regions of Interest, negative offsets give regions more quality.
+	if (_handler && _handler->has_roi_support(_factory)) {
+		_roi_offset = -std::clamp(obs_data_get_double(settings, KEY_FFMPEG_ROI) / 100.0, 0.0, 1.0);
+	} else {
+		_roi_offset = 0.;
+	}
+
 	// Apply GPU Selection
 	if (!_hwinst && ::ffmpeg::tools::can_hardware_encode(_codec)) {
 		av_opt_set_int(_context, "gpu", (int)obs_data_get_int(settings, KEY_FFMPEG_GPU), AV_OPT_SEARCH_CHILDREN);
@@ -297,6 +417,7 @@ bool ffmpeg_instance::update(obs_data_t* settings)
 					  _scaler.is_target_full_range() ? "Full" : "Partial");
 			if (!_hwinst)
 				DLOG_INFO("[%s]     On GPU Index: %lli", _codec->name, obs_data_get_int(settings, KEY_FFMPEG_GPU));
+			DLOG_INFO("[%s]     GPU Conversion: %s", _codec->name, _gpu_convert ? "Enabled" : "Disabled");
 		}
 		DLOG_INFO("[%s]     Framerate: %" PRId32 "/%" PRId32 " (%f FPS)", _codec->name, _context->time_base.den,
 				  _context->time_base.num,
@@ -352,6 +473,7 @@ bool ffmpeg_instance::encode_audio(struct encoder_frame* frame, struct encoder_p
 
 bool ffmpeg_instance::encode_video(struct encoder_frame* frame, struct encoder_packet* packet, bool* received_packet)
 {
+	auto                     begin  = std::chrono::high_resolution_clock::now();
 	std::shared_ptr<AVFrame> vframe = pop_free_frame(); // Retrieve an empty frame.
 
 	// Convert frame.
@@ -364,7 +486,12 @@ bool ffmpeg_instance::encode_video(struct encoder_frame* frame, struct encoder_p
 		vframe->color_trc       = _context->color_trc;
 		vframe->pts             = frame->pts;
 
-		if ((_scaler.is_source_full_range() == _scaler.is_target_full_range())
+		// Use the GPU conversion only if it has this exact frame, and fall back to the CPU otherwise.
+		uint64_t timestamp = get_frame_time(frame->pts);
+		uint64_t interval  = video_output_get_frame_time(obs_encoder_video(_self));
+		if (_gpu_convert && _gpu_convert->read(vframe.get(), timestamp, interval / 2)) {
+			// Frame was already converted on the GPU, skip the CPU conversion entirely.
+		} else if ((_scaler.is_source_full_range() == _scaler.is_target_full_range())
 			&& (_scaler.get_source_colorspace() == _scaler.get_target_colorspace())
 			&& (_scaler.get_source_format() == _scaler.get_target_format())) {
 			copy_data(frame, vframe.get());
@@ -377,11 +504,19 @@ bool ffmpeg_instance::encode_video(struct encoder_frame* frame, struct encoder_p
 				return false;
 			}
 		}
+
+		attach_roi(vframe.get(), timestamp);
 	}
 
+	if (_parallel)
+		return encode_parallel(vframe, packet, received_packet);
+
 	if (!encode_avframe(vframe, packet, received_packet))
 		return false;
 
+	if (_governor)
+		govern(std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - begin).count());
+
 	return true;
 }
 
@@ -404,6 +539,8 @@ bool ffmpeg_instance::encode_video(uint32_t handle, int64_t pts, uint64_t lock_k
 	vframe->color_trc       = _context->color_trc;
 	vframe->pts             = pts;
 
+	attach_roi(vframe.get(), get_frame_time(pts));
+
 	if (!encode_avframe(vframe, packet, received_packet))
 		return false;
 
@@ -482,9 +619,79 @@ void ffmpeg_instance::initialize_sw(obs_data_t* settings)
 				 << (_scaler.is_source_full_range() ? "full" : "partial") << " range.";
 			throw std::runtime_error(sstr.str());
 		}
+
+		initialize_gpu_convert(settings);
 	}
 }
 
+void ffmpeg_instance::initialize_gpu_convert(obs_data_t* settings)
+{
+	if (!obs_data_get_bool(settings, KEY_FFMPEG_GPUCONVERSION))
+		return;
+
+	if (!::ffmpeg::gpu_convert::is_supported(_context->pix_fmt)) {
+		DLOG_WARNING("[%s] GPU conversion does not support the color format '%s', using CPU conversion instead.",
+					 _codec->name, ::ffmpeg::tools::get_pixel_format_name(_context->pix_fmt));
+		return;
+	}
+
+	// The main texture is rendered at the base resolution, which the output may still be scaled from.
+	obs_video_info ovi;
+	if (obs_encoder_scaling_enabled(_self) || !obs_get_video_info(&ovi)
+		|| (ovi.base_width != static_cast<uint32_t>(_context->width))
+		|| (ovi.base_height != static_cast<uint32_t>(_context->height))) {
+		DLOG_WARNING("[%s] GPU conversion is not available with rescaled output, using CPU conversion instead.",
+					 _codec->name);
+		return;
+	}
+
+	try {
+		_gpu_convert = std::make_shared<::ffmpeg::gpu_convert>(
+			_context->pix_fmt, static_cast<uint32_t>(_context->width), static_cast<uint32_t>(_context->height),
+			_context->colorspace, _context->color_range == AVCOL_RANGE_JPEG);
+	} catch (const std::exception& ex) {
+		DLOG_WARNING("[%s] Failed to initialize GPU conversion, using CPU conversion instead: %s", _codec->name,
+					 ex.what());
+		_gpu_convert.reset();
+	}
+}
+
+void ffmpeg_instance::gpu_convert_tick(void* ptr, float_t)
+try {
+	auto self = reinterpret_cast<ffmpeg_instance*>(ptr);
+
+	// Runs before the next frame is rendered, so the main texture still holds the last complete frame, while the video
+	// time already is that of the next one.
+	auto     gctx = gs::context();
+	uint64_t time = obs_get_video_frame_time() - video_output_get_frame_time(obs_get_video());
+	self->_gpu_convert->stage(obs_get_main_texture(), time);
+} catch (const std::exception& ex) {
+	DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
+} catch (...) {
+	DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
+}
+
+void ffmpeg_instance::raw_frame_time(void* ptr, struct video_data* frame)
+{
+	reinterpret_cast<ffmpeg_instance*>(ptr)->_raw_frame_time.store(frame->timestamp);
+}
+
+uint64_t ffmpeg_instance::get_frame_time(int64_t pts)
+{
+	// Video time advances by exactly one frame interval per pts step, duplicated frames included.
+	uint64_t offset = static_cast<uint64_t>(av_rescale_q(pts, _context->time_base, AVRational{1, 1000000000}));
+	if (!_have_frame_time_origin) {
+		if (is_hardware_encode()) {
+			// Textures are handed over right after rendering, while the video time already is that of the next frame.
+			_frame_time_origin = obs_get_video_frame_time() - video_output_get_frame_time(obs_get_video()) - offset;
+		} else {
+			_frame_time_origin = _raw_frame_time.load() - offset;
+		}
+		_have_frame_time_origin = true;
+	}
+	return _frame_time_origin + offset;
+}
+
 void ffmpeg_instance::initialize_hw(obs_data_t*)
 {
 #ifndef D_PLATFORM_WINDOWS
@@ -612,12 +819,29 @@ int ffmpeg_instance::receive_packet(bool* received_packet, struct encoder_packet
 
 	{
 		auto gctx = gs::context();
-		res       = avcodec_receive_packet(_context, &_packet);
+		res       = AVERROR_EOF;
+		if (_retired_context) {
+			// Frames sent to a replaced encoder came first, so its packets do too.
+			res = avcodec_receive_packet(_retired_context, &_packet);
+			if (res != 0)
+				avcodec_free_context(&_retired_context);
+		}
+		if (res != 0)
+			res = avcodec_receive_packet(_context, &_packet);
 	}
 	if (res != 0) {
 		return res;
 	}
 
+	output_packet(received_packet, packet);
+
+	push_free_frame(pop_used_frame());
+
+	return res;
+}
+
+void ffmpeg_instance::output_packet(bool* received_packet, struct encoder_packet* packet)
+{
 	if (!_have_first_frame) {
 		if (_codec->id == AV_CODEC_ID_H264) {
 			uint8_t*    tmp_packet;
@@ -666,10 +890,6 @@ int ffmpeg_instance::receive_packet(bool* received_packet, struct encoder_packet
 	packet->keyframe      = !!(_packet.flags & AV_PKT_FLAG_KEY);
 	packet->drop_priority = packet->keyframe ? 0 : 1;
 	*received_packet      = true;
-
-	push_free_frame(pop_used_frame());
-
-	return res;
 }
 
 int ffmpeg_instance::send_frame(std::shared_ptr<AVFrame> const frame)
@@ -762,6 +982,122 @@ bool ffmpeg_instance::encode_avframe(std::shared_ptr<AVFrame> frame, encoder_pac
 	return true;
 }
 
+bool ffmpeg_instance::encode_parallel(std::shared_ptr<AVFrame> frame, encoder_packet* packet, bool* received_packet)
+{
+	_parallel->push(frame);
+
+	// Keep at most one frame per context in flight, only wait once all of them are busy.
+	::ffmpeg::parallel_encoder::result res;
+	if (!_parallel->pop(res, _parallel->pending() > _parallel->count()))
+		return true;
+
+	push_free_frame(res.frame);
+	if (res.error != 0) {
+		av_packet_free(&res.packet);
+		DLOG_ERROR("Failed to encode frame: %s (%" PRId32 ").", ::ffmpeg::tools::get_error_description(res.error),
+				   res.error);
+		return false;
+	}
+
+	av_packet_unref(&_packet);
+	av_packet_move_ref(&_packet, res.packet);
+	av_packet_free(&res.packet);
+
+	output_packet(received_packet, packet);
+	return true;
+}
+
+void ffmpeg_instance::govern(double seconds)
+{
+	int32_t step = _governor->record(seconds);
+	if (double before, after; _governor->settled(before, after)) {
+		DLOG_INFO("[%s] Encoding took %.0f%% of the frame interval before the last step, and %.0f%% after it.",
+				  _codec->name, before * 100., after * 100.);
+	}
+
+	// Wait for the previous encoder to drain before replacing the current one.
+	if ((step == 0) || _retired_context)
+		return;
+
+	double load    = _governor->load() * 100.;
+	bool   success = switch_speed_level(_governor->level() + step);
+	_governor->applied(step, success);
+
+	if (success) {
+		DLOG_INFO("[%s] Encoding takes %.0f%% of the frame interval, %s (now %" PRId32 " steps faster).", _codec->name,
+				  load, (step > 0) ? "trading quality for speed" : "restoring quality", _governor->level());
+	} else if (step > 0) {
+		DLOG_WARNING("[%s] Encoding takes %.0f%% of the frame interval, but the encoder can't go any faster.",
+					 _codec->name, load);
+	}
+}
+
+bool ffmpeg_instance::switch_speed_level(int32_t level)
+try {
+	// FFmpeg only applies the speed options of these encoders when opening them, so open a faster copy.
+	AVCodecContext* context = ::ffmpeg::tools::context_clone(_codec, _template_context);
+	if (!_handler->set_speed_level(level, _codec, context)) {
+		avcodec_free_context(&context);
+		return false;
+	}
+
+	auto gctx = gs::context();
+	if (int res = avcodec_open2(context, _codec, NULL); res < 0) {
+		avcodec_free_context(&context);
+		throw std::runtime_error(::ffmpeg::tools::get_error_description(res));
+	}
+
+	// The copy starts with a keyframe and takes over the next frame, while the current encoder drains the frames
+	// it still holds. Its delay is the same, so it has packets ready about when the old one runs out.
+	avcodec_send_frame(_context, nullptr);
+	_retired_context = _context;
+	_context         = context;
+	return true;
+} catch (const std::exception& ex) {
+	DLOG_ERROR("[%s] Failed to reopen the encoder with different options: %s", _codec->name, ex.what());
+	return false;
+}
+
+void ffmpeg_instance::attach_roi(AVFrame* frame, uint64_t timestamp)
+{
+	// Frames are recycled, so regions from an earlier use must go either way.
+	av_frame_remove_side_data(frame, AV_FRAME_DATA_REGIONS_OF_INTEREST);
+
+	auto channel = obs::roi_channel::get();
+	if ((_roi_offset == 0.) || !channel)
+		return;
+
+	// Regions are only useful while they still match the frame, anything older is dropped.
+	channel->gather(timestamp, 500000000ull, _roi_regions);
+	if (_roi_regions.empty())
+		return;
+
+	AVFrameSideData* sd = av_frame_new_side_data(frame, AV_FRAME_DATA_REGIONS_OF_INTEREST,
+												 static_cast<int>(sizeof(AVRegionOfInterest) * _roi_regions.size()));
+	if (!sd)
+		return;
+
+	// Encoders treat the first region as the most important one if regions overlap.
+	std::stable_sort(_roi_regions.begin(), _roi_regions.end(),
+					 [](const obs::roi_channel::region& a, const obs::roi_channel::region& b) {
+						 return a.weight > b.weight;
+					 });
+
+	AVRegionOfInterest* rois   = reinterpret_cast<AVRegionOfInterest*>(sd->data);
+	float_t             width  = static_cast<float_t>(_context->width);
+	float_t             height = static_cast<float_t>(_context->height);
+	for (std::size_t idx = 0; idx < _roi_regions.size(); idx++) {
+		auto& region = _roi_regions[idx];
+
+		rois[idx].self_size = sizeof(AVRegionOfInterest);
+		rois[idx].left      = static_cast<int>(std::floor(region.x * width));
+		rois[idx].top       = static_cast<int>(std::floor(region.y * height));
+		rois[idx].right     = static_cast<int>(std::ceil((region.x + region.width) * width));
+		rois[idx].bottom    = static_cast<int>(std::ceil((region.y + region.height) * height));
+		rois[idx].qoffset   = av_make_q(static_cast<int>(std::lround(_roi_offset * region.weight * 1000.)), 1000);
+	}
+}
+
 bool ffmpeg_instance::is_hardware_encode()
 {
 	return _hwinst != nullptr;
@@ -902,39 +1238,39 @@ void ffmpeg_instance::parse_ffmpeg_commandline(std::string text)
 	}
 }
 
-ffmpeg_factory::ffmpeg_factory(const AVCodec* codec) : _avcodec(codec)
+ffmpeg_factory::ffmpeg_factory(const AVCodec* codec) : _avcodec_name(codec->name), _avcodec(codec)
 {
 	// Generate default identifier.
 	{
 		std::stringstream str;
-		str << PREFIX << _avcodec->name;
+		str << PREFIX << codec->name;
 		_id = str.str();
 	}
 
 	{ // Generate default name.
 		std::stringstream str;
-		if (_avcodec->long_name) {
-			str << _avcodec->long_name;
-			str << " (" << _avcodec->name << ")";
+		if (codec->long_name) {
+			str << codec->long_name;
+			str << " (" << codec->name << ")";
 		} else {
-			str << _avcodec->name;
+			str << codec->name;
 		}
 		str << D_TRANSLATE(ST_FFMPEG_SUFFIX);
 		_name = str.str();
 	}
 
 	// Try and find a codec name that libOBS understands.
-	if (auto* desc = avcodec_descriptor_get(_avcodec->id); desc) {
+	if (auto* desc = avcodec_descriptor_get(codec->id); desc) {
 		_codec = desc->name;
 	} else {
 		// If FFmpeg doesn't know better, fall back to the name.
-		_codec = _avcodec->name;
+		_codec = codec->name;
 	}
 
 	// Find any available handlers for this codec.
-	if (_handler = ffmpeg_manager::get()->get_handler(_avcodec->name); _handler) {
+	if (_handler = ffmpeg_manager::get()->get_handler(codec->name); _handler) {
 		// Override any found info with the one specified by the handler.
-		_handler->adjust_info(this, _avcodec, _id, _name, _codec);
+		_handler->adjust_info(this, codec, _id, _name, _codec);
 
 		// Add texture capability for hardware encoders.
 		if (_handler->is_hardware_encoder(this)) {
@@ -946,21 +1282,40 @@ ffmpeg_factory::ffmpeg_factory(const AVCodec* codec) : _avcodec(codec)
 	}
 
 	{ // Build Info structure.
-		_info.id    = _id.c_str();
-		_info.codec = _codec.c_str();
-		if (_avcodec->type == AVMediaType::AVMEDIA_TYPE_VIDEO) {
+		if (codec->type == AVMediaType::AVMEDIA_TYPE_VIDEO) {
 			_info.type = obs_encoder_type::OBS_ENCODER_VIDEO;
-		} else if (_avcodec->type == AVMediaType::AVMEDIA_TYPE_AUDIO) {
+		} else if (codec->type == AVMediaType::AVMEDIA_TYPE_AUDIO) {
 			_info.type = obs_encoder_type::OBS_ENCODER_AUDIO;
 		}
 	}
+}
+
+ffmpeg_factory::ffmpeg_factory(obs_data_t* cached)
+	: _avcodec_name(obs_data_get_string(cached, "Name")), _avcodec(nullptr), _handler()
+{
+	// Restore everything libOBS needs from the cache, the codec itself is only looked up once it is used.
+	_id    = std::string(PREFIX) + _avcodec_name;
+	_codec = obs_data_get_string(cached, "Codec");
+	{
+		std::stringstream str;
+		str << obs_data_get_string(cached, "LongName") << D_TRANSLATE(ST_FFMPEG_SUFFIX);
+		_name = str.str();
+	}
+	_info.type = static_cast<obs_encoder_type>(obs_data_get_int(cached, "Type"));
+	_info.caps = static_cast<uint32_t>(obs_data_get_int(cached, "Capabilities"));
+}
+
+void ffmpeg_factory::register_types()
+{
+	_info.id    = _id.c_str();
+	_info.codec = _codec.c_str();
 
 	// Register encoder and proxies.
 	finish_setup();
 	const std::string proxies[] = {
-		std::string("streamfx--") + _avcodec->name,
-		std::string("StreamFX-") + _avcodec->name,
-		std::string("obs-ffmpeg-encoder_") + _avcodec->name,
+		std::string("streamfx--") + _avcodec_name,
+		std::string("StreamFX-") + _avcodec_name,
+		std::string("obs-ffmpeg-encoder_") + _avcodec_name,
 	};
 	for (auto proxy_id : proxies) {
 		register_proxy(proxy_id);
@@ -980,10 +1335,12 @@ const char* ffmpeg_factory::get_name()
 
 void ffmpeg_factory::get_defaults2(obs_data_t* settings)
 {
+	const AVCodec* codec = get_avcodec();
+
 	if (_handler)
-		_handler->get_defaults(settings, _avcodec, nullptr, _handler->is_hardware_encoder(this));
+		_handler->get_defaults(settings, codec, nullptr, _handler->is_hardware_encoder(this));
 
-	if ((_avcodec->capabilities & AV_CODEC_CAP_INTRA_ONLY) == 0) {
+	if ((codec->capabilities & AV_CODEC_CAP_INTRA_ONLY) == 0) {
 		obs_data_set_default_int(settings, KEY_KEYFRAMES_INTERVALTYPE, 0);
 		obs_data_set_default_double(settings, KEY_KEYFRAMES_INTERVAL_SECONDS, 2.0);
 		obs_data_set_default_int(settings, KEY_KEYFRAMES_INTERVAL_FRAMES, 300);
@@ -994,7 +1351,13 @@ void ffmpeg_factory::get_defaults2(obs_data_t* settings)
 		obs_data_set_default_string(settings, KEY_FFMPEG_CUSTOMSETTINGS, "");
 		obs_data_set_default_int(settings, KEY_FFMPEG_COLORFORMAT, static_cast<int64_t>(AV_PIX_FMT_NONE));
 		obs_data_set_default_int(settings, KEY_FFMPEG_THREADS, 0);
+		obs_data_set_default_int(settings, KEY_FFMPEG_THREADTUNING,
+								 static_cast<int64_t>(::ffmpeg::thread_target::NONE));
 		obs_data_set_default_int(settings, KEY_FFMPEG_GPU, -1);
+		obs_data_set_default_bool(settings, KEY_FFMPEG_GPUCONVERSION, false);
+		obs_data_set_default_int(settings, KEY_FFMPEG_PARALLELCONTEXTS, 0);
+		obs_data_set_default_bool(settings, KEY_FFMPEG_QUALITYGOVERNOR, false);
+		obs_data_set_default_double(settings, KEY_FFMPEG_ROI, 0.);
 		obs_data_set_default_int(settings, KEY_FFMPEG_STANDARDCOMPLIANCE, FF_COMPLIANCE_STRICT);
 	}
 }
@@ -1015,6 +1378,7 @@ try {
 
 obs_properties_t* ffmpeg_factory::get_properties2(instance_t* data)
 {
+	const AVCodec*    codec = get_avcodec();
 	obs_properties_t* props = obs_properties_create();
 
 	if (data) {
@@ -1022,7 +1386,7 @@ obs_properties_t* ffmpeg_factory::get_properties2(instance_t* data)
 	}
 
 	if (_handler)
-		_handler->get_properties(props, _avcodec, nullptr, _handler->is_hardware_encoder(this));
+		_handler->get_properties(props, codec, nullptr, _handler->is_hardware_encoder(this));
 
 	if (_handler && _handler->has_keyframe_support(this)) {
 		// Key-Frame Options
@@ -1074,18 +1438,54 @@ obs_properties_t* ffmpeg_factory::get_properties2(instance_t* data)
 			obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_FFMPEG_GPU)));
 		}
 
+		if (_handler && !_handler->is_hardware_encoder(this)) {
+			auto p = obs_properties_add_bool(grp, KEY_FFMPEG_GPUCONVERSION, D_TRANSLATE(ST_FFMPEG_GPUCONVERSION));
+			obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_FFMPEG_GPUCONVERSION)));
+		}
+
 		if (_handler && _handler->has_threading_support(this)) {
 			auto p = obs_properties_add_int_slider(grp, KEY_FFMPEG_THREADS, D_TRANSLATE(ST_FFMPEG_THREADS), 0,
 												   static_cast<int64_t>(std::thread::hardware_concurrency() * 2), 1);
 			obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_FFMPEG_THREADS)));
 		}
 
+		if (_handler && _handler->has_threading_support(this) && !_handler->is_hardware_encoder(this)) {
+			auto p = obs_properties_add_list(grp, KEY_FFMPEG_THREADTUNING, D_TRANSLATE(ST_FFMPEG_THREADTUNING),
+											 OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+			obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_FFMPEG_THREADTUNING)));
+			obs_property_list_add_int(p, D_TRANSLATE(S_STATE_DISABLED),
+									  static_cast<int64_t>(::ffmpeg::thread_target::NONE));
+			obs_property_list_add_int(p, D_TRANSLATE(ST_FFMPEG_THREADTUNING_(Latency)),
+									  static_cast<int64_t>(::ffmpeg::thread_target::LATENCY));
+			obs_property_list_add_int(p, D_TRANSLATE(ST_FFMPEG_THREADTUNING_(Throughput)),
+									  static_cast<int64_t>(::ffmpeg::thread_target::THROUGHPUT));
+		}
+
+		if (_handler && !_handler->is_hardware_encoder(this) && ::ffmpeg::parallel_encoder::is_supported(codec)) {
+			auto p = obs_properties_add_int_slider(grp, KEY_FFMPEG_PARALLELCONTEXTS,
+												   D_TRANSLATE(ST_FFMPEG_PARALLELCONTEXTS), 0,
+												   static_cast<int64_t>(std::thread::hardware_concurrency()), 1);
+			obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_FFMPEG_PARALLELCONTEXTS)));
+		}
+
+		if (_handler && !_handler->is_hardware_encoder(this)) {
+			auto p =
+				obs_properties_add_bool(grp, KEY_FFMPEG_QUALITYGOVERNOR, D_TRANSLATE(ST_FFMPEG_QUALITYGOVERNOR));
+			obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_FFMPEG_QUALITYGOVERNOR)));
+		}
+
+		if (_handler && _handler->has_roi_support(this)) {
+			auto p = obs_properties_add_float_slider(grp, KEY_FFMPEG_ROI, D_TRANSLATE(ST_FFMPEG_ROI), 0., 100., 0.1);
+			obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_FFMPEG_ROI)));
+			obs_property_float_set_suffix(p, " %");
+		}
+
 		if (_handler && _handler->has_pixel_format_support(this)) {
 			auto p = obs_properties_add_list(grp, KEY_FFMPEG_COLORFORMAT, D_TRANSLATE(ST_FFMPEG_COLORFORMAT),
 											 OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
 			obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_FFMPEG_COLORFORMAT)));
 			obs_property_list_add_int(p, D_TRANSLATE(S_STATE_AUTOMATIC), static_cast<int64_t>(AV_PIX_FMT_NONE));
-			for (auto ptr = _avcodec->pix_fmts; *ptr != AV_PIX_FMT_NONE; ptr++) {
+			for (auto ptr = codec->pix_fmts; *ptr != AV_PIX_FMT_NONE; ptr++) {
 				obs_property_list_add_int(p, ::ffmpeg::tools::get_pixel_format_name(*ptr), static_cast<int64_t>(*ptr));
 			}
 		}
@@ -1111,7 +1511,14 @@ obs_properties_t* ffmpeg_factory::get_properties2(instance_t* data)
 
 const AVCodec* ffmpeg_factory::get_avcodec()
 {
-	return _avcodec;
+	if (const AVCodec* codec = _avcodec.load(); codec)
+		return codec;
+
+	const AVCodec* codec = avcodec_find_encoder_by_name(_avcodec_name.c_str());
+	if (!codec)
+		throw std::runtime_error("Encoder is not available in this version of FFmpeg.");
+	_avcodec.store(codec);
+	return codec;
 }
 
 obs_encoder_info* streamfx::encoder::ffmpeg::ffmpeg_factory::get_info()
@@ -1119,7 +1526,24 @@ obs_encoder_info* streamfx::encoder::ffmpeg::ffmpeg_factory::get_info()
 	return &_info;
 }
 
-ffmpeg_manager::ffmpeg_manager() : _factories(), _handlers(), _debug_handler()
+void ffmpeg_factory::save(obs_data_t* cached)
+{
+	const AVCodec* codec = get_avcodec();
+
+	obs_data_set_string(cached, "Name", _avcodec_name.c_str());
+	if (codec->long_name) {
+		std::stringstream str;
+		str << codec->long_name << " (" << codec->name << ")";
+		obs_data_set_string(cached, "LongName", str.str().c_str());
+	} else {
+		obs_data_set_string(cached, "LongName", codec->name);
+	}
+	obs_data_set_string(cached, "Codec", _codec.c_str());
+	obs_data_set_int(cached, "Type", static_cast<int64_t>(_info.type));
+	obs_data_set_int(cached, "Capabilities", static_cast<int64_t>(_info.caps));
+}
+
+ffmpeg_manager::ffmpeg_manager() : _factories(), _handlers(), _debug_handler(), _probed(false)
 {
 	// Handlers
 	_debug_handler = ::std::make_shared<handler::debug_handler>();
@@ -1134,6 +1558,22 @@ ffmpeg_manager::ffmpeg_manager() : _factories(), _handlers(), _debug_handler()
 #ifdef ENABLE_ENCODER_FFMPEG_PRORES
 	register_handler("prores_aw", ::std::make_shared<handler::prores_aw_handler>());
 #endif
+#ifdef ENABLE_ENCODER_FFMPEG_X264
+	register_handler("libx264", ::std::make_shared<handler::x264_handler>());
+#endif
+#ifdef ENABLE_ENCODER_FFMPEG_X265
+	register_handler("libx265", ::std::make_shared<handler::x265_handler>());
+#endif
+#ifdef ENABLE_ENCODER_FFMPEG_SVTAV1
+	register_handler("libsvtav1", ::std::make_shared<handler::svtav1_handler>());
+#endif
+#ifdef ENABLE_ENCODER_FFMPEG_VPX
+	{
+		auto vpx = ::std::make_shared<handler::vpx_handler>();
+		register_handler("libvpx", vpx);
+		register_handler("libvpx-vp9", vpx);
+	}
+#endif
 }
 
 ffmpeg_manager::~ffmpeg_manager()
@@ -1142,6 +1582,34 @@ ffmpeg_manager::~ffmpeg_manager()
 }
 
 void ffmpeg_manager::register_encoders()
+{
+	auto begin = std::chrono::high_resolution_clock::now();
+
+	for (auto& kv : _factories) {
+		kv.second->register_types();
+	}
+	if (_probed)
+		save_cache();
+
+	auto time = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - begin);
+	DLOG_INFO("Registered %" PRIu64 " encoders in %.2f ms.", static_cast<uint64_t>(_factories.size()), time.count());
+}
+
+void ffmpeg_manager::find_encoders()
+{
+	auto begin = std::chrono::high_resolution_clock::now();
+
+	// Probing every encoder that libavcodec offers is slow with a full build, so try the cache first.
+	_probed = !load_cache();
+	if (_probed)
+		probe_encoders();
+
+	auto time = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - begin);
+	DLOG_INFO("Found %" PRIu64 " encoders %s in %.2f ms.", static_cast<uint64_t>(_factories.size()),
+			  _probed ? "by probing" : "from cache", time.count());
+}
+
+void ffmpeg_manager::probe_encoders()
 {
 	// Encoders
 #if FF_API_NEXT
@@ -1153,7 +1621,7 @@ void ffmpeg_manager::register_encoders()
 
 		if ((codec->type == AVMediaType::AVMEDIA_TYPE_AUDIO) || (codec->type == AVMediaType::AVMEDIA_TYPE_VIDEO)) {
 			try {
-				_factories.emplace(codec, std::make_shared<ffmpeg_factory>(codec));
+				_factories.emplace(codec->name, std::make_shared<ffmpeg_factory>(codec));
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Failed to register encoder '%s': %s", codec->name, ex.what());
 			}
@@ -1168,13 +1636,14 @@ void ffmpeg_manager::register_encoders()
 
 		if ((codec->type == AVMediaType::AVMEDIA_TYPE_AUDIO) || (codec->type == AVMediaType::AVMEDIA_TYPE_VIDEO)) {
 			try {
-				_factories.emplace(codec, std::make_shared<ffmpeg_factory>(codec));
+				_factories.emplace(codec->name, std::make_shared<ffmpeg_factory>(codec));
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Failed to register encoder '%s': %s", codec->name, ex.what());
 			}
 		}
 	}
 #endif
+
 }
 
 void ffmpeg_manager::register_handler(std::string codec, std::shared_ptr<handler::handler> handler)
@@ -1199,16 +1668,102 @@ bool ffmpeg_manager::has_handler(std::string codec)
 	return (_handlers.find(codec) != _handlers.end());
 }
 
+std::string ffmpeg_manager::get_cache_identity()
+{
+	// Anything that changes the list of encoders or what we register for them must be part of this.
+	std::stringstream str;
+	str << STREAMFX_VERSION << "-" << avcodec_version() << "-" << std::hex
+		<< std::hash<std::string>{}(avcodec_configuration());
+	for (auto kv : _handlers) {
+		str << "-" << kv.first;
+	}
+#ifdef _DEBUG
+	str << "-debug";
+#endif
+	return str.str();
+}
+
+bool ffmpeg_manager::load_cache()
+try {
+	auto path = streamfx::config_file_path("cache/encoder-ffmpeg.json");
+	if (!std::filesystem::exists(path))
+		return false;
+
+	std::shared_ptr<obs_data_t> data{obs_data_create_from_json_file(path.u8string().c_str()), obs::obs_data_deleter};
+	if (!data)
+		return false;
+
+	if (get_cache_identity() != obs_data_get_string(data.get(), "Identity")) {
+		DLOG_INFO("Encoder cache is out of date, probing all available encoders.");
+		return false;
+	}
+
+	std::shared_ptr<obs_data_array_t> encoders{obs_data_get_array(data.get(), "Encoders"), obs::obs_data_array_deleter};
+	if (!encoders)
+		return false;
+
+	for (size_t idx = 0, edx = obs_data_array_count(encoders.get()); idx < edx; idx++) {
+		std::shared_ptr<obs_data_t> entry{obs_data_array_item(encoders.get(), idx), obs::obs_data_deleter};
+		std::string                 name = obs_data_get_string(entry.get(), "Name");
+		try {
+			if (get_handler(name)) {
+				// Handlers may depend on the state of the system (drivers, hardware), so always probe these.
+				const AVCodec* codec = avcodec_find_encoder_by_name(name.c_str());
+				if (!codec)
+					throw std::runtime_error("Encoder is not available in this version of FFmpeg.");
+				_factories.emplace(name, std::make_shared<ffmpeg_factory>(codec));
+			} else {
+				_factories.emplace(name, std::make_shared<ffmpeg_factory>(entry.get()));
+			}
+		} catch (const std::exception& ex) {
+			DLOG_ERROR("Failed to register encoder '%s': %s", name.c_str(), ex.what());
+		}
+	}
+
+	return true;
+} catch (const std::exception& ex) {
+	DLOG_WARNING("Failed to load encoder cache: %s", ex.what());
+	return false;
+}
+
+void ffmpeg_manager::save_cache()
+try {
+	std::shared_ptr<obs_data_t>       data{obs_data_create(), obs::obs_data_deleter};
+	std::shared_ptr<obs_data_array_t> encoders{obs_data_array_create(), obs::obs_data_array_deleter};
+
+	for (auto kv : _factories) {
+		std::shared_ptr<obs_data_t> entry{obs_data_create(), obs::obs_data_deleter};
+		kv.second->save(entry.get());
+		obs_data_array_push_back(encoders.get(), entry.get());
+	}
+	obs_data_set_string(data.get(), "Identity", get_cache_identity().c_str());
+	obs_data_set_array(data.get(), "Encoders", encoders.get());
+
+	auto path = streamfx::config_file_path("cache/encoder-ffmpeg.json");
+	std::filesystem::create_directories(path.parent_path());
+	if (!obs_data_save_json_safe(data.get(), path.u8string().c_str(), ".tmp", ".bk"))
+		throw std::runtime_error("Failed to write file.");
+} catch (const std::exception& ex) {
+	DLOG_WARNING("Failed to save encoder cache: %s", ex.what());
+}
+
 std::shared_ptr<ffmpeg_manager> _ffmepg_encoder_factory_instance = nullptr;
 
-void ffmpeg_manager::initialize()
+void ffmpeg_manager::prepare()
 {
 	if (!_ffmepg_encoder_factory_instance) {
 		_ffmepg_encoder_factory_instance = std::make_shared<ffmpeg_manager>();
-		_ffmepg_encoder_factory_instance->register_encoders();
+		_ffmepg_encoder_factory_instance->find_encoders();
 	}
 }
 
+void ffmpeg_manager::initialize()
+{
+	// Usually prepared on the thread pool already, but registering has to happen here.
+	prepare();
+	_ffmepg_encoder_factory_instance->register_encoders();
+}
+
 void ffmpeg_manager::finalize()
 {
 	_ffmepg_encoder_factory_instance.reset();
@@ -21,6 +21,7 @@
 
 #pragma once
 #include "common.hpp"
+#include <atomic>
 #include <condition_variable>
 #include <map>
 #include <mutex>
@@ -29,10 +30,16 @@
 #include <thread>
 #include <vector>
 #include "ffmpeg/avframe-queue.hpp"
+#include "ffmpeg/gpu-convert.hpp"
+#include "ffmpeg/packet-pool.hpp"
+#include "ffmpeg/parallel-encoder.hpp"
+#include "ffmpeg/quality-governor.hpp"
+#include "ffmpeg/thread-tuner.hpp"
 #include "ffmpeg/hwapi/base.hpp"
 #include "ffmpeg/swscale.hpp"
 #include "handlers/handler.hpp"
 #include "obs/obs-encoder-factory.hpp"
+#include "obs/obs-roi-channel.hpp"
 
 extern "C" {
 #ifdef _MSC_VER
@@ -60,6 +67,24 @@ namespace streamfx::encoder::ffmpeg {
 		::ffmpeg::swscale _scaler;
 		AVPacket          _packet;
 
+		std::shared_ptr<::ffmpeg::gpu_convert> _gpu_convert;
+
+		// Video time of the raw frame that is about to be encoded, and of the frame with pts 0.
+		std::atomic<uint64_t> _raw_frame_time;
+		bool                  _have_frame_time_origin;
+		uint64_t              _frame_time_origin;
+
+		std::shared_ptr<::ffmpeg::parallel_encoder> _parallel;
+
+		std::shared_ptr<::ffmpeg::packet_pool> _packet_pool;
+
+		std::shared_ptr<::ffmpeg::quality_governor> _governor;
+		AVCodecContext*                             _template_context; // As configured, before it was opened.
+		AVCodecContext*                             _retired_context;  // Replaced, but still has packets to drain.
+
+		double_t                              _roi_offset;
+		std::vector<obs::roi_channel::region> _roi_regions;
+
 		std::shared_ptr<::ffmpeg::hwapi::base>     _hwapi;
 		std::shared_ptr<::ffmpeg::hwapi::instance> _hwinst;
 
@@ -103,6 +128,14 @@ namespace streamfx::encoder::ffmpeg {
 		public:
 		void initialize_sw(obs_data_t* settings);
 		void initialize_hw(obs_data_t* settings);
+		void initialize_gpu_convert(obs_data_t* settings);
+
+		static void gpu_convert_tick(void* ptr, float_t seconds);
+
+		static void raw_frame_time(void* ptr, struct video_data* frame);
+
+		// Video time of the frame with the given pts, which is what regions of interest are recorded against.
+		uint64_t get_frame_time(int64_t pts);
 
 		void                     push_free_frame(std::shared_ptr<AVFrame> frame);
 		std::shared_ptr<AVFrame> pop_free_frame();
@@ -112,10 +145,20 @@ namespace streamfx::encoder::ffmpeg {
 
 		int receive_packet(bool* received_packet, struct encoder_packet* packet);
 
+		void output_packet(bool* received_packet, struct encoder_packet* packet);
+
 		int send_frame(std::shared_ptr<AVFrame> frame);
 
 		bool encode_avframe(std::shared_ptr<AVFrame> frame, struct encoder_packet* packet, bool* received_packet);
 
+		bool encode_parallel(std::shared_ptr<AVFrame> frame, struct encoder_packet* packet, bool* received_packet);
+
+		void govern(double seconds);
+
+		bool switch_speed_level(int32_t level);
+
+		void attach_roi(AVFrame* frame, uint64_t timestamp);
+
 		public: // Handler API
 		bool is_hardware_encode();
 
@@ -131,12 +174,14 @@ namespace streamfx::encoder::ffmpeg {
 		std::string _codec;
 		std::string _name;
 
-		const AVCodec* _avcodec;
+		std::string                 _avcodec_name;
+		std::atomic<const AVCodec*> _avcodec;
 
 		std::shared_ptr<handler::handler> _handler;
 
 		public:
 		ffmpeg_factory(const AVCodec* codec);
+		ffmpeg_factory(obs_data_t* cached);
 		virtual ~ffmpeg_factory();
 
 		const char* get_name() override;
@@ -149,12 +194,18 @@ namespace streamfx::encoder::ffmpeg {
 		const AVCodec* get_avcodec();
 
 		obs_encoder_info* get_info();
+
+		void save(obs_data_t* cached);
+
+		/** Register the encoder and its proxies with libOBS, which only works on the thread loading the module. */
+		void register_types();
 	};
 
 	class ffmpeg_manager {
-		std::map<const AVCodec*, std::shared_ptr<ffmpeg_factory>> _factories;
-		std::map<std::string, std::shared_ptr<handler::handler>>  _handlers;
-		std::shared_ptr<handler::handler>                         _debug_handler;
+		std::map<std::string, std::shared_ptr<ffmpeg_factory>>   _factories;
+		std::map<std::string, std::shared_ptr<handler::handler>> _handlers;
+		std::shared_ptr<handler::handler>                        _debug_handler;
+		bool                                                     _probed;
 
 		public:
 		ffmpeg_manager();
@@ -168,7 +219,21 @@ namespace streamfx::encoder::ffmpeg {
 
 		bool has_handler(std::string codec);
 
+		private:
+		void find_encoders();
+
+		void probe_encoders();
+
+		std::string get_cache_identity();
+
+		bool load_cache();
+
+		void save_cache();
+
 		public: // Singleton
+		/** Create the manager and find all encoders without registering them, so it may run on any thread. */
+		static void prepare();
+
 		static void initialize();
 
 		static void finalize();
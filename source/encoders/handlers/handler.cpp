@@ -21,6 +21,7 @@
 
 #include "handler.hpp"
 #include "../encoder-ffmpeg.hpp"
+#include "ffmpeg/tools.hpp"
 
 using namespace streamfx::encoder::ffmpeg;
 
@@ -36,10 +37,16 @@ bool handler::handler::is_hardware_encoder(ffmpeg_factory* instance)
 
 bool handler::handler::has_threading_support(ffmpeg_factory* instance)
 {
-	return (instance->get_avcodec()->capabilities & (AV_CODEC_CAP_FRAME_THREADS | AV_CODEC_CAP_SLICE_THREADS));
+	return (instance->get_avcodec()->capabilities & (AV_CODEC_CAP_FRAME_THREADS | AV_CODEC_CAP_SLICE_THREADS))
+		   || ::ffmpeg::tools::has_internal_threading(instance->get_avcodec());
 }
 
 bool handler::handler::has_pixel_format_support(ffmpeg_factory* instance)
 {
 	return (instance->get_avcodec()->pix_fmts != nullptr);
 }
+
+bool handler::handler::has_roi_support(ffmpeg_factory* instance)
+{
+	return false;
+}
@@ -56,6 +56,9 @@ namespace streamfx::encoder::ffmpeg {
 
 			virtual bool has_pixel_format_support(ffmpeg_factory* instance);
 
+			// Does the encoder honor AV_FRAME_DATA_REGIONS_OF_INTEREST side data?
+			virtual bool has_roi_support(ffmpeg_factory* instance);
+
 			public /*settings*/:
 			virtual void get_properties(obs_properties_t* props, const AVCodec* codec, AVCodecContext* context,
 										bool hw_encode){};
@@ -75,6 +78,14 @@ namespace streamfx::encoder::ffmpeg {
 											  AVCodecContext* context){};
 
 			virtual void process_avpacket(AVPacket& packet, const AVCodec* codec, AVCodecContext* context){};
+
+			// Configures an unopened copy of the encoder context to run 'level' steps faster than configured, which
+			// then replaces the running encoder. Anything that ends up in the stream headers must stay as it is, and
+			// level 0 must leave the context unchanged. Returns false if the encoder can't go that fast.
+			virtual bool set_speed_level(int32_t level, const AVCodec* codec, AVCodecContext* context)
+			{
+				return false;
+			};
 		};
 	} // namespace handler
 } // namespace streamfx::encoder::ffmpeg
@@ -0,0 +1,184 @@
+// FFMPEG Video Encoder Integration for OBS Studio
+// Copyright (c) 2020 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "software_shared.hpp"
+#include <algorithm>
+#include <sstream>
+#include "strings.hpp"
+#include "ffmpeg/tools.hpp"
+#include "plugin.hpp"
+
+extern "C" {
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4242 4244 4365)
+#endif
+#include <obs-module.h>
+#include <libavutil/mem.h>
+#include <libavutil/pixdesc.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+}
+
+#define ST_PROFILE "FFmpegEncoder.Software.Performance"
+#define ST_PROFILE_(x) ST_PROFILE "." D_VSTR(x)
+
+#define KEY_PROFILE "Performance"
+
+using namespace streamfx::encoder::ffmpeg::handler;
+
+std::map<software::profile, std::string> software::profiles{
+	{software::profile::INVALID, S_STATE_DEFAULT},
+	{software::profile::LOW_LATENCY, ST_PROFILE_(LowLatency)},
+	{software::profile::BALANCED, ST_PROFILE_(Balanced)},
+	{software::profile::EFFICIENCY, ST_PROFILE_(Efficiency)},
+};
+
+software::profile software::get_profile(obs_data_t* settings)
+{
+	auto value = static_cast<profile>(obs_data_get_int(settings, KEY_PROFILE));
+	if (profiles.find(value) == profiles.end())
+		return profile::INVALID;
+	return value;
+}
+
+void software::get_defaults(obs_data_t* settings)
+{
+	obs_data_set_default_int(settings, KEY_PROFILE, static_cast<int64_t>(profile::INVALID));
+}
+
+void software::get_properties(obs_properties_t* props)
+{
+	auto p =
+		obs_properties_add_list(props, KEY_PROFILE, D_TRANSLATE(ST_PROFILE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_PROFILE)));
+	for (auto kv : profiles) {
+		obs_property_list_add_int(p, D_TRANSLATE(kv.second.c_str()), static_cast<int64_t>(kv.first));
+	}
+}
+
+void software::get_runtime_properties(obs_properties_t* props)
+{
+	obs_property_set_enabled(obs_properties_get(props, KEY_PROFILE), false);
+}
+
+void software::log_options(obs_data_t* settings, const AVCodec* codec)
+{
+	auto found = profiles.find(get_profile(settings));
+	DLOG_INFO("[%s]     Performance: %s", codec->name, D_TRANSLATE(found->second.c_str()));
+}
+
+void software::override_colorformat(AVPixelFormat& target_format, const AVCodec* codec)
+{
+	auto* target = av_pix_fmt_desc_get(target_format);
+	if (!target || !codec->pix_fmts)
+		return;
+	if ((target->log2_chroma_w == 1) && (target->log2_chroma_h == 1))
+		return;
+
+	// 4:2:0 is the only subsampling that every decoder and player supports, so prefer it at the same bit depth.
+	for (auto ptr = codec->pix_fmts; *ptr != AV_PIX_FMT_NONE; ptr++) {
+		auto* desc = av_pix_fmt_desc_get(*ptr);
+		if (!desc || (desc->flags & (AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_ALPHA | AV_PIX_FMT_FLAG_RGB)))
+			continue;
+		if ((desc->log2_chroma_w != 1) || (desc->log2_chroma_h != 1))
+			continue;
+		if (desc->comp[0].depth != target->comp[0].depth)
+			continue;
+
+		target_format = *ptr;
+		return;
+	}
+}
+
+const AVOption* software::find_option(const AVCodec* codec, std::string_view name)
+{
+	if (!codec->priv_class)
+		return nullptr;
+	return av_opt_find(const_cast<AVClass**>(&codec->priv_class), name.data(), nullptr, 0, AV_OPT_SEARCH_FAKE_OBJ);
+}
+
+int64_t software::clamp_option(const AVCodec* codec, std::string_view name, int64_t value)
+{
+	if (auto opt = find_option(codec, name); opt) {
+		return std::clamp<int64_t>(value, static_cast<int64_t>(opt->min), static_cast<int64_t>(opt->max));
+	}
+	return value;
+}
+
+void software::set_params(AVCodecContext* context, std::string_view option,
+						  const std::map<std::string, std::string>& params, char key_value_separator,
+						  char pair_separator)
+{
+	if (params.empty() || !find_option(context->codec, option))
+		return;
+
+	std::stringstream sstr;
+	for (auto kv : params) {
+		if (sstr.tellp() > 0)
+			sstr << pair_separator;
+		sstr << kv.first << key_value_separator << kv.second;
+	}
+	av_opt_set(context->priv_data, option.data(), sstr.str().c_str(), 0);
+}
+
+obs_property_t* software::add_string_list(obs_properties_t* props, const char* name, const char* text,
+										  const std::vector<std::string_view>& values)
+{
+	auto p = obs_properties_add_list(props, name, text, OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+	obs_property_list_add_string(p, D_TRANSLATE(S_STATE_DEFAULT), "");
+	for (auto value : values) {
+		obs_property_list_add_string(p, value.data(), value.data());
+	}
+	return p;
+}
+
+void software::log_option_string(AVCodecContext* context, std::string_view option, std::string_view text)
+{
+	uint8_t* value = nullptr;
+	if (int err = av_opt_get(context->priv_data, option.data(), 0, &value); err < 0) {
+		DLOG_INFO("[%s] %s: <Error: %s>", context->codec->name, text.data(),
+				  ::ffmpeg::tools::get_error_description(err));
+	} else {
+		const char* str = reinterpret_cast<const char*>(value);
+		DLOG_INFO("[%s] %s: %s", context->codec->name, text.data(), (str && *str) ? str : "<Default>");
+	}
+	av_freep(&value);
+}
+
+std::size_t software::get_preset_index(AVCodecContext* context, const std::vector<std::string_view>& presets,
+									   std::string_view fallback)
+{
+	std::string preset;
+	uint8_t*    value = nullptr;
+	if ((av_opt_get(context->priv_data, "preset", 0, &value) >= 0) && value)
+		preset = reinterpret_cast<const char*>(value);
+	av_freep(&value);
+	if (preset.empty())
+		preset = fallback;
+
+	auto found = std::find(presets.begin(), presets.end(), preset);
+	if (found == presets.end())
+		found = std::find(presets.begin(), presets.end(), fallback);
+	return static_cast<std::size_t>(std::distance(presets.begin(), found));
+}
@@ -0,0 +1,92 @@
+// FFMPEG Video Encoder Integration for OBS Studio
+// Copyright (c) 2020 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+#include "common.hpp"
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "handler.hpp"
+
+extern "C" {
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4242 4244 4365)
+#endif
+#include <libavcodec/avcodec.h>
+#include <libavutil/opt.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+}
+
+/* Shared functionality for software encoders like libx264, libx265, libsvtav1 and libvpx.
+ *
+ * Each of these encoders has a set of options that trade encoding speed and latency for
+ * efficiency. The performance profile selects a validated combination of these, which any
+ * explicitly set option then overrides.
+ */
+
+namespace streamfx::encoder::ffmpeg::handler::software {
+	enum class profile : int64_t {
+		LOW_LATENCY,
+		BALANCED,
+		EFFICIENCY,
+		// Append things before this.
+		INVALID = -1,
+	};
+
+	extern std::map<profile, std::string> profiles;
+
+	profile get_profile(obs_data_t* settings);
+
+	void get_defaults(obs_data_t* settings);
+
+	void get_properties(obs_properties_t* props);
+
+	void get_runtime_properties(obs_properties_t* props);
+
+	void log_options(obs_data_t* settings, const AVCodec* codec);
+
+	void override_colorformat(AVPixelFormat& target_format, const AVCodec* codec);
+
+	// Finds an encoder specific option without requiring a context.
+	const AVOption* find_option(const AVCodec* codec, std::string_view name);
+
+	// Clamps a value into the range supported by an encoder specific option.
+	int64_t clamp_option(const AVCodec* codec, std::string_view name, int64_t value);
+
+	// Applies key/value pairs to an option like 'x264-params', if the encoder has it.
+	void set_params(AVCodecContext* context, std::string_view option, const std::map<std::string, std::string>& params,
+					char key_value_separator, char pair_separator);
+
+	// Adds a list of option values, with an empty string selecting the encoder default.
+	obs_property_t* add_string_list(obs_properties_t* props, const char* name, const char* text,
+									const std::vector<std::string_view>& values);
+
+	void log_option_string(AVCodecContext* context, std::string_view option, std::string_view text);
+
+	// Finds the 'preset' of a context in a list ordered from fastest to slowest, using the fallback if it is not set.
+	std::size_t get_preset_index(AVCodecContext* context, const std::vector<std::string_view>& presets,
+								 std::string_view fallback);
+} // namespace streamfx::encoder::ffmpeg::handler::software
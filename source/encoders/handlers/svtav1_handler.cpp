@@ -0,0 +1,187 @@
+// FFMPEG Video Encoder Integration for OBS Studio
+// Copyright (c) 2020 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "svtav1_handler.hpp"
+#include <thread>
+#include "strings.hpp"
+#include "ffmpeg/tools.hpp"
+#include "plugin.hpp"
+#include "software_shared.hpp"
+
+extern "C" {
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4242 4244 4365)
+#endif
+#include <obs-module.h>
+#include <libavutil/opt.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+}
+
+#define ST_SVTAV1 "FFmpegEncoder.SVTAV1"
+#define ST_PRESET "FFmpegEncoder.Software.Preset"
+#define ST_LOOKAHEAD "FFmpegEncoder.Software.LookAhead"
+#define ST_TILES ST_SVTAV1 ".Tiles"
+#define ST_TILES_COLUMNS ST_TILES ".Columns"
+#define ST_TILES_ROWS ST_TILES ".Rows"
+#define ST_LOGICALPROCESSORS ST_SVTAV1 ".LogicalProcessors"
+
+#define KEY_PRESET "SVTAV1.Preset"
+#define KEY_LOOKAHEAD "SVTAV1.LookAhead"
+#define KEY_TILES_COLUMNS "SVTAV1.Tiles.Columns"
+#define KEY_TILES_ROWS "SVTAV1.Tiles.Rows"
+#define KEY_LOGICALPROCESSORS "SVTAV1.LogicalProcessors"
+
+using namespace streamfx::encoder::ffmpeg::handler;
+
+struct svtav1_profile {
+	int64_t preset;
+	int64_t lookahead;
+	bool    low_delay;
+};
+
+static const std::map<software::profile, svtav1_profile> profiles{
+	// Presets are clamped to the range of the installed version, older versions stop at 8.
+	{software::profile::LOW_LATENCY, {10, 0, true}},
+	{software::profile::BALANCED, {8, -1, false}},
+	{software::profile::EFFICIENCY, {4, -1, false}},
+};
+
+void svtav1_handler::get_defaults(obs_data_t* settings, const AVCodec*, AVCodecContext*, bool)
+{
+	software::get_defaults(settings);
+
+	obs_data_set_default_int(settings, KEY_PRESET, -1);
+	obs_data_set_default_int(settings, KEY_LOOKAHEAD, -1);
+	obs_data_set_default_int(settings, KEY_TILES_COLUMNS, -1);
+	obs_data_set_default_int(settings, KEY_TILES_ROWS, -1);
+	obs_data_set_default_int(settings, KEY_LOGICALPROCESSORS, -1);
+}
+
+void svtav1_handler::get_properties(obs_properties_t* props, const AVCodec* codec, AVCodecContext* context, bool)
+{
+	if (context) {
+		software::get_runtime_properties(props);
+		obs_property_set_enabled(obs_properties_get(props, ST_SVTAV1), false);
+		obs_property_set_enabled(obs_properties_get(props, KEY_PRESET), false);
+		obs_property_set_enabled(obs_properties_get(props, KEY_LOOKAHEAD), false);
+		obs_property_set_enabled(obs_properties_get(props, KEY_TILES_COLUMNS), false);
+		obs_property_set_enabled(obs_properties_get(props, KEY_TILES_ROWS), false);
+		obs_property_set_enabled(obs_properties_get(props, KEY_LOGICALPROCESSORS), false);
+		return;
+	}
+
+	software::get_properties(props);
+
+	obs_properties_t* grp = props;
+	if (!util::are_property_groups_broken()) {
+		grp = obs_properties_create();
+		obs_properties_add_group(props, ST_SVTAV1, D_TRANSLATE(ST_SVTAV1), OBS_GROUP_NORMAL, grp);
+	}
+
+	if (auto opt = software::find_option(codec, "preset"); opt) {
+		auto p = obs_properties_add_int_slider(grp, KEY_PRESET, D_TRANSLATE(ST_PRESET), -1,
+											   static_cast<int64_t>(opt->max), 1);
+		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_PRESET)));
+	}
+	if (software::find_option(codec, "la_depth") || software::find_option(codec, "svtav1-params")) {
+		auto p = obs_properties_add_int_slider(grp, KEY_LOOKAHEAD, D_TRANSLATE(ST_LOOKAHEAD), -1, 120, 1);
+		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_LOOKAHEAD)));
+		obs_property_int_set_suffix(p, " frames");
+	}
+	if (software::find_option(codec, "tile_columns")) {
+		auto p = obs_properties_add_int_slider(grp, KEY_TILES_COLUMNS, D_TRANSLATE(ST_TILES_COLUMNS), -1, 4, 1);
+		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_TILES_COLUMNS)));
+	}
+	if (software::find_option(codec, "tile_rows")) {
+		auto p = obs_properties_add_int_slider(grp, KEY_TILES_ROWS, D_TRANSLATE(ST_TILES_ROWS), -1, 6, 1);
+		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_TILES_ROWS)));
+	}
+	if (software::find_option(codec, "svtav1-params")) {
+		auto p = obs_properties_add_int_slider(grp, KEY_LOGICALPROCESSORS, D_TRANSLATE(ST_LOGICALPROCESSORS), -1,
+											   static_cast<int64_t>(std::thread::hardware_concurrency()), 1);
+		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_LOGICALPROCESSORS)));
+	}
+}
+
+void svtav1_handler::update(obs_data_t* settings, const AVCodec* codec, AVCodecContext* context)
+{
+	int64_t preset    = -1;
+	int64_t lookahead = -1;
+	bool    low_delay = false;
+
+	// Start with the performance profile, which any explicitly set option overrides.
+	if (auto found = profiles.find(software::get_profile(settings)); found != profiles.end()) {
+		preset    = found->second.preset;
+		lookahead = found->second.lookahead;
+		low_delay = found->second.low_delay;
+	}
+
+	if (int64_t v = obs_data_get_int(settings, KEY_PRESET); v > -1)
+		preset = v;
+	if (int64_t v = obs_data_get_int(settings, KEY_LOOKAHEAD); v > -1)
+		lookahead = v;
+
+	std::map<std::string, std::string> params;
+	if (preset > -1)
+		av_opt_set_int(context->priv_data, "preset", software::clamp_option(codec, "preset", preset), 0);
+	if (lookahead > -1) {
+		// Newer versions only accept the look ahead through the parameter string.
+		if (software::find_option(codec, "la_depth")) {
+			av_opt_set_int(context->priv_data, "la_depth", lookahead, 0);
+		} else {
+			params.emplace("lookahead", std::to_string(lookahead));
+		}
+	}
+	if (int64_t v = obs_data_get_int(settings, KEY_TILES_COLUMNS); v > -1)
+		av_opt_set_int(context->priv_data, "tile_columns", v, 0);
+	if (int64_t v = obs_data_get_int(settings, KEY_TILES_ROWS); v > -1)
+		av_opt_set_int(context->priv_data, "tile_rows", v, 0);
+	if (int64_t v = obs_data_get_int(settings, KEY_LOGICALPROCESSORS); v > -1)
+		params.emplace("lp", std::to_string(v));
+	if (low_delay)
+		params.emplace("pred-struct", "1");
+	software::set_params(context, "svtav1-params", params, '=', ':');
+}
+
+void svtav1_handler::log_options(obs_data_t* settings, const AVCodec* codec, AVCodecContext* context)
+{
+	DLOG_INFO("[%s]   SVT-AV1:", codec->name);
+	software::log_options(settings, codec);
+	::ffmpeg::tools::print_av_option_int(context, context->priv_data, "preset", "    Preset", "");
+	if (software::find_option(codec, "la_depth"))
+		::ffmpeg::tools::print_av_option_int(context, context->priv_data, "la_depth", "    Look Ahead", " frames");
+	if (software::find_option(codec, "tile_columns"))
+		::ffmpeg::tools::print_av_option_int(context, context->priv_data, "tile_columns", "    Tile Columns", "");
+	if (software::find_option(codec, "tile_rows"))
+		::ffmpeg::tools::print_av_option_int(context, context->priv_data, "tile_rows", "    Tile Rows", "");
+	if (software::find_option(codec, "svtav1-params"))
+		software::log_option_string(context, "svtav1-params", "    Parameters");
+}
+
+void svtav1_handler::override_colorformat(AVPixelFormat& target_format, obs_data_t*, const AVCodec* codec,
+										  AVCodecContext*)
+{
+	software::override_colorformat(target_format, codec);
+}
@@ -0,0 +1,210 @@
+// FFMPEG Video Encoder Integration for OBS Studio
+// Copyright (c) 2020 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "vpx_handler.hpp"
+#include "strings.hpp"
+#include "ffmpeg/tools.hpp"
+#include "plugin.hpp"
+#include "software_shared.hpp"
+
+extern "C" {
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4242 4244 4365)
+#endif
+#include <obs-module.h>
+#include <libavutil/opt.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+}
+
+#define ST_VPX "FFmpegEncoder.VPX"
+#define ST_DEADLINE ST_VPX ".Deadline"
+#define ST_CPUUSED ST_VPX ".CPUUsed"
+#define ST_LOOKAHEAD "FFmpegEncoder.Software.LookAhead"
+#define ST_ROWMT ST_VPX ".RowMT"
+#define ST_TILECOLUMNS ST_VPX ".TileColumns"
+
+#define KEY_DEADLINE "VPX.Deadline"
+#define KEY_CPUUSED "VPX.CPUUsed"
+#define KEY_LOOKAHEAD "VPX.LookAhead"
+#define KEY_ROWMT "VPX.RowMT"
+#define KEY_TILECOLUMNS "VPX.TileColumns"
+
+using namespace streamfx::encoder::ffmpeg::handler;
+
+static const std::vector<std::string_view> deadlines{
+	"realtime",
+	"good",
+	"best",
+};
+
+struct vpx_profile {
+	std::string_view deadline;
+	int64_t          cpu_used;
+	int64_t          lookahead;
+	int64_t          row_mt;
+};
+
+static const std::map<software::profile, vpx_profile> profiles{
+	// 'realtime' ignores the look ahead entirely, but it is set to 0 to make the intent clear in the log.
+	{software::profile::LOW_LATENCY, {"realtime", 8, 0, 1}},
+	{software::profile::BALANCED, {"good", 4, 16, 1}},
+	{software::profile::EFFICIENCY, {"good", 1, 25, 1}},
+};
+
+void vpx_handler::get_defaults(obs_data_t* settings, const AVCodec*, AVCodecContext*, bool)
+{
+	software::get_defaults(settings);
+
+	obs_data_set_default_string(settings, KEY_DEADLINE, "");
+	obs_data_set_default_int(settings, KEY_CPUUSED, -1);
+	obs_data_set_default_int(settings, KEY_LOOKAHEAD, -1);
+	obs_data_set_default_int(settings, KEY_ROWMT, -1);
+	obs_data_set_default_int(settings, KEY_TILECOLUMNS, -1);
+}
+
+bool vpx_handler::has_roi_support(ffmpeg_factory*)
+{
+	return true;
+}
+
+void vpx_handler::get_properties(obs_properties_t* props, const AVCodec* codec, AVCodecContext* context, bool)
+{
+	if (context) {
+		software::get_runtime_properties(props);
+		obs_property_set_enabled(obs_properties_get(props, ST_VPX), false);
+		obs_property_set_enabled(obs_properties_get(props, KEY_DEADLINE), false);
+		obs_property_set_enabled(obs_properties_get(props, KEY_CPUUSED), false);
+		obs_property_set_enabled(obs_properties_get(props, KEY_LOOKAHEAD), false);
+		obs_property_set_enabled(obs_properties_get(props, KEY_ROWMT), false);
+		obs_property_set_enabled(obs_properties_get(props, KEY_TILECOLUMNS), false);
+		return;
+	}
+
+	software::get_properties(props);
+
+	obs_properties_t* grp = props;
+	if (!util::are_property_groups_broken()) {
+		grp = obs_properties_create();
+		obs_properties_add_group(props, ST_VPX, D_TRANSLATE(ST_VPX), OBS_GROUP_NORMAL, grp);
+	}
+
+	{
+		auto p = software::add_string_list(grp, KEY_DEADLINE, D_TRANSLATE(ST_DEADLINE), deadlines);
+		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_DEADLINE)));
+	}
+	if (auto opt = software::find_option(codec, "cpu-used"); opt) {
+		auto p = obs_properties_add_int_slider(grp, KEY_CPUUSED, D_TRANSLATE(ST_CPUUSED), -1,
+											   static_cast<int64_t>(opt->max), 1);
+		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_CPUUSED)));
+	}
+	{
+		auto p = obs_properties_add_int_slider(grp, KEY_LOOKAHEAD, D_TRANSLATE(ST_LOOKAHEAD), -1, 25, 1);
+		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_LOOKAHEAD)));
+		obs_property_int_set_suffix(p, " frames");
+	}
+	if (software::find_option(codec, "row-mt")) {
+		auto p = util::obs_properties_add_tristate(grp, KEY_ROWMT, D_TRANSLATE(ST_ROWMT));
+		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_ROWMT)));
+	}
+	if (software::find_option(codec, "tile-columns")) {
+		auto p = obs_properties_add_int_slider(grp, KEY_TILECOLUMNS, D_TRANSLATE(ST_TILECOLUMNS), -1, 6, 1);
+		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_TILECOLUMNS)));
+	}
+}
+
+void vpx_handler::update(obs_data_t* settings, const AVCodec* codec, AVCodecContext* context)
+{
+	std::string_view deadline;
+	int64_t          cpu_used  = -1;
+	int64_t          lookahead = -1;
+	int64_t          row_mt    = -1;
+
+	// Start with the performance profile, which any explicitly set option overrides.
+	if (auto found = profiles.find(software::get_profile(settings)); found != profiles.end()) {
+		deadline  = found->second.deadline;
+		cpu_used  = found->second.cpu_used;
+		lookahead = found->second.lookahead;
+		row_mt    = found->second.row_mt;
+	}
+
+	if (std::string_view v = obs_data_get_string(settings, KEY_DEADLINE); !v.empty())
+		deadline = v;
+	if (int64_t v = obs_data_get_int(settings, KEY_CPUUSED); v > -1)
+		cpu_used = v;
+	if (int64_t v = obs_data_get_int(settings, KEY_LOOKAHEAD); v > -1)
+		lookahead = v;
+	if (int64_t v = obs_data_get_int(settings, KEY_ROWMT); !util::is_tristate_default(v))
+		row_mt = v;
+
+	if (!deadline.empty())
+		av_opt_set(context->priv_data, "deadline", deadline.data(), 0);
+	if (cpu_used > -1)
+		av_opt_set_int(context->priv_data, "cpu-used", software::clamp_option(codec, "cpu-used", cpu_used), 0);
+	if (lookahead > -1)
+		av_opt_set_int(context->priv_data, "lag-in-frames", lookahead, 0);
+	if (!util::is_tristate_default(row_mt) && software::find_option(codec, "row-mt"))
+		av_opt_set_int(context->priv_data, "row-mt", util::is_tristate_enabled(row_mt) ? 1 : 0, 0);
+	if (int64_t v = obs_data_get_int(settings, KEY_TILECOLUMNS);
+		(v > -1) && software::find_option(codec, "tile-columns"))
+		av_opt_set_int(context->priv_data, "tile-columns", v, 0);
+}
+
+void vpx_handler::log_options(obs_data_t* settings, const AVCodec* codec, AVCodecContext* context)
+{
+	DLOG_INFO("[%s]   libvpx:", codec->name);
+	software::log_options(settings, codec);
+	::ffmpeg::tools::print_av_option_string2(context, context->priv_data, "deadline", "    Deadline",
+											 [](int64_t, std::string_view o) { return std::string(o); });
+	::ffmpeg::tools::print_av_option_int(context, context->priv_data, "cpu-used", "    CPU Used", "");
+	::ffmpeg::tools::print_av_option_int(context, context->priv_data, "lag-in-frames", "    Look Ahead", " frames");
+	if (software::find_option(codec, "row-mt"))
+		::ffmpeg::tools::print_av_option_bool(context, context->priv_data, "row-mt", "    Row Multi-Threading");
+	if (software::find_option(codec, "tile-columns"))
+		::ffmpeg::tools::print_av_option_int(context, context->priv_data, "tile-columns", "    Tile Columns", "");
+}
+
+void vpx_handler::override_colorformat(AVPixelFormat& target_format, obs_data_t*, const AVCodec* codec,
+									   AVCodecContext*)
+{
+	software::override_colorformat(target_format, codec);
+}
+
+bool vpx_handler::set_speed_level(int32_t level, const AVCodec* codec, AVCodecContext* context)
+{
+	if (level <= 0)
+		return true;
+
+	// Higher values of cpu-used are faster, negative values are the same speeds with a different rate control.
+	int64_t cpu_used = 0;
+	if (av_opt_get_int(context->priv_data, "cpu-used", 0, &cpu_used) < 0)
+		return false;
+
+	int64_t value   = (cpu_used < 0) ? (cpu_used - level) : (cpu_used + level);
+	int64_t clamped = software::clamp_option(codec, "cpu-used", value);
+	if (clamped != value)
+		return false;
+
+	return av_opt_set_int(context->priv_data, "cpu-used", value, 0) >= 0;
+}
@@ -0,0 +1,62 @@
+// FFMPEG Video Encoder Integration for OBS Studio
+// Copyright (c) 2020 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+#include "handler.hpp"
+
+extern "C" {
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4242 4244 4365)
+#endif
+#include <libavcodec/avcodec.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+}
+
+namespace streamfx::encoder::ffmpeg::handler {
+	class vpx_handler : public handler {
+		public:
+		virtual ~vpx_handler(){};
+
+		public /*factory*/:
+		void get_defaults(obs_data_t* settings, const AVCodec* codec, AVCodecContext* context, bool hw_encode) override;
+
+		public /*support tests*/:
+		bool has_roi_support(ffmpeg_factory* instance) override;
+
+		public /*settings*/:
+		void get_properties(obs_properties_t* props, const AVCodec* codec, AVCodecContext* context,
+							bool hw_encode) override;
+
+		void update(obs_data_t* settings, const AVCodec* codec, AVCodecContext* context) override;
+
+		void log_options(obs_data_t* settings, const AVCodec* codec, AVCodecContext* context) override;
+
+		public /*instance*/:
+		void override_colorformat(AVPixelFormat& target_format, obs_data_t* settings, const AVCodec* codec,
+								  AVCodecContext* context) override;
+
+		bool set_speed_level(int32_t level, const AVCodec* codec, AVCodecContext* context) override;
+	};
+} // namespace streamfx::encoder::ffmpeg::handler
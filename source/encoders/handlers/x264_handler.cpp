@@ -0,0 +1,233 @@
+// FFMPEG Video Encoder Integration for OBS Studio
+// Copyright (c) 2020 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "x264_handler.hpp"
+#include "strings.hpp"
+#include "ffmpeg/tools.hpp"
+#include "plugin.hpp"
+#include "software_shared.hpp"
+
+extern "C" {
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4242 4244 4365)
+#endif
+#include <obs-module.h>
+#include <libavutil/opt.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+}
+
+#define ST_X264 "FFmpegEncoder.X264"
+#define ST_PRESET "FFmpegEncoder.Software.Preset"
+#define ST_TUNE "FFmpegEncoder.Software.Tune"
+#define ST_LOOKAHEAD "FFmpegEncoder.Software.LookAhead"
+#define ST_LOOKAHEADTHREADS ST_X264 ".LookAheadThreads"
+#define ST_SLICEDTHREADS ST_X264 ".SlicedThreads"
+
+#define KEY_PRESET "X264.Preset"
+#define KEY_TUNE "X264.Tune"
+#define KEY_LOOKAHEAD "X264.LookAhead"
+#define KEY_LOOKAHEADTHREADS "X264.LookAheadThreads"
+#define KEY_SLICEDTHREADS "X264.SlicedThreads"
+
+using namespace streamfx::encoder::ffmpeg::handler;
+
+static const std::vector<std::string_view> presets{
+	"ultrafast", "superfast", "veryfast", "faster", "fast", "medium", "slow", "slower", "veryslow", "placebo",
+};
+
+static const std::vector<std::string_view> tunes{
+	"film", "animation", "grain", "stillimage", "psnr", "ssim", "fastdecode", "zerolatency",
+};
+
+struct x264_profile {
+	std::string_view preset;
+	std::string_view tune;
+	int64_t          lookahead;
+	int64_t          sliced_threads;
+};
+
+struct x264_speed {
+	std::string_view motion_estimation;
+	int64_t          subpel_refine;
+	int64_t          trellis;
+	int64_t          mixed_refs;
+	std::string_view partitions;
+};
+
+// Analysis options of each preset, none of which affect the stream headers.
+static const std::vector<x264_speed> speeds{
+	{"dia", 0, 0, 0, "none"},
+	{"dia", 1, 0, 0, "i8x8,i4x4"},
+	{"hex", 2, 0, 0, "p8x8,b8x8,i8x8,i4x4"},
+	{"hex", 4, 1, 0, "p8x8,b8x8,i8x8,i4x4"},
+	{"hex", 6, 1, 1, "p8x8,b8x8,i8x8,i4x4"},
+	{"hex", 7, 1, 1, "p8x8,b8x8,i8x8,i4x4"},
+	{"umh", 8, 2, 1, "p8x8,b8x8,i8x8,i4x4"},
+	{"umh", 9, 2, 1, "all"},
+	{"umh", 10, 2, 1, "all"},
+	{"tesa", 11, 2, 1, "all"},
+};
+
+static const std::map<software::profile, x264_profile> profiles{
+	// Sliced threads and no lookahead keep the encoder at a single frame of delay.
+	{software::profile::LOW_LATENCY, {"veryfast", "zerolatency", 0, 1}},
+	{software::profile::BALANCED, {"faster", "", 20, -1}},
+	{software::profile::EFFICIENCY, {"slow", "", 60, -1}},
+};
+
+void x264_handler::get_defaults(obs_data_t* settings, const AVCodec*, AVCodecContext*, bool)
+{
+	software::get_defaults(settings);
+
+	obs_data_set_default_string(settings, KEY_PRESET, "");
+	obs_data_set_default_string(settings, KEY_TUNE, "");
+	obs_data_set_default_int(settings, KEY_LOOKAHEAD, -1);
+	obs_data_set_default_int(settings, KEY_LOOKAHEADTHREADS, -1);
+	obs_data_set_default_int(settings, KEY_SLICEDTHREADS, -1);
+}
+
+bool x264_handler::has_roi_support(ffmpeg_factory*)
+{
+	return true;
+}
+
+void x264_handler::get_properties(obs_properties_t* props, const AVCodec*, AVCodecContext* context, bool)
+{
+	if (context) {
+		software::get_runtime_properties(props);
+		obs_property_set_enabled(obs_properties_get(props, ST_X264), false);
+		obs_property_set_enabled(obs_properties_get(props, KEY_PRESET), false);
+		obs_property_set_enabled(obs_properties_get(props, KEY_TUNE), false);
+		obs_property_set_enabled(obs_properties_get(props, KEY_LOOKAHEAD), false);
+		obs_property_set_enabled(obs_properties_get(props, KEY_LOOKAHEADTHREADS), false);
+		obs_property_set_enabled(obs_properties_get(props, KEY_SLICEDTHREADS), false);
+		return;
+	}
+
+	software::get_properties(props);
+
+	obs_properties_t* grp = props;
+	if (!util::are_property_groups_broken()) {
+		grp = obs_properties_create();
+		obs_properties_add_group(props, ST_X264, D_TRANSLATE(ST_X264), OBS_GROUP_NORMAL, grp);
+	}
+
+	{
+		auto p = software::add_string_list(grp, KEY_PRESET, D_TRANSLATE(ST_PRESET), presets);
+		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_PRESET)));
+	}
+	{
+		auto p = software::add_string_list(grp, KEY_TUNE, D_TRANSLATE(ST_TUNE), tunes);
+		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_TUNE)));
+	}
+	{
+		auto p = obs_properties_add_int_slider(grp, KEY_LOOKAHEAD, D_TRANSLATE(ST_LOOKAHEAD), -1, 250, 1);
+		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_LOOKAHEAD)));
+		obs_property_int_set_suffix(p, " frames");
+	}
+	{
+		auto p = obs_properties_add_int_slider(grp, KEY_LOOKAHEADTHREADS, D_TRANSLATE(ST_LOOKAHEADTHREADS), -1, 16, 1);
+		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_LOOKAHEADTHREADS)));
+	}
+	{
+		auto p = util::obs_properties_add_tristate(grp, KEY_SLICEDTHREADS, D_TRANSLATE(ST_SLICEDTHREADS));
+		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_SLICEDTHREADS)));
+	}
+}
+
+void x264_handler::update(obs_data_t* settings, const AVCodec*, AVCodecContext* context)
+{
+	std::string_view preset;
+	std::string_view tune;
+	int64_t          lookahead      = -1;
+	int64_t          sliced_threads = -1;
+
+	// Start with the performance profile, which any explicitly set option overrides.
+	if (auto found = profiles.find(software::get_profile(settings)); found != profiles.end()) {
+		preset         = found->second.preset;
+		tune           = found->second.tune;
+		lookahead      = found->second.lookahead;
+		sliced_threads = found->second.sliced_threads;
+	}
+
+	if (std::string_view v = obs_data_get_string(settings, KEY_PRESET); !v.empty())
+		preset = v;
+	if (std::string_view v = obs_data_get_string(settings, KEY_TUNE); !v.empty())
+		tune = v;
+	if (int64_t v = obs_data_get_int(settings, KEY_LOOKAHEAD); v > -1)
+		lookahead = v;
+	if (int64_t v = obs_data_get_int(settings, KEY_SLICEDTHREADS); !util::is_tristate_default(v))
+		sliced_threads = v;
+
+	if (!preset.empty())
+		av_opt_set(context->priv_data, "preset", preset.data(), 0);
+	if (!tune.empty())
+		av_opt_set(context->priv_data, "tune", tune.data(), 0);
+	if (lookahead > -1)
+		av_opt_set_int(context->priv_data, "rc-lookahead", lookahead, 0);
+
+	std::map<std::string, std::string> params;
+	if (!util::is_tristate_default(sliced_threads))
+		params.emplace("sliced-threads", util::is_tristate_enabled(sliced_threads) ? "1" : "0");
+	if (int64_t v = obs_data_get_int(settings, KEY_LOOKAHEADTHREADS); v > -1)
+		params.emplace("lookahead-threads", std::to_string(v));
+	software::set_params(context, "x264-params", params, '=', ':');
+}
+
+void x264_handler::log_options(obs_data_t* settings, const AVCodec* codec, AVCodecContext* context)
+{
+	DLOG_INFO("[%s]   x264:", codec->name);
+	software::log_options(settings, codec);
+	software::log_option_string(context, "preset", "    Preset");
+	software::log_option_string(context, "tune", "    Tune");
+	::ffmpeg::tools::print_av_option_int(context, context->priv_data, "rc-lookahead", "    Look Ahead", " frames");
+	software::log_option_string(context, "x264-params", "    Parameters");
+}
+
+void x264_handler::override_colorformat(AVPixelFormat& target_format, obs_data_t*, const AVCodec* codec,
+										AVCodecContext*)
+{
+	software::override_colorformat(target_format, codec);
+}
+
+bool x264_handler::set_speed_level(int32_t level, const AVCodec*, AVCodecContext* context)
+{
+	if (level <= 0)
+		return true;
+
+	// Use the analysis of a faster preset. Reference frames, B-frames and entropy coding stay, as they are part of
+	// the stream headers.
+	std::size_t preset = software::get_preset_index(context, presets, "medium");
+	if (static_cast<std::size_t>(level) > preset)
+		return false;
+
+	auto& speed = speeds[preset - static_cast<std::size_t>(level)];
+	av_opt_set(context, "motion-est", speed.motion_estimation.data(), AV_OPT_SEARCH_CHILDREN);
+	av_opt_set_int(context, "subq", speed.subpel_refine, AV_OPT_SEARCH_CHILDREN);
+	av_opt_set_int(context, "trellis", speed.trellis, AV_OPT_SEARCH_CHILDREN);
+	av_opt_set_int(context, "mixed-refs", speed.mixed_refs, AV_OPT_SEARCH_CHILDREN);
+	av_opt_set(context, "partitions", speed.partitions.data(), AV_OPT_SEARCH_CHILDREN);
+	return true;
+}
@@ -0,0 +1,256 @@
+// FFMPEG Video Encoder Integration for OBS Studio
+// Copyright (c) 2020 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "x265_handler.hpp"
+#include "strings.hpp"
+#include "plugin.hpp"
+#include "software_shared.hpp"
+
+extern "C" {
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4242 4244 4365)
+#endif
+#include <obs-module.h>
+#include <libavutil/opt.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+}
+
+#define ST_X265 "FFmpegEncoder.X265"
+#define ST_PRESET "FFmpegEncoder.Software.Preset"
+#define ST_TUNE "FFmpegEncoder.Software.Tune"
+#define ST_LOOKAHEAD "FFmpegEncoder.Software.LookAhead"
+#define ST_FRAMETHREADS ST_X265 ".FrameThreads"
+#define ST_WAVEFRONT ST_X265 ".Wavefront"
+
+#define KEY_PRESET "X265.Preset"
+#define KEY_TUNE "X265.Tune"
+#define KEY_LOOKAHEAD "X265.LookAhead"
+#define KEY_FRAMETHREADS "X265.FrameThreads"
+#define KEY_WAVEFRONT "X265.Wavefront"
+
+using namespace streamfx::encoder::ffmpeg::handler;
+
+static const std::vector<std::string_view> presets{
+	"ultrafast", "superfast", "veryfast", "faster", "fast", "medium", "slow", "slower", "veryslow", "placebo",
+};
+
+static const std::vector<std::string_view> tunes{
+	"psnr", "ssim", "grain", "zerolatency", "fastdecode", "animation",
+};
+
+struct x265_profile {
+	std::string_view preset;
+	std::string_view tune;
+	int64_t          lookahead;
+	int64_t          frame_threads;
+};
+
+struct x265_speed {
+	std::string_view motion_estimation;
+	int32_t          subpel_refine;
+	int32_t          rd_level;
+	int32_t          merge_candidates;
+	bool             early_skip;
+	bool             rectangular;
+	bool             fast_intra;
+	bool             b_intra;
+};
+
+// Analysis options of each preset, none of which affect the parameter sets.
+static const std::vector<x265_speed> speeds{
+	{"dia", 0, 2, 2, true, false, true, false},
+	{"hex", 1, 2, 2, true, false, true, false},
+	{"hex", 1, 2, 2, true, false, true, false},
+	{"hex", 2, 2, 2, true, false, true, false},
+	{"hex", 2, 2, 2, true, false, true, false},
+	{"hex", 2, 3, 3, true, false, false, false},
+	{"star", 3, 4, 3, false, true, false, false},
+	{"star", 4, 6, 4, false, true, false, true},
+	{"star", 4, 6, 5, false, true, false, true},
+	{"star", 5, 6, 5, false, true, false, true},
+};
+
+static const std::map<software::profile, x265_profile> profiles{
+	// Each frame thread adds a frame of delay, wavefront parallelism is used instead.
+	{software::profile::LOW_LATENCY, {"veryfast", "zerolatency", 0, 1}},
+	{software::profile::BALANCED, {"fast", "", 20, -1}},
+	{software::profile::EFFICIENCY, {"slow", "", 40, -1}},
+};
+
+void x265_handler::get_defaults(obs_data_t* settings, const AVCodec*, AVCodecContext*, bool)
+{
+	software::get_defaults(settings);
+
+	obs_data_set_default_string(settings, KEY_PRESET, "");
+	obs_data_set_default_string(settings, KEY_TUNE, "");
+	obs_data_set_default_int(settings, KEY_LOOKAHEAD, -1);
+	obs_data_set_default_int(settings, KEY_FRAMETHREADS, -1);
+	obs_data_set_default_int(settings, KEY_WAVEFRONT, -1);
+}
+
+bool x265_handler::has_roi_support(ffmpeg_factory*)
+{
+	return true;
+}
+
+void x265_handler::get_properties(obs_properties_t* props, const AVCodec*, AVCodecContext* context, bool)
+{
+	if (context) {
+		software::get_runtime_properties(props);
+		obs_property_set_enabled(obs_properties_get(props, ST_X265), false);
+		obs_property_set_enabled(obs_properties_get(props, KEY_PRESET), false);
+		obs_property_set_enabled(obs_properties_get(props, KEY_TUNE), false);
+		obs_property_set_enabled(obs_properties_get(props, KEY_LOOKAHEAD), false);
+		obs_property_set_enabled(obs_properties_get(props, KEY_FRAMETHREADS), false);
+		obs_property_set_enabled(obs_properties_get(props, KEY_WAVEFRONT), false);
+		return;
+	}
+
+	software::get_properties(props);
+
+	obs_properties_t* grp = props;
+	if (!util::are_property_groups_broken()) {
+		grp = obs_properties_create();
+		obs_properties_add_group(props, ST_X265, D_TRANSLATE(ST_X265), OBS_GROUP_NORMAL, grp);
+	}
+
+	{
+		auto p = software::add_string_list(grp, KEY_PRESET, D_TRANSLATE(ST_PRESET), presets);
+		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_PRESET)));
+	}
+	{
+		auto p = software::add_string_list(grp, KEY_TUNE, D_TRANSLATE(ST_TUNE), tunes);
+		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_TUNE)));
+	}
+	{
+		auto p = obs_properties_add_int_slider(grp, KEY_LOOKAHEAD, D_TRANSLATE(ST_LOOKAHEAD), -1, 250, 1);
+		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_LOOKAHEAD)));
+		obs_property_int_set_suffix(p, " frames");
+	}
+	{
+		auto p = obs_properties_add_int_slider(grp, KEY_FRAMETHREADS, D_TRANSLATE(ST_FRAMETHREADS), -1, 16, 1);
+		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_FRAMETHREADS)));
+	}
+	{
+		auto p = util::obs_properties_add_tristate(grp, KEY_WAVEFRONT, D_TRANSLATE(ST_WAVEFRONT));
+		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_WAVEFRONT)));
+	}
+}
+
+void x265_handler::update(obs_data_t* settings, const AVCodec*, AVCodecContext* context)
+{
+	std::string_view preset;
+	std::string_view tune;
+	int64_t          lookahead     = -1;
+	int64_t          frame_threads = -1;
+
+	// Start with the performance profile, which any explicitly set option overrides.
+	if (auto found = profiles.find(software::get_profile(settings)); found != profiles.end()) {
+		preset        = found->second.preset;
+		tune          = found->second.tune;
+		lookahead     = found->second.lookahead;
+		frame_threads = found->second.frame_threads;
+	}
+
+	if (std::string_view v = obs_data_get_string(settings, KEY_PRESET); !v.empty())
+		preset = v;
+	if (std::string_view v = obs_data_get_string(settings, KEY_TUNE); !v.empty())
+		tune = v;
+	if (int64_t v = obs_data_get_int(settings, KEY_LOOKAHEAD); v > -1)
+		lookahead = v;
+	if (int64_t v = obs_data_get_int(settings, KEY_FRAMETHREADS); v > -1)
+		frame_threads = v;
+
+	if (!preset.empty())
+		av_opt_set(context->priv_data, "preset", preset.data(), 0);
+	if (!tune.empty())
+		av_opt_set(context->priv_data, "tune", tune.data(), 0);
+
+	// libx265 only exposes these through its parameter string.
+	std::map<std::string, std::string> params;
+	if (lookahead > -1)
+		params.emplace("rc-lookahead", std::to_string(lookahead));
+	if (frame_threads > -1)
+		params.emplace("frame-threads", std::to_string(frame_threads));
+	if (int64_t v = obs_data_get_int(settings, KEY_WAVEFRONT); !util::is_tristate_default(v))
+		params.emplace("wpp", util::is_tristate_enabled(v) ? "1" : "0");
+	software::set_params(context, "x265-params", params, '=', ':');
+}
+
+void x265_handler::log_options(obs_data_t* settings, const AVCodec* codec, AVCodecContext* context)
+{
+	DLOG_INFO("[%s]   x265:", codec->name);
+	software::log_options(settings, codec);
+	software::log_option_string(context, "preset", "    Preset");
+	software::log_option_string(context, "tune", "    Tune");
+	software::log_option_string(context, "x265-params", "    Parameters");
+}
+
+void x265_handler::override_colorformat(AVPixelFormat& target_format, obs_data_t*, const AVCodec* codec,
+										AVCodecContext*)
+{
+	software::override_colorformat(target_format, codec);
+}
+
+bool x265_handler::set_speed_level(int32_t level, const AVCodec*, AVCodecContext* context)
+{
+	if (level <= 0)
+		return true;
+
+	// Use the analysis of a faster preset. Anything stored in the parameter sets, like reference frames, the coding
+	// tree and SAO, stays as it is. Presets that only differ in those are skipped, so that every step is faster.
+	auto same = [](x265_speed const& a, x265_speed const& b) {
+		return (a.motion_estimation == b.motion_estimation) && (a.subpel_refine == b.subpel_refine)
+			   && (a.rd_level == b.rd_level) && (a.merge_candidates == b.merge_candidates)
+			   && (a.early_skip == b.early_skip) && (a.rectangular == b.rectangular) && (a.fast_intra == b.fast_intra)
+			   && (a.b_intra == b.b_intra);
+	};
+	std::size_t index = software::get_preset_index(context, presets, "medium");
+	for (int32_t step = 0; step < level; step++) {
+		do {
+			if (index == 0)
+				return false;
+			index--;
+		} while (same(speeds[index], speeds[index + 1]));
+	}
+
+	// Appended to the existing parameters, so that these take priority.
+	std::string params;
+	uint8_t*    value = nullptr;
+	if ((av_opt_get(context->priv_data, "x265-params", 0, &value) >= 0) && value && *value)
+		params = std::string(reinterpret_cast<const char*>(value)) + ":";
+	av_freep(&value);
+
+	auto& speed = speeds[index];
+	params += "me=" + std::string(speed.motion_estimation);
+	params += ":subme=" + std::to_string(speed.subpel_refine);
+	params += ":rd=" + std::to_string(speed.rd_level);
+	params += ":max-merge=" + std::to_string(speed.merge_candidates);
+	params += std::string(":early-skip=") + (speed.early_skip ? "1" : "0");
+	params += std::string(":rect=") + (speed.rectangular ? "1" : "0");
+	params += std::string(":fast-intra=") + (speed.fast_intra ? "1" : "0");
+	params += std::string(":b-intra=") + (speed.b_intra ? "1" : "0");
+	return av_opt_set(context->priv_data, "x265-params", params.c_str(), 0) >= 0;
+}
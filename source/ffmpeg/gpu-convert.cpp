@@ -0,0 +1,263 @@
+// FFMPEG Video Encoder Integration for OBS Studio
+// Copyright (c) 2020 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "gpu-convert.hpp"
+#include <stdexcept>
+#include "obs/gs/gs-helper.hpp"
+#include "plugin.hpp"
+
+extern "C" {
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4242 4244 4365)
+#endif
+#include <libavutil/pixdesc.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+}
+
+using namespace ffmpeg;
+
+static void get_luma_coefficients(AVColorSpace space, float_t& kr, float_t& kb)
+{
+	switch (space) {
+	case AVCOL_SPC_BT470BG:
+	case AVCOL_SPC_SMPTE170M:
+		kr = 0.299f;
+		kb = 0.114f;
+		break;
+	case AVCOL_SPC_BT2020_NCL:
+	case AVCOL_SPC_BT2020_CL:
+		kr = 0.2627f;
+		kb = 0.0593f;
+		break;
+	case AVCOL_SPC_BT709:
+	default:
+		kr = 0.2126f;
+		kb = 0.0722f;
+		break;
+	}
+}
+
+gpu_convert::gpu_convert(AVPixelFormat format, uint32_t width, uint32_t height, AVColorSpace space, bool full_range,
+						 std::size_t ring_size)
+	: _format(format), _width(width), _height(height), _depth(8), _shift(0), _semi_planar(false), _effect(),
+	  _scale(), _planes()
+{
+	if (!is_supported(format))
+		throw std::invalid_argument("format");
+	if (ring_size < 2)
+		throw std::invalid_argument("ring_size");
+
+	const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(format);
+	_depth                         = static_cast<uint32_t>(desc->comp[0].depth);
+	_shift                         = static_cast<uint32_t>(desc->comp[0].shift);
+	_semi_planar                   = (desc->comp[1].plane == desc->comp[2].plane);
+
+	// Store samples exactly as FFmpeg expects them, including the MSB alignment of P010.
+	uint32_t max_value = (1u << _depth) - 1u;
+	_scale.x           = static_cast<float_t>(max_value);
+	_scale.y           = static_cast<float_t>(1u << _shift)
+				/ static_cast<float_t>(_depth > 8 ? std::numeric_limits<uint16_t>::max()
+												  : std::numeric_limits<uint8_t>::max());
+
+	// Build the RGB to YUV matrix, with range compression applied.
+	float_t kr, kb;
+	get_luma_coefficients(space, kr, kb);
+	float_t kg = 1.0f - kr - kb;
+
+	float_t luma_scale     = 1.0f;
+	float_t luma_offset    = 0.0f;
+	float_t chroma_scale   = 1.0f;
+	float_t chroma_offset  = static_cast<float_t>(1u << (_depth - 1)) / static_cast<float_t>(max_value);
+	if (!full_range) {
+		float_t range = static_cast<float_t>(1u << (_depth - 8));
+		luma_scale    = (219.0f * range) / static_cast<float_t>(max_value);
+		luma_offset   = (16.0f * range) / static_cast<float_t>(max_value);
+		chroma_scale  = (224.0f * range) / static_cast<float_t>(max_value);
+	}
+
+	vec4 rows[3];
+	vec4_set(&rows[0], kr * luma_scale, kg * luma_scale, kb * luma_scale, luma_offset);
+	{ // Cb = (B - Y) / (2 * (1 - Kb))
+		float_t f = chroma_scale / (2.0f * (1.0f - kb));
+		vec4_set(&rows[1], -kr * f, -kg * f, (1.0f - kb) * f, chroma_offset);
+	}
+	{ // Cr = (R - Y) / (2 * (1 - Kr))
+		float_t f = chroma_scale / (2.0f * (1.0f - kr));
+		vec4_set(&rows[2], (1.0f - kr) * f, -kg * f, -kb * f, chroma_offset);
+	}
+
+	auto gctx = gs::context();
+
+	_effect = gs::effect::create(streamfx::data_file_path("effects/yuv-planar.effect").u8string());
+
+	// One render target per component, chroma is subsampled by the GPU. Each plane is read back through its own ring,
+	// and since all planes are staged and mapped together, the rings always hold the same frames. Frames can be mapped
+	// as soon as a newer one was staged, but stay in the ring until the encoder asks for their timestamp.
+	gs_color_format rt_format = (_depth > 8) ? GS_R16 : GS_R8;
+	for (std::size_t idx = 0; idx < 3; idx++) {
+		plane p;
+		p.width  = idx ? AV_CEIL_RSHIFT(_width, desc->log2_chroma_w) : _width;
+		p.height = idx ? AV_CEIL_RSHIFT(_height, desc->log2_chroma_h) : _height;
+		p.rt     = std::make_shared<gs::rendertarget>(rt_format, GS_ZS_NONE);
+		p.ring   = std::make_shared<gs::readback_ring>(ring_size, 1);
+		p.matrix = rows[idx];
+		_planes.push_back(p);
+	}
+}
+
+gpu_convert::~gpu_convert()
+{
+	auto gctx = gs::context();
+	_planes.clear();
+	_effect.reset();
+}
+
+void gpu_convert::stage(gs_texture_t* texture, uint64_t timestamp)
+{
+	if (!texture)
+		return;
+
+	auto gctx = gs::context();
+
+#ifdef ENABLE_PROFILING
+	gs::debug_marker gdmp{gs::debug_color_convert, "GPU Conversion"};
+#endif
+
+	gs_blend_state_push();
+	gs_reset_blend_state();
+	gs_enable_blending(false);
+	gs_enable_depth_test(false);
+	gs_enable_stencil_test(false);
+	gs_enable_stencil_write(false);
+	gs_enable_color(true, true, true, true);
+	gs_set_cull_mode(GS_NEITHER);
+
+	for (std::size_t idx = 0; idx < _planes.size(); idx++) {
+		plane& p = _planes[idx];
+		{
+			auto op = p.rt->render(p.width, p.height);
+			gs_ortho(0, 1, 0, 1, 0, 1);
+
+			_effect.get_parameter("image").set_texture(texture);
+			_effect.get_parameter("plane_matrix").set_float4(p.matrix);
+			_effect.get_parameter("plane_scale").set_float2(_scale);
+			while (gs_effect_loop(_effect.get_object(), "Draw")) {
+				streamfx::gs_draw_fullscreen_tri();
+			}
+		}
+		// The ring drops the oldest frame if the reader is not keeping up.
+		p.ring->stage(p.rt->get_object(), timestamp);
+	}
+
+	gs_blend_state_pop();
+}
+
+bool gpu_convert::read(AVFrame* frame, uint64_t timestamp, uint64_t tolerance)
+{
+	auto matches = [timestamp, tolerance](uint64_t tag) {
+		return ((tag + tolerance) >= timestamp) && (tag <= (timestamp + tolerance));
+	};
+
+	// Frames older than the requested one are never asked for again, while newer ones are kept for later requests.
+	for (auto& p : _planes) {
+		uint64_t tag = 0;
+		while (p.ring->peek(tag) && ((tag + tolerance) < timestamp)) {
+			p.ring->discard();
+		}
+		if (!p.ring->peek(tag) || !matches(tag))
+			return false;
+	}
+
+	// Mapping enters the graphics context, but the copy runs without it so that rendering is never blocked by it.
+	std::vector<gs::readback_ring::frame> mapped(_planes.size());
+	std::size_t                           mapped_count = 0;
+	bool                                  complete     = true;
+	for (; complete && (mapped_count < _planes.size()); mapped_count++) {
+		if (!_planes[mapped_count].ring->try_map(mapped[mapped_count]))
+			break;
+		// stage() may have overwritten the frame since it was peeked at.
+		complete = matches(mapped[mapped_count].tag);
+	}
+	if (!complete || (mapped_count != _planes.size())) {
+		for (std::size_t idx = 0; idx < mapped_count; idx++) {
+			_planes[idx].ring->unmap(mapped[idx]);
+		}
+		return false;
+	}
+
+	std::size_t sample_size = (_depth > 8) ? 2 : 1;
+	for (std::size_t idx = 0; idx < _planes.size(); idx++) {
+		plane&         p    = _planes[idx];
+		const uint8_t* data = mapped[idx].data;
+
+		std::size_t row_size = p.width * sample_size;
+		if (!_semi_planar || (idx == 0)) {
+			uint8_t* to = frame->data[idx];
+			for (uint32_t y = 0; y < p.height; y++) {
+				std::memcpy(to, data, row_size);
+				to += frame->linesize[idx];
+				data += mapped[idx].linesize;
+			}
+		} else {
+			// Interleave both chroma components into the second plane.
+			std::size_t offset = (idx - 1) * sample_size;
+			uint8_t*    to     = frame->data[1];
+			for (uint32_t y = 0; y < p.height; y++) {
+				for (std::size_t x = 0; x < p.width; x++) {
+					std::memcpy(to + x * sample_size * 2 + offset, data + x * sample_size, sample_size);
+				}
+				to += frame->linesize[1];
+				data += mapped[idx].linesize;
+			}
+		}
+	}
+
+	for (std::size_t idx = 0; idx < _planes.size(); idx++) {
+		_planes[idx].ring->unmap(mapped[idx]);
+	}
+	return true;
+}
+
+AVPixelFormat gpu_convert::get_format()
+{
+	return _format;
+}
+
+bool gpu_convert::is_supported(AVPixelFormat format)
+{
+	switch (format) {
+	case AV_PIX_FMT_YUV420P:
+	case AV_PIX_FMT_YUV422P:
+	case AV_PIX_FMT_YUV444P:
+	case AV_PIX_FMT_YUV420P10LE:
+	case AV_PIX_FMT_YUV422P10LE:
+	case AV_PIX_FMT_YUV444P10LE:
+	case AV_PIX_FMT_NV12:
+	case AV_PIX_FMT_P010LE:
+		return true;
+	default:
+		return false;
+	}
+}
@@ -0,0 +1,94 @@
+// FFMPEG Video Encoder Integration for OBS Studio
+// Copyright (c) 2020 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+#include "common.hpp"
+#include <vector>
+#include "obs/gs/gs-effect.hpp"
+#include "obs/gs/gs-readback-ring.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
+
+extern "C" {
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4242 4244 4365)
+#endif
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+}
+
+namespace ffmpeg {
+	/** GPU based RGB to planar YUV conversion with asynchronous readback.
+	 *
+	 * Converts a texture into the planes of the target format on the GPU, then stages each plane
+	 * into its own gs::readback_ring. Frames are only mapped once a newer frame was staged, so
+	 * reading never stalls the GPU pipeline, and the graphics context is only held while mapping.
+	 */
+	class gpu_convert {
+		struct plane {
+			uint32_t                           width;
+			uint32_t                           height;
+			std::shared_ptr<gs::rendertarget>  rt;
+			std::shared_ptr<gs::readback_ring> ring;
+			vec4                               matrix;
+		};
+
+		AVPixelFormat _format;
+		uint32_t      _width;
+		uint32_t      _height;
+		uint32_t      _depth;
+		uint32_t      _shift;
+		bool          _semi_planar;
+
+		gs::effect         _effect;
+		vec2               _scale;
+		std::vector<plane> _planes;
+
+		public:
+		gpu_convert(AVPixelFormat format, uint32_t width, uint32_t height, AVColorSpace space, bool full_range,
+					std::size_t ring_size = 5);
+		~gpu_convert();
+
+		/** Convert and stage a texture for readback.
+		 *
+		 * If the ring is full, the oldest unread frame is dropped.
+		 */
+		void stage(gs_texture_t* texture, uint64_t timestamp);
+
+		/** Copy the frame staged with the given timestamp into the given frame.
+		 *
+		 * Older frames are dropped, newer frames are kept for later calls.
+		 *
+		 * \param tolerance Maximum difference between the requested and the staged timestamp.
+		 * \return true if a frame was copied, false if it has not completed yet or was dropped.
+		 */
+		bool read(AVFrame* frame, uint64_t timestamp, uint64_t tolerance);
+
+		AVPixelFormat get_format();
+
+		public:
+		static bool is_supported(AVPixelFormat format);
+	};
+} // namespace ffmpeg
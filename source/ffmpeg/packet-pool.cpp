@@ -0,0 +1,135 @@
+// FFMPEG Video Encoder Integration for OBS Studio
+// Copyright (c) 2020 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "packet-pool.hpp"
+#include <algorithm>
+#include <cstring>
+
+extern "C" {
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4242 4244 4365)
+#endif
+#include <libavutil/error.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+}
+
+using namespace ffmpeg;
+
+// Small packets all share the smallest size class.
+constexpr std::size_t minimum_size = 64 * 1024;
+
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(58, 134, 100)
+static int get_encode_buffer(AVCodecContext* context, AVPacket* packet, int)
+{
+	return reinterpret_cast<packet_pool*>(context->opaque)->get_buffer(packet);
+}
+#endif
+
+packet_pool::packet_pool() : _lock(), _pools(), _requests(0), _allocations(0), _memory(0) {}
+
+packet_pool::~packet_pool()
+{
+	// Buffers still in use keep their pool alive until they are released.
+	for (auto& kv : _pools) {
+		av_buffer_pool_uninit(&kv.second);
+	}
+}
+
+bool packet_pool::install(AVCodecContext* context)
+{
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(58, 134, 100)
+	if ((context->codec->capabilities & AV_CODEC_CAP_DR1) == 0)
+		return false;
+
+	context->opaque            = this;
+	context->get_encode_buffer = get_encode_buffer;
+	return true;
+#else
+	return false;
+#endif
+}
+
+int packet_pool::get_buffer(AVPacket* packet)
+{
+	std::size_t size     = static_cast<std::size_t>(packet->size) + AV_INPUT_BUFFER_PADDING_SIZE;
+	std::size_t capacity = minimum_size;
+	while (capacity < size) {
+		capacity <<= 1;
+	}
+
+	AVBufferPool* pool = nullptr;
+	{
+		std::unique_lock<std::mutex> lock(_lock);
+		auto&                        entry = _pools[capacity];
+		if (!entry) {
+			entry = av_buffer_pool_init2(static_cast<buffer_size_t>(capacity), this, allocate, nullptr);
+			if (!entry) {
+				_pools.erase(capacity);
+				return AVERROR(ENOMEM);
+			}
+		}
+		pool = entry;
+	}
+
+	_requests++;
+	packet->buf = av_buffer_pool_get(pool);
+	if (!packet->buf)
+		return AVERROR(ENOMEM);
+
+	packet->data = packet->buf->data;
+	memset(packet->data + packet->size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+	return 0;
+}
+
+uint64_t packet_pool::requests()
+{
+	return _requests;
+}
+
+uint64_t packet_pool::allocations()
+{
+	return _allocations;
+}
+
+uint64_t packet_pool::memory()
+{
+	return _memory;
+}
+
+double packet_pool::hit_rate()
+{
+	uint64_t requests = _requests;
+	if (requests == 0)
+		return 0.;
+	return static_cast<double>(requests - std::min<uint64_t>(_allocations, requests)) / static_cast<double>(requests);
+}
+
+AVBufferRef* packet_pool::allocate(void* opaque, buffer_size_t size)
+{
+	auto self = reinterpret_cast<packet_pool*>(opaque);
+	self->_allocations++;
+	self->_memory += static_cast<uint64_t>(size);
+	return av_buffer_alloc(size);
+}
@@ -0,0 +1,83 @@
+// FFMPEG Video Encoder Integration for OBS Studio
+// Copyright (c) 2020 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+#include "common.hpp"
+#include <atomic>
+#include <map>
+#include <mutex>
+
+extern "C" {
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4242 4244 4365)
+#endif
+#include <libavcodec/avcodec.h>
+#include <libavutil/buffer.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+}
+
+namespace ffmpeg {
+	/** Recycles the output buffers of an encoder instead of allocating one for every packet.
+	 *
+	 * Buffers are grouped into power of two size classes, each backed by a reference counted
+	 * AVBufferPool, so that packets which are still referenced elsewhere remain valid even after
+	 * the pool itself is gone. Only encoders that support 'get_encode_buffer' can use it.
+	 */
+	class packet_pool {
+#if LIBAVUTIL_VERSION_MAJOR >= 57
+		typedef std::size_t buffer_size_t;
+#else
+		typedef int buffer_size_t;
+#endif
+
+		std::mutex                           _lock;
+		std::map<std::size_t, AVBufferPool*> _pools;
+
+		std::atomic_uint64_t _requests;
+		std::atomic_uint64_t _allocations;
+		std::atomic_uint64_t _memory;
+
+		public:
+		packet_pool();
+		~packet_pool();
+
+		// Makes the context allocate its packets from this pool, returns false if the encoder does not support it.
+		bool install(AVCodecContext* context);
+
+		int get_buffer(AVPacket* packet);
+
+		uint64_t requests();
+
+		uint64_t allocations();
+
+		// Total size of all buffers the pool has allocated so far, whether they are in use or not.
+		uint64_t memory();
+
+		double hit_rate();
+
+		private:
+		static AVBufferRef* allocate(void* opaque, buffer_size_t size);
+	};
+} // namespace ffmpeg
@@ -0,0 +1,178 @@
+// FFMPEG Video Encoder Integration for OBS Studio
+// Copyright (c) 2020 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "parallel-encoder.hpp"
+#include <stdexcept>
+#include "tools.hpp"
+
+using namespace ffmpeg;
+
+static AVCodecContext* clone_context(const AVCodec* codec, const AVCodecContext* source)
+{
+	AVCodecContext* context = ::ffmpeg::tools::context_clone(codec, source);
+
+	// Parallelism comes from the number of contexts, frame threading would only add delay.
+	context->thread_type &= ~FF_THREAD_FRAME;
+	context->delay = 0;
+
+	if (int res = avcodec_open2(context, codec, NULL); res < 0) {
+		avcodec_free_context(&context);
+		throw std::runtime_error(::ffmpeg::tools::get_error_description(res));
+	}
+
+	return context;
+}
+
+parallel_encoder::parallel_encoder(const AVCodec* codec, const AVCodecContext* context, std::size_t count)
+	: _codec(codec), _workers(), _next(0), _stop(false), _order(), _results(), _results_lock(), _results_cv()
+{
+	if (!is_supported(codec))
+		throw std::invalid_argument("codec");
+	if (count < 1)
+		throw std::invalid_argument("count");
+
+	try {
+		for (std::size_t idx = 0; idx < count; idx++) {
+			auto w     = std::make_unique<worker>();
+			w->context = clone_context(codec, context);
+			_workers.push_back(std::move(w));
+		}
+	} catch (...) {
+		for (auto& w : _workers) {
+			avcodec_free_context(&w->context);
+		}
+		throw;
+	}
+
+	for (auto& w : _workers) {
+		w->thread = std::thread(&parallel_encoder::work, this, w.get());
+	}
+}
+
+parallel_encoder::~parallel_encoder()
+{
+	// Workers finish the frames still queued for them before they exit, so the contexts are flushed cleanly.
+	for (auto& w : _workers) {
+		std::unique_lock<std::mutex> lock(w->lock);
+		_stop = true;
+		w->cv.notify_all();
+	}
+	for (auto& w : _workers) {
+		if (w->thread.joinable())
+			w->thread.join();
+		avcodec_free_context(&w->context);
+	}
+
+	for (auto& kv : _results) {
+		av_packet_free(&kv.second.packet);
+	}
+}
+
+void parallel_encoder::push(std::shared_ptr<AVFrame> frame)
+{
+	auto& w = _workers[_next];
+	_next   = (_next + 1) % _workers.size();
+
+	_order.push_back(frame->pts);
+	{
+		std::unique_lock<std::mutex> lock(w->lock);
+		w->frames.push_back(frame);
+		w->cv.notify_all();
+	}
+}
+
+bool parallel_encoder::pop(result& res, bool wait)
+{
+	if (_order.size() == 0)
+		return false;
+
+	std::unique_lock<std::mutex> lock(_results_lock);
+	auto                         fnd = _results.find(_order.front());
+	if (fnd == _results.end()) {
+		if (!wait)
+			return false;
+
+		_results_cv.wait(lock, [this]() { return _results.find(_order.front()) != _results.end(); });
+		fnd = _results.find(_order.front());
+	}
+
+	res = fnd->second;
+	_results.erase(fnd);
+	_order.pop_front();
+	return true;
+}
+
+std::size_t parallel_encoder::pending()
+{
+	return _order.size();
+}
+
+std::size_t parallel_encoder::count()
+{
+	return _workers.size();
+}
+
+bool parallel_encoder::is_supported(const AVCodec* codec)
+{
+	if (codec->type != AVMEDIA_TYPE_VIDEO)
+		return false;
+
+	// Codecs that buffer frames internally can not be split across contexts.
+	if (codec->capabilities & AV_CODEC_CAP_DELAY)
+		return false;
+
+	if (codec->capabilities & AV_CODEC_CAP_INTRA_ONLY)
+		return true;
+	if (auto desc = avcodec_descriptor_get(codec->id); desc && (desc->props & AV_CODEC_PROP_INTRA_ONLY))
+		return true;
+	return false;
+}
+
+void parallel_encoder::work(worker* w)
+{
+	while (true) {
+		std::shared_ptr<AVFrame> frame;
+		{
+			std::unique_lock<std::mutex> lock(w->lock);
+			w->cv.wait(lock, [this, w]() { return _stop || (w->frames.size() > 0); });
+			if (w->frames.size() == 0) // Only stop once every queued frame was encoded.
+				break;
+
+			frame = w->frames.front();
+			w->frames.pop_front();
+		}
+
+		result res;
+		res.frame  = frame;
+		res.packet = av_packet_alloc();
+		res.error  = avcodec_send_frame(w->context, frame.get());
+		if (res.error == 0) {
+			res.error = avcodec_receive_packet(w->context, res.packet);
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(_results_lock);
+			_results.emplace(frame->pts, res);
+			_results_cv.notify_all();
+		}
+	}
+}
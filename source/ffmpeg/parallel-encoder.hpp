@@ -0,0 +1,105 @@
+// FFMPEG Video Encoder Integration for OBS Studio
+// Copyright (c) 2020 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+#include "common.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+
+extern "C" {
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4242 4244 4365)
+#endif
+#include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+}
+
+namespace ffmpeg {
+	/** Encodes consecutive frames of an intra-only codec on multiple independent contexts.
+	 *
+	 * Each context is a clone of an already configured template context and is driven by its own
+	 * worker thread. Frames are dispatched round-robin, and packets are handed back in the order
+	 * in which the frames were pushed, so the output is identical to a single context.
+	 */
+	class parallel_encoder {
+		public:
+		struct result {
+			AVPacket*                packet;
+			std::shared_ptr<AVFrame> frame;
+			int                      error;
+		};
+
+		private:
+		struct worker {
+			AVCodecContext*                      context;
+			std::thread                          thread;
+			std::mutex                           lock;
+			std::condition_variable              cv;
+			std::deque<std::shared_ptr<AVFrame>> frames;
+		};
+
+		const AVCodec*                       _codec;
+		std::vector<std::unique_ptr<worker>> _workers;
+		std::size_t                          _next;
+		std::atomic_bool                     _stop;
+
+		std::deque<int64_t>          _order;
+		std::map<int64_t, result>    _results;
+		std::mutex                   _results_lock;
+		std::condition_variable      _results_cv;
+
+		public:
+		parallel_encoder(const AVCodec* codec, const AVCodecContext* context, std::size_t count);
+
+		/** Encode every frame that is still queued, then stop the workers. */
+		~parallel_encoder();
+
+		/** Queue a frame for encoding on the next context. */
+		void push(std::shared_ptr<AVFrame> frame);
+
+		/** Retrieve the result for the oldest queued frame.
+		 *
+		 * \param wait Wait for the result if it is not done yet.
+		 * \return true if a result was retrieved, ownership of the packet is transferred to the caller.
+		 */
+		bool pop(result& res, bool wait);
+
+		/** Number of frames that have been pushed but not yet popped. */
+		std::size_t pending();
+
+		std::size_t count();
+
+		public:
+		static bool is_supported(const AVCodec* codec);
+
+		private:
+		void work(worker* w);
+	};
+} // namespace ffmpeg
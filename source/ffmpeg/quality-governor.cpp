@@ -0,0 +1,97 @@
+// FFMPEG Video Encoder Integration for OBS Studio
+// Copyright (c) 2020 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "quality-governor.hpp"
+
+// Go faster once the average frame uses up 90% of the interval, and only restore quality below 60%.
+constexpr double threshold_faster = 0.9;
+constexpr double threshold_slower = 0.6;
+
+using namespace ffmpeg;
+
+quality_governor::quality_governor(double frame_interval, std::size_t window, int32_t max_level)
+	: _samples(), _sum(0), _window(window), _interval(frame_interval), _level(0), _max_level(max_level),
+	  _load_before(0), _settling(false)
+{}
+
+quality_governor::~quality_governor() {}
+
+int32_t quality_governor::record(double seconds)
+{
+	_samples.push_back(seconds);
+	_sum += seconds;
+	if (_samples.size() > _window) {
+		_sum -= _samples.front();
+		_samples.pop_front();
+	}
+
+	// Only judge full windows.
+	if (_samples.size() < _window)
+		return 0;
+
+	double ratio = load();
+	if ((ratio > threshold_faster) && (_level < _max_level))
+		return 1;
+	if ((ratio < threshold_slower) && (_level > 0))
+		return -1;
+	return 0;
+}
+
+void quality_governor::applied(int32_t step, bool success)
+{
+	if (success) {
+		_level += step;
+		_load_before = load();
+		_settling    = true;
+	} else if (step > 0) {
+		// The encoder is as fast as it gets, don't keep asking.
+		_max_level = _level;
+	} else {
+		_level = 0;
+	}
+
+	_samples.clear();
+	_sum = 0;
+}
+
+double quality_governor::load()
+{
+	if (_samples.empty() || (_interval <= 0))
+		return 0;
+	return (_sum / static_cast<double>(_samples.size())) / _interval;
+}
+
+bool quality_governor::settled(double& before, double& after)
+{
+	if (!_settling || (_samples.size() < _window))
+		return false;
+
+	_settling = false;
+	before    = _load_before;
+	after     = load();
+	return true;
+}
+
+int32_t quality_governor::level()
+{
+	return _level;
+}
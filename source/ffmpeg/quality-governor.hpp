@@ -0,0 +1,64 @@
+// FFMPEG Video Encoder Integration for OBS Studio
+// Copyright (c) 2020 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+#include "common.hpp"
+#include <deque>
+
+namespace ffmpeg {
+	/** Decides when an encoder should trade quality for speed, or back.
+	 *
+	 * The time spent encoding each frame is compared against the frame interval over a sliding
+	 * window. Once the average gets close to the interval, the encoder is asked to go faster, and
+	 * once there is plenty of headroom again, quality is restored one step at a time. After every
+	 * change the window starts over, so a change is only judged on frames encoded with it.
+	 */
+	class quality_governor {
+		std::deque<double> _samples;
+		double             _sum;
+		std::size_t        _window;
+		double             _interval;
+		int32_t            _level;
+		int32_t            _max_level;
+		double             _load_before;
+		bool               _settling;
+
+		public:
+		quality_governor(double frame_interval, std::size_t window = 60, int32_t max_level = 4);
+		~quality_governor();
+
+		// Records the time spent on a frame, returns 1 to go faster, -1 to restore quality and 0 otherwise.
+		int32_t record(double seconds);
+
+		// Confirms that the encoder applied a step, or that it can't go any further in that direction.
+		void applied(int32_t step, bool success);
+
+		// Average encode time over the window relative to the frame interval.
+		double load();
+
+		// Returns true once the first full window after a step was recorded, with the load before and after it.
+		bool settled(double& before, double& after);
+
+		// Number of steps the encoder currently is faster than configured.
+		int32_t level();
+	};
+} // namespace ffmpeg
@@ -0,0 +1,427 @@
+// FFMPEG Video Encoder Integration for OBS Studio
+// Copyright (c) 2020 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "thread-tuner.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "configuration.hpp"
+#include "obs/obs-tools.hpp"
+#include "plugin.hpp"
+#include "tools.hpp"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+extern "C" {
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4242 4244 4365)
+#endif
+#include <libavutil/frame.h>
+#include <libavutil/mem.h>
+#include <libavutil/opt.h>
+#include <libavutil/pixdesc.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+}
+
+using namespace ffmpeg;
+
+constexpr std::string_view cache_name     = "FFmpeg.ThreadTuner";
+constexpr std::string_view cache_type     = "Type";
+constexpr std::string_view cache_count    = "Count";
+constexpr std::string_view cache_fps      = "FPS";
+constexpr std::string_view cache_latency  = "Latency";
+constexpr std::size_t      measure_frames = 30;
+constexpr auto             measure_limit  = std::chrono::milliseconds(1500);
+constexpr auto             tune_limit     = std::chrono::seconds(10);
+
+static std::mutex            _cache_lock;
+static std::set<std::string> _pending;
+
+static std::string get_cpu_model()
+{
+	std::string model;
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	int regs[4] = {0};
+	__cpuid(regs, static_cast<int>(0x80000000));
+	if (static_cast<unsigned int>(regs[0]) >= 0x80000004) {
+		char brand[49] = {0};
+		for (int idx = 0; idx < 3; idx++) {
+			__cpuid(regs, static_cast<int>(0x80000002 + idx));
+			memcpy(brand + idx * 16, regs, sizeof(regs));
+		}
+		model = brand;
+	}
+#elif defined(__x86_64__) || defined(__i386__)
+	unsigned int regs[4] = {0};
+	if (__get_cpuid_max(0x80000000, nullptr) >= 0x80000004) {
+		char brand[49] = {0};
+		for (unsigned int idx = 0; idx < 3; idx++) {
+			__get_cpuid(0x80000002 + idx, &regs[0], &regs[1], &regs[2], &regs[3]);
+			memcpy(brand + idx * 16, regs, sizeof(regs));
+		}
+		model = brand;
+	}
+#endif
+
+	// Brand strings are padded with spaces on most CPUs.
+	if (auto first = model.find_first_not_of(' '); first != std::string::npos) {
+		model = model.substr(first, model.find_last_not_of(' ') - first + 1);
+	} else {
+		model = "Unknown";
+	}
+
+	return model + " (" + std::to_string(std::thread::hardware_concurrency()) + " Threads)";
+}
+
+static void fill_frame(AVFrame* frame, std::size_t index)
+{
+	auto*    desc  = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(frame->format));
+	bool     wide  = desc->comp[0].depth > 8;
+	uint32_t mask  = (1u << desc->comp[0].depth) - 1;
+	uint32_t shift = static_cast<uint32_t>(desc->comp[0].shift);
+	uint32_t seed  = static_cast<uint32_t>(index) * 2654435761u + 1;
+
+	for (int plane = 0; (plane < AV_NUM_DATA_POINTERS) && frame->data[plane]; plane++) {
+		int height = ((plane == 1) || (plane == 2)) ? AV_CEIL_RSHIFT(frame->height, desc->log2_chroma_h)
+													: frame->height;
+		int width  = frame->linesize[plane] / (wide ? 2 : 1);
+
+		for (int y = 0; y < height; y++) {
+			uint8_t* row = frame->data[plane] + static_cast<ptrdiff_t>(y) * frame->linesize[plane];
+			for (int x = 0; x < width; x++) {
+				// A moving gradient with a bit of noise, so that neither intra nor inter prediction is trivial.
+				seed ^= seed << 13;
+				seed ^= seed >> 17;
+				seed ^= seed << 5;
+				uint32_t v = static_cast<uint32_t>(x + (y >> 1)) + static_cast<uint32_t>(index * 4) + (seed & 0xF);
+
+				if (wide) {
+					reinterpret_cast<uint16_t*>(row)[x] = static_cast<uint16_t>((v & mask) << shift);
+				} else {
+					row[x] = static_cast<uint8_t>(v);
+				}
+			}
+		}
+	}
+}
+
+static std::vector<int> get_thread_types(const AVCodec* codec)
+{
+	std::vector<int> types;
+	if (codec->capabilities & AV_CODEC_CAP_FRAME_THREADS)
+		types.push_back(FF_THREAD_FRAME);
+	if (codec->capabilities & AV_CODEC_CAP_SLICE_THREADS)
+		types.push_back(FF_THREAD_SLICE);
+	if (types.empty() && tools::has_internal_threading(codec))
+		types.push_back(0);
+	return types;
+}
+
+bool thread_tuner::lookup(const AVCodec* codec, const AVCodecContext* context, thread_target target, result& best)
+{
+	if ((target == thread_target::NONE) || get_thread_types(codec).empty())
+		return false;
+
+	auto config = streamfx::configuration::instance();
+	if (!config)
+		return false;
+
+	std::string                  key = cache_key(codec, context, target);
+	std::unique_lock<std::mutex> lock(_cache_lock);
+
+	auto data  = config->get();
+	auto cache = std::shared_ptr<obs_data_t>(obs_data_get_obj(data.get(), cache_name.data()), obs::obs_data_deleter);
+	if (!cache)
+		return false;
+
+	auto entry = std::shared_ptr<obs_data_t>(obs_data_get_obj(cache.get(), key.c_str()), obs::obs_data_deleter);
+	if (!entry)
+		return false;
+
+	best.type    = static_cast<int>(obs_data_get_int(entry.get(), cache_type.data()));
+	best.count   = static_cast<int>(obs_data_get_int(entry.get(), cache_count.data()));
+	best.fps     = obs_data_get_double(entry.get(), cache_fps.data());
+	best.latency = obs_data_get_double(entry.get(), cache_latency.data());
+	return true;
+}
+
+void thread_tuner::schedule(const AVCodec* codec, const AVCodecContext* context, thread_target target)
+{
+	auto pool = streamfx::threadpool();
+	if (!pool || (target == thread_target::NONE) || get_thread_types(codec).empty())
+		return;
+
+	// Encoders for the same configuration are often created in quick succession, only measure once.
+	std::string key = cache_key(codec, context, target);
+	{
+		std::unique_lock<std::mutex> lock(_cache_lock);
+		if (!_pending.insert(key).second)
+			return;
+	}
+
+	// The encoder may be destroyed long before measuring is done, so work on a copy of its configuration.
+	std::shared_ptr<AVCodecContext> copy;
+	try {
+		copy = std::shared_ptr<AVCodecContext>(tools::context_clone(codec, context),
+											   [](AVCodecContext* v) { avcodec_free_context(&v); });
+	} catch (const std::exception& ex) {
+		DLOG_WARNING("[%s] Unable to tune threading: %s", codec->name, ex.what());
+		std::unique_lock<std::mutex> lock(_cache_lock);
+		_pending.erase(key);
+		return;
+	}
+
+	pool->push(
+		[codec, copy, target, key](std::shared_ptr<void>) {
+			result best;
+			tune(codec, copy.get(), target, key, best);
+
+			std::unique_lock<std::mutex> lock(_cache_lock);
+			_pending.erase(key);
+		},
+		nullptr);
+}
+
+bool thread_tuner::tune(const AVCodec* codec, const AVCodecContext* context, thread_target target,
+						const std::string& key, result& best)
+{
+	std::vector<int> types = get_thread_types(codec);
+
+	// Thread counts are swept in powers of two, plus the number of hardware threads.
+	std::vector<int> counts;
+	int              threads = static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+	for (int count = 1; count < threads; count *= 2) {
+		counts.push_back(count);
+	}
+	counts.push_back(threads);
+
+	DLOG_INFO("[%s] Tuning threading for %s in the background...", codec->name, get_target_name(target));
+
+	// A candidate only keeps up with live encoding if it is faster than the frame rate.
+	double frame_time = av_q2d(context->time_base);
+	bool   have_best  = false;
+	bool   expired    = false;
+	auto   start      = std::chrono::steady_clock::now();
+	for (auto type = types.begin(); (type != types.end()) && !expired; type++) {
+		for (auto count = counts.begin(); (count != counts.end()) && !expired; count++) {
+			// Slow encoders could take minutes to sweep, settle for the best candidate so far instead.
+			if ((std::chrono::steady_clock::now() - start) > tune_limit) {
+				DLOG_DEBUG("[%s]   Out of time, skipping the remaining candidates.", codec->name);
+				expired = true;
+				continue;
+			}
+
+			result res{*type, *count, 0., 0.};
+			if (!measure(codec, context, target, res))
+				continue;
+
+			DLOG_DEBUG("[%s]   %s with %i threads: %.2f FPS, %.2f ms latency", codec->name,
+					   tools::get_thread_type_name(res.type), res.count, res.fps, res.latency);
+
+			if (!have_best) {
+				best      = res;
+				have_best = true;
+			} else if (target == thread_target::THROUGHPUT) {
+				// Additional threads have to give a noticeable gain to be worth it.
+				if (res.fps > (best.fps * 1.05))
+					best = res;
+			} else {
+				bool res_realtime  = (res.fps * frame_time) >= 1.;
+				bool best_realtime = (best.fps * frame_time) >= 1.;
+				if (res_realtime && (!best_realtime || (res.latency < (best.latency * 0.95)))) {
+					best = res;
+				} else if (!res_realtime && !best_realtime && (res.fps > best.fps)) {
+					best = res;
+				}
+			}
+		}
+	}
+	if (!have_best)
+		return false;
+
+	DLOG_INFO("[%s] Tuned threading for %s: %s with %i threads (%.2f FPS, %.2f ms latency).", codec->name,
+			  get_target_name(target), tools::get_thread_type_name(best.type), best.count, best.fps, best.latency);
+
+	// Remember the result, encoders created from now on use it.
+	if (auto config = streamfx::configuration::instance(); config) {
+		std::unique_lock<std::mutex> lock(_cache_lock);
+
+		auto data  = config->get();
+		auto cache = std::shared_ptr<obs_data_t>(obs_data_get_obj(data.get(), cache_name.data()), obs::obs_data_deleter);
+		if (!cache) {
+			cache = std::shared_ptr<obs_data_t>(obs_data_create(), obs::obs_data_deleter);
+			obs_data_set_obj(data.get(), cache_name.data(), cache.get());
+		}
+
+		auto entry = std::shared_ptr<obs_data_t>(obs_data_create(), obs::obs_data_deleter);
+		obs_data_set_int(entry.get(), cache_type.data(), best.type);
+		obs_data_set_int(entry.get(), cache_count.data(), best.count);
+		obs_data_set_double(entry.get(), cache_fps.data(), best.fps);
+		obs_data_set_double(entry.get(), cache_latency.data(), best.latency);
+		obs_data_set_obj(cache.get(), key.c_str(), entry.get());
+	}
+
+	return true;
+}
+
+const char* thread_tuner::get_target_name(thread_target target)
+{
+	switch (target) {
+	case thread_target::NONE:
+		return "None";
+	case thread_target::LATENCY:
+		return "Latency";
+	case thread_target::THROUGHPUT:
+		return "Throughput";
+	}
+	return "Unknown";
+}
+
+bool thread_tuner::measure(const AVCodec* codec, const AVCodecContext* source, thread_target target, result& res)
+{
+	using clock = std::chrono::high_resolution_clock;
+
+	AVCodecContext* context = nullptr;
+	AVFrame*        frame   = nullptr;
+	AVPacket*       packet  = nullptr;
+	bool            success = false;
+
+	try {
+		context               = tools::context_clone(codec, source);
+		context->thread_type  = res.type;
+		context->thread_count = res.count;
+		context->delay        = (res.type & FF_THREAD_FRAME) ? res.count : 0;
+		if (int err = avcodec_open2(context, codec, NULL); err < 0)
+			throw std::runtime_error(tools::get_error_description(err));
+
+		frame  = av_frame_alloc();
+		packet = av_packet_alloc();
+		if (!frame || !packet)
+			throw std::bad_alloc();
+
+		frame->format          = context->pix_fmt;
+		frame->width           = context->width;
+		frame->height          = context->height;
+		frame->color_range     = context->color_range;
+		frame->colorspace      = context->colorspace;
+		frame->color_primaries = context->color_primaries;
+		frame->color_trc       = context->color_trc;
+		if (int err = av_frame_get_buffer(frame, 0); err < 0)
+			throw std::runtime_error(tools::get_error_description(err));
+
+		// Live encoding submits frames at the frame rate, throughput is measured by submitting as fast as possible.
+		clock::duration interval = clock::duration::zero();
+		if (target == thread_target::LATENCY) {
+			interval = std::chrono::duration_cast<clock::duration>(
+				std::chrono::duration<double>(av_q2d(context->time_base)));
+		}
+
+		std::map<int64_t, clock::time_point> sent;
+		std::size_t                          received = 0;
+		double                               latency  = 0.;
+
+		auto receive = [&]() {
+			int err = 0;
+			while ((err = avcodec_receive_packet(context, packet)) == 0) {
+				if (auto kv = sent.find(packet->pts); kv != sent.end()) {
+					latency += std::chrono::duration<double, std::milli>(clock::now() - kv->second).count();
+					sent.erase(kv);
+				}
+				received++;
+				av_packet_unref(packet);
+			}
+			if ((err != AVERROR(EAGAIN)) && (err != AVERROR_EOF))
+				throw std::runtime_error(tools::get_error_description(err));
+		};
+
+		auto start = clock::now();
+		for (std::size_t idx = 0; (idx < measure_frames) && ((clock::now() - start) < measure_limit); idx++) {
+			if (interval != clock::duration::zero())
+				std::this_thread::sleep_until(start + interval * static_cast<int64_t>(idx));
+
+			if (int err = av_frame_make_writable(frame); err < 0)
+				throw std::runtime_error(tools::get_error_description(err));
+			fill_frame(frame, idx);
+			frame->pts = static_cast<int64_t>(idx);
+
+			sent.emplace(frame->pts, clock::now());
+			if (int err = avcodec_send_frame(context, frame); err < 0)
+				throw std::runtime_error(tools::get_error_description(err));
+			receive();
+		}
+
+		// Drain the encoder, frames still held by it count towards the latency too.
+		if (int err = avcodec_send_frame(context, nullptr); err < 0)
+			throw std::runtime_error(tools::get_error_description(err));
+		receive();
+
+		double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+		if (received > 0) {
+			res.fps     = static_cast<double>(received) / elapsed;
+			res.latency = latency / static_cast<double>(received);
+			success     = true;
+		}
+	} catch (const std::exception& ex) {
+		DLOG_DEBUG("[%s] Measuring %s with %i threads failed: %s", codec->name, tools::get_thread_type_name(res.type),
+				   res.count, ex.what());
+	}
+
+	av_packet_free(&packet);
+	av_frame_free(&frame);
+	avcodec_free_context(&context);
+	return success;
+}
+
+std::string thread_tuner::cache_key(const AVCodec* codec, const AVCodecContext* context, thread_target target)
+{
+	// Codec specific options such as presets change the cost of encoding drastically.
+	std::size_t options = 0;
+	if (context->priv_data) {
+		char* buffer = nullptr;
+		if (av_opt_serialize(context->priv_data, 0, 0, &buffer, '=', ',') >= 0 && buffer) {
+			options = std::hash<std::string_view>{}(buffer);
+		}
+		av_freep(&buffer);
+	}
+
+	std::stringstream sstr;
+	sstr << codec->name << " " << context->width << "x" << context->height << " "
+		 << tools::get_pixel_format_name(context->pix_fmt) << " " << get_cpu_model() << " "
+		 << get_target_name(target) << " " << std::hex << options;
+	return sstr.str();
+}
@@ -0,0 +1,79 @@
+// FFMPEG Video Encoder Integration for OBS Studio
+// Copyright (c) 2020 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+#include "common.hpp"
+#include <string>
+
+extern "C" {
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4242 4244 4365)
+#endif
+#include <libavcodec/avcodec.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+}
+
+namespace ffmpeg {
+	enum class thread_target : int64_t {
+		NONE       = 0,
+		LATENCY    = 1,
+		THROUGHPUT = 2,
+	};
+
+	/** Finds the best threading configuration for a software encoder by measurement.
+	 *
+	 * A short synthetic encode is run on clones of an already configured context, once for every
+	 * supported thread type and a range of thread counts. Results are cached in the plugin
+	 * configuration per codec, resolution, color format and CPU model, so the sweep only runs once.
+	 * The sweep takes several seconds and runs on the thread pool, so encoders keep their untuned
+	 * defaults until a result has been cached.
+	 */
+	class thread_tuner {
+		public:
+		struct result {
+			int    type;
+			int    count;
+			double fps;
+			double latency;
+		};
+
+		public:
+		// Returns false if no result has been cached for this configuration yet.
+		static bool lookup(const AVCodec* codec, const AVCodecContext* context, thread_target target, result& best);
+
+		// Measures this configuration in the background, unless it is already cached or being measured.
+		static void schedule(const AVCodec* codec, const AVCodecContext* context, thread_target target);
+
+		static const char* get_target_name(thread_target target);
+
+		private:
+		static bool tune(const AVCodec* codec, const AVCodecContext* context, thread_target target,
+						 const std::string& key, result& best);
+
+		static bool measure(const AVCodec* codec, const AVCodecContext* context, thread_target target, result& res);
+
+		static std::string cache_key(const AVCodec* codec, const AVCodecContext* context, thread_target target);
+	};
+} // namespace ffmpeg
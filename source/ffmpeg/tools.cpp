@@ -22,6 +22,7 @@
 #include "tools.hpp"
 #include <list>
 #include <sstream>
+#include <stdexcept>
 #include "plugin.hpp"
 
 extern "C" {
@@ -197,6 +198,15 @@ bool tools::can_hardware_encode(const AVCodec* codec)
 	return false;
 }
 
+bool tools::has_internal_threading(const AVCodec* codec)
+{
+#ifdef AV_CODEC_CAP_OTHER_THREADS
+	return (codec->capabilities & AV_CODEC_CAP_OTHER_THREADS) != 0;
+#else
+	return (codec->capabilities & AV_CODEC_CAP_AUTO_THREADS) != 0;
+#endif
+}
+
 std::vector<AVPixelFormat> tools::get_software_formats(const AVPixelFormat* list)
 {
 	constexpr AVPixelFormat hardware_formats[] = {
@@ -257,6 +267,53 @@ void tools::context_setup_from_obs(const video_output_info* voi, AVCodecContext*
 	context->color_trc       = obs_to_av_color_transfer_characteristics(voi->colorspace);
 }
 
+AVCodecContext* tools::context_clone(const AVCodec* codec, const AVCodecContext* source)
+{
+	AVCodecContext* context = avcodec_alloc_context3(codec);
+	if (!context)
+		throw std::runtime_error("Failed to create encoder context.");
+
+	try {
+		// Copy all generic and codec specific options.
+		if (int res = av_opt_copy(context, source); res < 0)
+			throw std::runtime_error(tools::get_error_description(res));
+		if (context->priv_data && source->priv_data) {
+			if (int res = av_opt_copy(context->priv_data, source->priv_data); res < 0)
+				throw std::runtime_error(tools::get_error_description(res));
+		}
+
+		// Copy the fields that are not exposed as options.
+		context->width                  = source->width;
+		context->height                 = source->height;
+		context->pix_fmt                = source->pix_fmt;
+		context->sw_pix_fmt             = source->sw_pix_fmt;
+		context->time_base              = source->time_base;
+		context->framerate              = source->framerate;
+		context->sample_aspect_ratio    = source->sample_aspect_ratio;
+		context->color_range            = source->color_range;
+		context->colorspace             = source->colorspace;
+		context->color_primaries        = source->color_primaries;
+		context->color_trc              = source->color_trc;
+		context->chroma_sample_location = source->chroma_sample_location;
+		context->profile                = source->profile;
+		context->level                  = source->level;
+		context->thread_type            = source->thread_type;
+		context->thread_count           = source->thread_count;
+		context->delay                  = source->delay;
+
+		// Share the packet allocator, if one is installed.
+		context->opaque = source->opaque;
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(58, 134, 100)
+		context->get_encode_buffer = source->get_encode_buffer;
+#endif
+	} catch (...) {
+		avcodec_free_context(&context);
+		throw;
+	}
+
+	return context;
+}
+
 const char* tools::get_std_compliance_name(int compliance)
 {
 	switch (compliance) {
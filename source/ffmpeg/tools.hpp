@@ -54,10 +54,16 @@ namespace ffmpeg::tools {
 
 	bool can_hardware_encode(const AVCodec* codec);
 
+	// Encoders like libx264 run their own threads instead of frame or slice threading.
+	bool has_internal_threading(const AVCodec* codec);
+
 	std::vector<AVPixelFormat> get_software_formats(const AVPixelFormat* list);
 
 	void context_setup_from_obs(const video_output_info* voi, AVCodecContext* context);
 
+	// Creates an unopened copy of a configured encoder context, including all codec specific options.
+	AVCodecContext* context_clone(const AVCodec* codec, const AVCodecContext* source);
+
 	const char* get_std_compliance_name(int compliance);
 
 	const char* get_thread_type_name(int thread_type);
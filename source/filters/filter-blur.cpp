@@ -19,6 +19,7 @@
 
 #include "filter-blur.hpp"
 #include "strings.hpp"
+#include <algorithm>
 #include <cfloat>
 #include <cinttypes>
 #include <cmath>
@@ -109,6 +110,7 @@ blur_instance::blur_instance(obs_data_t* settings, obs_source_t* self)
 
 		// Create RenderTargets
 		this->_source_rt = std::make_shared<gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+		this->_scaled_rt = std::make_shared<gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
 		this->_output_rt = std::make_shared<gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
 
 		// Load Effects
@@ -122,6 +124,9 @@ blur_instance::blur_instance(obs_data_t* settings, obs_source_t* self)
 		}
 	}
 
+	if (auto governor = ::gfx::resolution_governor::get(); governor)
+		_resolution = governor->register_client(obs_source_get_name(_self));
+
 	update(settings);
 }
 
@@ -299,6 +304,9 @@ void blur_instance::update(obs_data_t* settings)
 			}
 		}
 	}
+
+	if (_resolution)
+		_resolution->update(settings);
 }
 
 void blur_instance::video_tick(float)
@@ -420,12 +428,63 @@ void blur_instance::video_render(gs_effect_t* effect)
 	}
 
 	if (!_output_rendered) {
+		auto begin = std::chrono::high_resolution_clock::now();
+
+		// Downscale the input if the resolution governor asks for it, the result is upscaled on output.
+		std::shared_ptr<gs::texture> input = _source_texture;
+		float_t                      scale = _resolution ? _resolution->scale() : 1.0f;
+		if (scale < 1.0f) {
+#ifdef ENABLE_PROFILING
+			gs::debug_marker gdm{gs::debug_color_convert, "Downscale"};
+#endif
+
+			uint32_t width  = std::max<uint32_t>(static_cast<uint32_t>(baseW * scale), 1);
+			uint32_t height = std::max<uint32_t>(static_cast<uint32_t>(baseH * scale), 1);
+			{
+				auto op = _scaled_rt->render(width, height);
+				gs_ortho(0, static_cast<float>(width), 0, static_cast<float>(height), -1., 1.);
+
+				gs_blend_state_push();
+				gs_reset_blend_state();
+				gs_enable_blending(false);
+				gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+
+				gs_effect_set_texture(gs_effect_get_param_by_name(defaultEffect, "image"),
+									  _source_texture->get_object());
+				while (gs_effect_loop(defaultEffect, "Draw")) {
+					gs_draw_sprite(nullptr, 0, width, height);
+				}
+
+				gs_blend_state_pop();
+			}
+			if (auto tex = _scaled_rt->get_texture(); tex)
+				input = tex;
+		}
+
 		{
 #ifdef ENABLE_PROFILING
 			gs::debug_marker gdm{gs::debug_color_convert, "Blur"};
 #endif
 
-			_blur->set_input(_source_texture);
+			// A region mask only uses the blurred image inside of the region and its feather, everything else is
+			// taken from the original. Restrict the blur to that area so large sources with small regions stay cheap.
+			if (_mask.enabled && (_mask.type == mask_type::Region) && !_mask.region.invert) {
+				float_t feather = _mask.region.feather * (0.5f + std::fabs(_mask.region.feather_shift));
+				float_t left    = std::clamp(_mask.region.left - feather, 0.f, 1.f);
+				float_t top     = std::clamp(_mask.region.top - feather, 0.f, 1.f);
+				float_t right   = std::clamp(_mask.region.right + feather, 0.f, 1.f);
+				float_t bottom  = std::clamp(_mask.region.bottom + feather, 0.f, 1.f);
+				float_t width   = float_t(input->get_width());
+				float_t height  = float_t(input->get_height());
+				_blur->set_region(uint32_t(std::floor(left * width)), uint32_t(std::floor(top * height)),
+								  uint32_t(std::ceil(std::max(right - left, 0.f) * width)),
+								  uint32_t(std::ceil(std::max(bottom - top, 0.f) * height)));
+			} else {
+				_blur->set_region(0, 0, 0, 0);
+			}
+
+			_blur->set_size(_blur_size * scale);
+			_blur->set_input(input);
 			_output_texture = _blur->render();
 		}
 
@@ -520,6 +579,9 @@ void blur_instance::video_render(gs_effect_t* effect)
 			}
 		}
 
+		if (_resolution)
+			_resolution->track(std::chrono::high_resolution_clock::now() - begin);
+
 		_output_rendered = true;
 	}
 
@@ -603,6 +665,9 @@ void blur_factory::get_defaults2(obs_data_t* settings)
 	obs_data_set_default_string(settings, ST_MASK_SOURCE, "");
 	obs_data_set_default_int(settings, ST_MASK_COLOR, 0xFFFFFFFFull);
 	obs_data_set_default_double(settings, ST_MASK_MULTIPLIER, 1.0);
+
+	// Dynamic Resolution
+	::gfx::resolution_governor::defaults(settings);
 }
 
 bool modified_properties(void*, obs_properties_t* props, obs_property* prop, obs_data_t* settings) noexcept
@@ -816,6 +881,8 @@ obs_properties_t* blur_factory::get_properties2(blur_instance* data)
 		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_STEPSCALE_X)));
 		p = obs_properties_add_float_slider(pr, ST_STEPSCALE_Y, D_TRANSLATE(ST_STEPSCALE_Y), 0.0, 1000.0, 0.01);
 		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_STEPSCALE_Y)));
+
+		::gfx::resolution_governor::properties(pr);
 	}
 
 	// Masking
@@ -864,18 +931,13 @@ obs_properties_t* blur_factory::get_properties2(blur_instance* data)
 									OBS_COMBO_FORMAT_STRING);
 		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_MASK_SOURCE)));
 		obs_property_list_add_string(p, "", "");
-		obs::source_tracker::get()->enumerate(
-			[&p](std::string name, obs_source_t*) {
-				obs_property_list_add_string(p, std::string(name + " (Source)").c_str(), name.c_str());
-				return false;
-			},
-			obs::source_tracker::filter_video_sources);
-		obs::source_tracker::get()->enumerate(
-			[&p](std::string name, obs_source_t*) {
-				obs_property_list_add_string(p, std::string(name + " (Scene)").c_str(), name.c_str());
-				return false;
-			},
-			obs::source_tracker::filter_scenes);
+		auto tracker = obs::source_tracker::get();
+		for (auto& name : *tracker->get_names(obs::source_tracker::type::VideoSource)) {
+			obs_property_list_add_string(p, std::string(name + " (Source)").c_str(), name.c_str());
+		}
+		for (auto& name : *tracker->get_names(obs::source_tracker::type::Scene)) {
+			obs_property_list_add_string(p, std::string(name + " (Scene)").c_str(), name.c_str());
+		}
 
 		/// Shared
 		p = obs_properties_add_color(pr, ST_MASK_COLOR, D_TRANSLATE(ST_MASK_COLOR));
@@ -24,6 +24,7 @@
 #include <list>
 #include <map>
 #include "gfx/blur/gfx-blur-base.hpp"
+#include "gfx/gfx-resolution-governor.hpp"
 #include "gfx/gfx-source-texture.hpp"
 #include "obs/gs/gs-effect.hpp"
 #include "obs/gs/gs-helper.hpp"
@@ -47,6 +48,10 @@ namespace streamfx::filter::blur {
 		std::shared_ptr<gs::texture>      _source_texture;
 		bool                              _source_rendered;
 
+		// Dynamic Resolution
+		std::shared_ptr<::gfx::resolution_governor::client> _resolution;
+		std::shared_ptr<gs::rendertarget>                   _scaled_rt;
+
 		// Rendering
 		std::shared_ptr<gs::texture>      _output_texture;
 		std::shared_ptr<gs::rendertarget> _output_rt;
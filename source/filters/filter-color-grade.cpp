@@ -19,7 +19,10 @@
 
 #include "filter-color-grade.hpp"
 #include "strings.hpp"
+#include <algorithm>
+#include <cmath>
 #include <stdexcept>
+#include <vector>
 #include "obs/gs/gs-helper.hpp"
 
 // OBS
@@ -53,6 +56,11 @@
 #define ST_TINT_(x, y) ST_TINT "." D_VSTR(x) "." D_VSTR(y)
 #define ST_CORRECTION ST ".Correction"
 #define ST_CORRECTION_(x) ST_CORRECTION "." D_VSTR(x)
+#define ST_LOOK ST ".Look"
+#define ST_EXPORT ST ".Export"
+#define ST_EXPORT_FILE ST_EXPORT ".File"
+#define ST_EXPORT_SIZE ST_EXPORT ".Size"
+#define ST_EXPORT_SAVE ST_EXPORT ".Save"
 
 #define ST_RENDERMODE ST ".RenderMode"
 #define ST_RENDERMODE_DIRECT ST_RENDERMODE ".Direct"
@@ -61,6 +69,10 @@
 #define ST_RENDERMODE_LUT_6BIT ST_RENDERMODE ".LUT.6Bit"
 #define ST_RENDERMODE_LUT_8BIT ST_RENDERMODE ".LUT.8Bit"
 #define ST_RENDERMODE_LUT_10BIT ST_RENDERMODE ".LUT.10Bit"
+#define ST_INTERPOLATION ST ".Interpolation"
+#define ST_INTERPOLATION_TILED ST_INTERPOLATION ".Tiled"
+#define ST_INTERPOLATION_TRILINEAR ST_INTERPOLATION ".Trilinear"
+#define ST_INTERPOLATION_TETRAHEDRAL ST_INTERPOLATION ".Tetrahedral"
 
 #define RED Red
 #define GREEN Green
@@ -89,6 +101,36 @@ using namespace streamfx::filter::color_grade;
 
 #define LOCAL_PREFIX "<filter::color-grade> "
 
+// CPU versions of the functions in color_conversion_rgb_hsv.effect, these must match exactly.
+static inline void rgb_to_hsv(float r, float g, float b, float& h, float& s, float& v)
+{
+	constexpr float e = 1.0e-10f;
+
+	float p[4], q[4];
+	if (g < b) {
+		p[0] = b, p[1] = g, p[2] = -1.f, p[3] = 2.f / 3.f;
+	} else {
+		p[0] = g, p[1] = b, p[2] = 0.f, p[3] = -1.f / 3.f;
+	}
+	if (r < p[0]) {
+		q[0] = p[0], q[1] = p[1], q[2] = p[3], q[3] = r;
+	} else {
+		q[0] = r, q[1] = p[1], q[2] = p[2], q[3] = p[0];
+	}
+
+	float d = q[0] - std::min(q[3], q[1]);
+	h       = std::fabs(q[2] + (q[3] - q[1]) / (6.f * d + e));
+	s       = d / (q[0] + e);
+	v       = q[0];
+}
+
+static inline float hsv_to_rgb_channel(float h, float s, float v, float k)
+{
+	float t = h + k;
+	t       = std::clamp(std::fabs((t - std::floor(t)) * 6.f - 3.f) - 1.f, 0.f, 1.f);
+	return v * (1.f + (t - 1.f) * s);
+}
+
 color_grade_instance::~color_grade_instance() {}
 
 color_grade_instance::color_grade_instance(obs_data_t* data, obs_source_t* self)
@@ -96,10 +138,14 @@ color_grade_instance::color_grade_instance(obs_data_t* data, obs_source_t* self)
 
 	  _lift(), _gamma(), _gain(), _offset(), _tint_detection(), _tint_luma(), _tint_exponent(), _tint_low(),
 	  _tint_mid(), _tint_hig(), _correction(), _lut_enabled(true), _lut_depth(),
+	  _lut_layout(), _lut_interpolation(),
 
 	  _cache_rt(), _cache_texture(), _cache_fresh(false),
 
-	  _lut_initialized(false), _lut_dirty(true), _lut_producer(), _lut_consumer()
+	  _look_file(), _look_file_mt(), _look(),
+
+	  _lut_initialized(false), _lut_dirty(true), _lut_producer(), _lut_consumer(), _lut_rt(), _lut_texture(),
+	  _lut_texture_depth(), _lut_baked()
 {
 	// Load the color grading effect.
 	auto path = streamfx::data_file_path("effects/color-grade.effect");
@@ -206,6 +252,44 @@ void color_grade_instance::update(obs_data_t* data)
 		}
 	}
 
+	switch (obs_data_get_int(data, ST_INTERPOLATION)) {
+	default:
+	case 0: // Tiled
+		_lut_layout        = gfx::lut::layout::Tiled;
+		_lut_interpolation = gfx::lut::interpolation::Trilinear;
+		break;
+	case 1: // Trilinear
+		_lut_layout        = gfx::lut::layout::Volume;
+		_lut_interpolation = gfx::lut::interpolation::Trilinear;
+		break;
+	case 2: // Tetrahedral
+		_lut_layout        = gfx::lut::layout::Volume;
+		_lut_interpolation = gfx::lut::interpolation::Tetrahedral;
+		break;
+	}
+
+	{ // Only reload the look if the file actually changed.
+		std::filesystem::path           file = obs_data_get_string(data, ST_LOOK);
+		std::filesystem::file_time_type mt   = {};
+		std::error_code                 ec;
+		if (!file.empty()) {
+			mt = std::filesystem::last_write_time(file, ec);
+		}
+
+		if ((file != _look_file) || (mt != _look_file_mt)) {
+			_look_file    = file;
+			_look_file_mt = mt;
+			_look.reset();
+			if (!file.empty()) {
+				try {
+					_look = gfx::lut::cube::load(file);
+				} catch (std::exception const& ex) {
+					DLOG_WARNING(LOCAL_PREFIX "Failed to load look '%s': %s", file.u8string().c_str(), ex.what());
+				}
+			}
+		}
+	}
+
 	if (_lut_enabled && _lut_initialized)
 		_lut_dirty = true;
 }
@@ -308,11 +392,173 @@ void color_grade_instance::rebuild_lut()
 		if (!_lut_texture) {
 			throw std::runtime_error("Failed to produce modified LUT texture.");
 		}
+		_lut_texture_depth = _lut_depth;
 	} else {
 		throw std::runtime_error("Failed to produce LUT texture.");
 	}
+}
+
+uint64_t color_grade_instance::grade_hash()
+{
+	// FNV-1a over everything that grade_transform() depends on.
+	uint64_t hash = 14695981039346656037ull;
+	auto     feed = [&hash](const void* ptr, size_t length) {
+		auto bytes = reinterpret_cast<const uint8_t*>(ptr);
+		for (size_t idx = 0; idx < length; idx++) {
+			hash = (hash ^ bytes[idx]) * 1099511628211ull;
+		}
+	};
+
+	float values[] = {
+		_lift.x,       _lift.y,       _lift.z,       _lift.w,        // Lift
+		_gamma.x,      _gamma.y,      _gamma.z,      _gamma.w,       // Gamma
+		_gain.x,       _gain.y,       _gain.z,       _gain.w,        // Gain
+		_offset.x,     _offset.y,     _offset.z,     _offset.w,      // Offset
+		_tint_low.x,   _tint_low.y,   _tint_low.z,   _tint_exponent, // Tint
+		_tint_mid.x,   _tint_mid.y,   _tint_mid.z,   0.f,            //
+		_tint_hig.x,   _tint_hig.y,   _tint_hig.z,   0.f,            //
+		_correction.x, _correction.y, _correction.z, _correction.w,  // Correction
+	};
+	feed(values, sizeof(values));
+
+	int32_t modes[] = {static_cast<int32_t>(_tint_detection), static_cast<int32_t>(_tint_luma)};
+	feed(modes, sizeof(modes));
+
+	if (_look) {
+		std::string file = _look_file.u8string();
+		int64_t     mt   = static_cast<int64_t>(_look_file_mt.time_since_epoch().count());
+		feed(file.data(), file.size());
+		feed(&mt, sizeof(mt));
+	}
 
-	_lut_dirty = false;
+	return hash;
+}
+
+gfx::lut::transform_t color_grade_instance::grade_transform()
+{
+	// Mirrors PSDraw in color-grade.effect, one stage at a time over the whole batch.
+	return [lift = _lift, gamma = _gamma, gain = _gain, offset = _offset, detection = _tint_detection,
+			luma = _tint_luma, exponent = _tint_exponent, low = _tint_low, mid = _tint_mid, hig = _tint_hig,
+			correction = _correction, look = _look](float* red, float* green, float* blue, size_t count) {
+		// Lift
+		for (size_t idx = 0; idx < count; idx++) {
+			red[idx]   = (red[idx] + lift.x) + lift.w;
+			green[idx] = (green[idx] + lift.y) + lift.w;
+			blue[idx]  = (blue[idx] + lift.z) + lift.w;
+		}
+
+		// Gamma
+		for (size_t idx = 0; idx < count; idx++) {
+			red[idx]   = std::copysign(std::pow(std::pow(std::fabs(red[idx]), gamma.x), gamma.w), red[idx]);
+			green[idx] = std::copysign(std::pow(std::pow(std::fabs(green[idx]), gamma.y), gamma.w), green[idx]);
+			blue[idx]  = std::copysign(std::pow(std::pow(std::fabs(blue[idx]), gamma.z), gamma.w), blue[idx]);
+		}
+
+		// Gain and Offset
+		for (size_t idx = 0; idx < count; idx++) {
+			red[idx]   = ((red[idx] * gain.x) * gain.w + offset.x) + offset.w;
+			green[idx] = ((green[idx] * gain.y) * gain.w + offset.y) + offset.w;
+			blue[idx]  = ((blue[idx] * gain.z) * gain.w + offset.z) + offset.w;
+		}
+
+		// Tint, with the detection and luma modes picked once per batch so that every loop is free of branches.
+		std::vector<float> value(count);
+		switch (detection) {
+		case detection_mode::HSV:
+			for (size_t idx = 0; idx < count; idx++) {
+				value[idx] = std::max(red[idx], std::max(green[idx], blue[idx]));
+			}
+			break;
+		case detection_mode::HSL:
+			for (size_t idx = 0; idx < count; idx++) {
+				value[idx] = (std::max(red[idx], std::max(green[idx], blue[idx]))
+							  + std::min(red[idx], std::min(green[idx], blue[idx])))
+							 / 2.f;
+			}
+			break;
+		case detection_mode::YUV_SDR:
+			for (size_t idx = 0; idx < count; idx++) {
+				value[idx] = 0.2126f * red[idx] + 0.7152f * green[idx] + 0.0722f * blue[idx];
+			}
+			break;
+		}
+
+		switch (luma) {
+		case luma_mode::Linear:
+			break;
+		case luma_mode::Exp:
+			for (size_t idx = 0; idx < count; idx++) {
+				value[idx] = 1.f - std::exp(-value[idx] * exponent);
+			}
+			break;
+		case luma_mode::Exp2:
+			for (size_t idx = 0; idx < count; idx++) {
+				value[idx] = 1.f - std::exp(-value[idx] * value[idx] * exponent * exponent);
+			}
+			break;
+		case luma_mode::Log:
+			for (size_t idx = 0; idx < count; idx++) {
+				value[idx] = (std::log2(value[idx]) + 2.f) / 2.333333f;
+			}
+			break;
+		case luma_mode::Log10:
+			for (size_t idx = 0; idx < count; idx++) {
+				value[idx] = (std::log10(value[idx]) + 1.f) / 2.f;
+			}
+			break;
+		}
+
+		for (size_t idx = 0; idx < count; idx++) {
+			bool  high = value[idx] > .5f;
+			float t    = high ? (value[idx] * 2.f - 1.f) : (value[idx] * 2.f);
+			red[idx] *= high ? (mid.x + (hig.x - mid.x) * t) : (low.x + (mid.x - low.x) * t);
+			green[idx] *= high ? (mid.y + (hig.y - mid.y) * t) : (low.y + (mid.y - low.y) * t);
+			blue[idx] *= high ? (mid.z + (hig.z - mid.z) * t) : (low.z + (mid.z - low.z) * t);
+		}
+
+		// Color Correction
+		for (size_t idx = 0; idx < count; idx++) {
+			float h, s, v;
+			rgb_to_hsv(red[idx], green[idx], blue[idx], h, s, v);
+			h += correction.x;
+			s *= correction.y;
+			v *= correction.z;
+
+			float contrast = std::max(correction.w, 0.f);
+			red[idx]       = (hsv_to_rgb_channel(h, s, v, 1.f) - .5f) * contrast + .5f;
+			green[idx]     = (hsv_to_rgb_channel(h, s, v, 2.f / 3.f) - .5f) * contrast + .5f;
+			blue[idx]      = (hsv_to_rgb_channel(h, s, v, 1.f / 3.f) - .5f) * contrast + .5f;
+		}
+
+		// Look
+		if (look) {
+			look->sample(red, green, blue, count);
+		}
+	};
+}
+
+bool color_grade_instance::on_export(obs_properties_t*, obs_property_t*)
+{
+	obs_data_t*           data = obs_source_get_settings(_self);
+	std::filesystem::path file = obs_data_get_string(data, ST_EXPORT_FILE);
+	size_t                size = static_cast<size_t>(obs_data_get_int(data, ST_EXPORT_SIZE));
+	obs_data_release(data);
+
+	if (file.empty()) {
+		return false;
+	}
+
+	try {
+		auto lut = gfx::lut::cube::bake(size, grade_transform());
+		lut->set_title(obs_source_get_name(_self));
+		lut->save(file);
+		DLOG_INFO(LOCAL_PREFIX "Exported color grade of '%s' to '%s'.", obs_source_get_name(_self),
+				  file.u8string().c_str());
+	} catch (std::exception const& ex) {
+		DLOG_ERROR(LOCAL_PREFIX "Failed to export color grade to '%s': %s", file.u8string().c_str(), ex.what());
+	}
+
+	return false;
 }
 
 void color_grade_instance::video_tick(float)
@@ -374,6 +620,28 @@ void color_grade_instance::video_render(gs_effect_t*)
 			gs::debug_marker gdm{gs::debug_color_convert, "LUT Rendering"};
 #endif
 			if (_lut_dirty) {
+				// Identical grades share a single LUT that is baked on the CPU.
+				_lut_baked = gfx::lut::baker::instance()->acquire(grade_hash(), _lut_depth, _lut_layout,
+																  grade_transform());
+				_lut_dirty = false;
+
+				// Until it is ready, show the change through a LUT rendered on the GPU. A look can only be applied
+				// by the CPU, so in that case keep showing the previous LUT instead.
+				if (!_lut_baked->ready() && (!_look || !_lut_texture || (_lut_texture_depth != _lut_depth))) {
+					rebuild_lut();
+					_cache_fresh = false;
+				}
+			}
+
+			if (_lut_baked && _lut_baked->ready()) {
+				if (auto texture = _lut_baked->texture(); texture != _lut_texture) {
+					_lut_texture       = texture;
+					_lut_texture_depth = _lut_baked->depth();
+					_lut_rt.reset();
+					_cache_fresh = false;
+				}
+			} else if (_lut_baked && _lut_baked->failed()) {
+				_lut_baked.reset();
 				rebuild_lut();
 				_cache_fresh = false;
 			}
@@ -383,9 +651,9 @@ void color_grade_instance::video_render(gs_effect_t*)
 					auto op = _cache_rt->render(width, height);
 					gs_ortho(0, 1., 0, 1., 0, 1);
 
-					auto effect = _lut_consumer->prepare(_lut_depth, _lut_texture);
+					auto effect = _lut_consumer->prepare(_lut_texture_depth, _lut_texture, _lut_interpolation);
 					effect->get_parameter("image").set_texture(_ccache_texture);
-					while (gs_effect_loop(effect->get_object(), "Draw")) {
+					while (gs_effect_loop(effect->get_object(), _lut_consumer->technique())) {
 						streamfx::gs_draw_fullscreen_tri();
 					}
 				}
@@ -396,6 +664,7 @@ void color_grade_instance::video_render(gs_effect_t*)
 		} catch (std::exception const& ex) {
 			_lut_rt.reset();
 			_lut_texture.reset();
+			_lut_baked.reset();
 			_lut_enabled = false;
 			DLOG_WARNING(LOCAL_PREFIX "Reverting to direct rendering due to error: %s", ex.what());
 		}
@@ -496,8 +765,12 @@ void color_grade_factory::get_defaults2(obs_data_t* data)
 	obs_data_set_default_double(data, ST_CORRECTION_(SATURATION), 100.0);
 	obs_data_set_default_double(data, ST_CORRECTION_(LIGHTNESS), 100.0);
 	obs_data_set_default_double(data, ST_CORRECTION_(CONTRAST), 100.0);
+	obs_data_set_default_string(data, ST_LOOK, "");
+	obs_data_set_default_string(data, ST_EXPORT_FILE, "");
+	obs_data_set_default_int(data, ST_EXPORT_SIZE, 33);
 
 	obs_data_set_default_int(data, ST_RENDERMODE, -1);
+	obs_data_set_default_int(data, ST_INTERPOLATION, 0);
 }
 
 obs_properties_t* color_grade_factory::get_properties2(color_grade_instance* data)
@@ -583,6 +856,36 @@ obs_properties_t* color_grade_factory::get_properties2(color_grade_instance* dat
 										1000.0, 0.01);
 	}
 
+	{
+		auto p = obs_properties_add_path(pr, ST_LOOK, D_TRANSLATE(ST_LOOK), OBS_PATH_FILE, S_FILEFILTERS_LUT, nullptr);
+		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_LOOK)));
+	}
+
+	{
+		obs_properties_t* grp = obs_properties_create();
+		obs_properties_add_group(pr, ST_EXPORT, D_TRANSLATE(ST_EXPORT), OBS_GROUP_NORMAL, grp);
+
+		{
+			auto p = obs_properties_add_path(grp, ST_EXPORT_FILE, D_TRANSLATE(ST_EXPORT_FILE), OBS_PATH_FILE_SAVE,
+											 S_FILEFILTERS_LUT, nullptr);
+			obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_EXPORT_FILE)));
+		}
+
+		{
+			auto p = obs_properties_add_int_slider(grp, ST_EXPORT_SIZE, D_TRANSLATE(ST_EXPORT_SIZE), 2, 256, 1);
+			obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_EXPORT_SIZE)));
+		}
+
+		if (data) {
+			obs_properties_add_button2(
+				grp, ST_EXPORT_SAVE, D_TRANSLATE(ST_EXPORT_SAVE),
+				[](obs_properties_t* props, obs_property_t* property, void* data) {
+					return reinterpret_cast<color_grade_instance*>(data)->on_export(props, property);
+				},
+				data);
+		}
+	}
+
 	{
 		obs_properties_t* grp = obs_properties_create();
 		obs_properties_add_group(pr, S_ADVANCED, D_TRANSLATE(S_ADVANCED), OBS_GROUP_NORMAL, grp);
@@ -631,6 +934,15 @@ obs_properties_t* color_grade_factory::get_properties2(color_grade_instance* dat
 				obs_property_list_add_int(p, D_TRANSLATE(kv.first), kv.second);
 			}
 		}
+
+		{
+			auto p = obs_properties_add_list(grp, ST_INTERPOLATION, D_TRANSLATE(ST_INTERPOLATION),
+											 OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+			obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_INTERPOLATION)));
+			obs_property_list_add_int(p, D_TRANSLATE(ST_INTERPOLATION_TILED), 0);
+			obs_property_list_add_int(p, D_TRANSLATE(ST_INTERPOLATION_TRILINEAR), 1);
+			obs_property_list_add_int(p, D_TRANSLATE(ST_INTERPOLATION_TETRAHEDRAL), 2);
+		}
 	}
 
 	return pr;
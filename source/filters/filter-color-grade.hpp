@@ -18,8 +18,11 @@
  */
 
 #pragma once
+#include <filesystem>
 #include <vector>
+#include "gfx/lut/gfx-lut-baker.hpp"
 #include "gfx/lut/gfx-lut-consumer.hpp"
+#include "gfx/lut/gfx-lut-cube.hpp"
 #include "gfx/lut/gfx-lut-producer.hpp"
 #include "gfx/lut/gfx-lut.hpp"
 #include "obs/gs/gs-mipmapper.hpp"
@@ -48,19 +51,26 @@ namespace streamfx::filter::color_grade {
 		gs::effect _effect;
 
 		// User Configuration
-		vec4                  _lift;
-		vec4                  _gamma;
-		vec4                  _gain;
-		vec4                  _offset;
-		detection_mode        _tint_detection;
-		luma_mode             _tint_luma;
-		float_t               _tint_exponent;
-		vec3                  _tint_low;
-		vec3                  _tint_mid;
-		vec3                  _tint_hig;
-		vec4                  _correction;
-		bool                  _lut_enabled;
-		gfx::lut::color_depth _lut_depth;
+		vec4                    _lift;
+		vec4                    _gamma;
+		vec4                    _gain;
+		vec4                    _offset;
+		detection_mode          _tint_detection;
+		luma_mode               _tint_luma;
+		float_t                 _tint_exponent;
+		vec3                    _tint_low;
+		vec3                    _tint_mid;
+		vec3                    _tint_hig;
+		vec4                    _correction;
+		bool                    _lut_enabled;
+		gfx::lut::color_depth   _lut_depth;
+		gfx::lut::layout        _lut_layout;
+		gfx::lut::interpolation _lut_interpolation;
+
+		// Look
+		std::filesystem::path           _look_file;
+		std::filesystem::file_time_type _look_file_mt;
+		std::shared_ptr<gfx::lut::cube> _look;
 
 		// Capture Cache
 		std::shared_ptr<gs::rendertarget> _ccache_rt;
@@ -74,6 +84,8 @@ namespace streamfx::filter::color_grade {
 		std::shared_ptr<gfx::lut::consumer> _lut_consumer;
 		std::shared_ptr<gs::rendertarget>   _lut_rt;
 		std::shared_ptr<gs::texture>        _lut_texture;
+		gfx::lut::color_depth               _lut_texture_depth;
+		std::shared_ptr<gfx::lut::baked>    _lut_baked;
 
 		// Render Cache
 		std::shared_ptr<gs::rendertarget> _cache_rt;
@@ -94,6 +106,12 @@ namespace streamfx::filter::color_grade {
 
 		void rebuild_lut();
 
+		uint64_t grade_hash();
+
+		gfx::lut::transform_t grade_transform();
+
+		bool on_export(obs_properties_t* props, obs_property_t* property);
+
 		virtual void video_tick(float_t time) override;
 		virtual void video_render(gs_effect_t* effect) override;
 	};
@@ -19,6 +19,8 @@
 
 #include "filter-dynamic-mask.hpp"
 #include "strings.hpp"
+#include <algorithm>
+#include <cmath>
 #include <sstream>
 #include <stdexcept>
 #include <vector>
@@ -36,6 +38,12 @@
 #define ST "Filter.DynamicMask"
 
 #define ST_INPUT "Filter.DynamicMask.Input"
+#define ST_INPUT_RESOLUTION "Filter.DynamicMask.Input.Resolution"
+#define ST_INPUT_RESOLUTION_(x) ST_INPUT_RESOLUTION "." D_VSTR(x)
+#define ST_INPUT_SCALE "Filter.DynamicMask.Input.Scale"
+#define ST_INPUT_WIDTH "Filter.DynamicMask.Input.Width"
+#define ST_INPUT_HEIGHT "Filter.DynamicMask.Input.Height"
+#define ST_INPUT_MIPMAPPING "Filter.DynamicMask.Input.Mipmapping"
 #define ST_CHANNEL "Filter.DynamicMask.Channel"
 #define ST_CHANNEL_VALUE "Filter.DynamicMask.Channel.Value"
 #define ST_CHANNEL_MULTIPLIER "Filter.DynamicMask.Channel.Multiplier"
@@ -53,7 +61,9 @@ static std::pair<channel, const char*> channel_translations[] = {
 dynamic_mask_instance::dynamic_mask_instance(obs_data_t* settings, obs_source_t* self)
 	: obs::source_instance(settings, self), _translation_map(), _effect(), _have_filter_texture(false), _filter_rt(),
 	  _filter_texture(), _have_input_texture(false), _input(), _input_capture(), _input_texture(),
-	  _have_final_texture(false), _final_rt(), _final_texture(), _channels(), _precalc()
+	  _input_resolution(input_resolution::Native), _input_scale(1.0f), _input_size(), _input_mipmapping(false),
+	  _input_mipmapper(), _input_mipmapped(), _have_final_texture(false), _final_rt(), _final_texture(), _channels(),
+	  _precalc()
 {
 	_filter_rt = std::make_shared<gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
 	_final_rt  = std::make_shared<gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
@@ -102,6 +112,16 @@ void dynamic_mask_instance::update(obs_data_t* settings)
 		DLOG_ERROR("Failed to update input: %s", ex.what());
 	}
 
+	// Input resolution
+	_input_resolution  = static_cast<input_resolution>(obs_data_get_int(settings, ST_INPUT_RESOLUTION));
+	_input_scale       = static_cast<float_t>(obs_data_get_double(settings, ST_INPUT_SCALE) / 100.0);
+	_input_size.first  = static_cast<uint32_t>(obs_data_get_int(settings, ST_INPUT_WIDTH));
+	_input_size.second = static_cast<uint32_t>(obs_data_get_int(settings, ST_INPUT_HEIGHT));
+	_input_mipmapping  = obs_data_get_bool(settings, ST_INPUT_MIPMAPPING);
+	if (!_input_mipmapping) {
+		_input_mipmapped.reset();
+	}
+
 	// Update data store
 	for (auto kv1 : channel_translations) {
 		auto found = _channels.find(kv1.first);
@@ -259,7 +279,44 @@ void dynamic_mask_instance::video_render(gs_effect_t* in_effect)
 								 obs_source_get_name(_input_capture->get_object())};
 #endif
 
-			_input_texture      = _input_capture->render(_input->width(), _input->height());
+			// The mask is only sampled, so there is no need to capture it at more detail than asked for.
+			uint32_t input_width  = _input->width();
+			uint32_t input_height = _input->height();
+			switch (_input_resolution) {
+			case input_resolution::Scale:
+				input_width  = static_cast<uint32_t>(std::lround(input_width * _input_scale));
+				input_height = static_cast<uint32_t>(std::lround(input_height * _input_scale));
+				break;
+			case input_resolution::Fixed:
+				input_width  = _input_size.first;
+				input_height = _input_size.second;
+				break;
+			default:
+				break;
+			}
+			input_width  = std::max<uint32_t>(input_width, 1);
+			input_height = std::max<uint32_t>(input_height, 1);
+
+			_input_texture = _input_capture->render(input_width, input_height);
+
+			// Mipmaps only help if the capture is larger than what it is sampled at.
+			if (_input_mipmapping && _input_texture && ((input_width > width) || (input_height > height))) {
+#ifdef ENABLE_PROFILING
+				gs::debug_marker gdr{gs::debug_color_convert, "Mipmap"};
+#endif
+
+				if (!_input_mipmapped || (_input_mipmapped->get_width() != input_width)
+					|| (_input_mipmapped->get_height() != input_height)) {
+					std::size_t mip_levels = std::max(util::math::get_power_of_two_exponent_ceil(input_width),
+													  util::math::get_power_of_two_exponent_ceil(input_height));
+					_input_mipmapped = std::make_shared<gs::texture>(input_width, input_height, GS_RGBA,
+																	 static_cast<uint32_t>(mip_levels), nullptr,
+																	 gs::texture::flags::None);
+				}
+				_input_mipmapper.rebuild(_input_texture, _input_mipmapped);
+				_input_texture = _input_mipmapped;
+			}
+
 			_have_input_texture = true;
 		}
 
@@ -311,7 +368,7 @@ void dynamic_mask_instance::video_render(gs_effect_t* in_effect)
 		return;
 	}
 
-	if (!_have_filter_texture || !_have_input_texture || !_have_final_texture) {
+	if (!_have_filter_texture || !_have_input_texture || !_have_final_texture || !_input_texture) {
 		obs_source_skip_video_filter(_self);
 		return;
 	}
@@ -413,6 +470,11 @@ const char* dynamic_mask_factory::get_name()
 
 void dynamic_mask_factory::get_defaults2(obs_data_t* data)
 {
+	obs_data_set_default_int(data, ST_INPUT_RESOLUTION, static_cast<int64_t>(input_resolution::Native));
+	obs_data_set_default_double(data, ST_INPUT_SCALE, 50.0);
+	obs_data_set_default_int(data, ST_INPUT_WIDTH, 640);
+	obs_data_set_default_int(data, ST_INPUT_HEIGHT, 360);
+	obs_data_set_default_bool(data, ST_INPUT_MIPMAPPING, false);
 	obs_data_set_default_int(data, ST_CHANNEL, static_cast<int64_t>(channel::Red));
 	for (auto kv : channel_translations) {
 		obs_data_set_default_double(data, (std::string(ST_CHANNEL_VALUE) + "." + kv.second).c_str(), 1.0);
@@ -424,6 +486,22 @@ void dynamic_mask_factory::get_defaults2(obs_data_t* data)
 	}
 }
 
+static bool modified_input_resolution(obs_properties_t* props, obs_property_t*, obs_data_t* settings) noexcept
+try {
+	auto mode = static_cast<input_resolution>(obs_data_get_int(settings, ST_INPUT_RESOLUTION));
+	obs_property_set_visible(obs_properties_get(props, ST_INPUT_SCALE), mode == input_resolution::Scale);
+	obs_property_set_visible(obs_properties_get(props, ST_INPUT_WIDTH), mode == input_resolution::Fixed);
+	obs_property_set_visible(obs_properties_get(props, ST_INPUT_HEIGHT), mode == input_resolution::Fixed);
+	obs_property_set_visible(obs_properties_get(props, ST_INPUT_MIPMAPPING), mode != input_resolution::Native);
+	return true;
+} catch (const std::exception& ex) {
+	DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
+	return false;
+} catch (...) {
+	DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
+	return false;
+}
+
 obs_properties_t* dynamic_mask_factory::get_properties2(dynamic_mask_instance* data)
 {
 	obs_properties_t* props = obs_properties_create();
@@ -436,22 +514,45 @@ obs_properties_t* dynamic_mask_factory::get_properties2(dynamic_mask_instance* d
 									OBS_COMBO_FORMAT_STRING);
 		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_INPUT)));
 		obs_property_list_add_string(p, "", "");
-		obs::source_tracker::get()->enumerate(
-			[&p](std::string name, obs_source_t*) {
-				std::stringstream sstr;
-				sstr << name << " (" << D_TRANSLATE(S_SOURCETYPE_SOURCE) << ")";
-				obs_property_list_add_string(p, sstr.str().c_str(), name.c_str());
-				return false;
-			},
-			obs::source_tracker::filter_video_sources);
-		obs::source_tracker::get()->enumerate(
-			[&p](std::string name, obs_source_t*) {
-				std::stringstream sstr;
-				sstr << name << " (" << D_TRANSLATE(S_SOURCETYPE_SCENE) << ")";
-				obs_property_list_add_string(p, sstr.str().c_str(), name.c_str());
-				return false;
-			},
-			obs::source_tracker::filter_scenes);
+		auto tracker = obs::source_tracker::get();
+		for (auto& name : *tracker->get_names(obs::source_tracker::type::VideoSource)) {
+			std::stringstream sstr;
+			sstr << name << " (" << D_TRANSLATE(S_SOURCETYPE_SOURCE) << ")";
+			obs_property_list_add_string(p, sstr.str().c_str(), name.c_str());
+		}
+		for (auto& name : *tracker->get_names(obs::source_tracker::type::Scene)) {
+			std::stringstream sstr;
+			sstr << name << " (" << D_TRANSLATE(S_SOURCETYPE_SCENE) << ")";
+			obs_property_list_add_string(p, sstr.str().c_str(), name.c_str());
+		}
+	}
+
+	{ // Input Resolution
+		p = obs_properties_add_list(props, ST_INPUT_RESOLUTION, D_TRANSLATE(ST_INPUT_RESOLUTION), OBS_COMBO_TYPE_LIST,
+									OBS_COMBO_FORMAT_INT);
+		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_INPUT_RESOLUTION)));
+		obs_property_set_modified_callback(p, modified_input_resolution);
+		obs_property_list_add_int(p, D_TRANSLATE(ST_INPUT_RESOLUTION_(Native)),
+								  static_cast<int64_t>(input_resolution::Native));
+		obs_property_list_add_int(p, D_TRANSLATE(ST_INPUT_RESOLUTION_(Scale)),
+								  static_cast<int64_t>(input_resolution::Scale));
+		obs_property_list_add_int(p, D_TRANSLATE(ST_INPUT_RESOLUTION_(Fixed)),
+								  static_cast<int64_t>(input_resolution::Fixed));
+
+		p = obs_properties_add_float_slider(props, ST_INPUT_SCALE, D_TRANSLATE(ST_INPUT_SCALE), 1.0, 100.0, 0.01);
+		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_INPUT_SCALE)));
+		obs_property_float_set_suffix(p, " %");
+
+		p = obs_properties_add_int(props, ST_INPUT_WIDTH, D_TRANSLATE(ST_INPUT_WIDTH), 1, 16383, 1);
+		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_INPUT_WIDTH)));
+		obs_property_int_set_suffix(p, " px");
+
+		p = obs_properties_add_int(props, ST_INPUT_HEIGHT, D_TRANSLATE(ST_INPUT_HEIGHT), 1, 16383, 1);
+		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_INPUT_HEIGHT)));
+		obs_property_int_set_suffix(p, " px");
+
+		p = obs_properties_add_bool(props, ST_INPUT_MIPMAPPING, D_TRANSLATE(ST_INPUT_MIPMAPPING));
+		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_INPUT_MIPMAPPING)));
 	}
 
 	const char* pri_chs[] = {S_CHANNEL_RED, S_CHANNEL_GREEN, S_CHANNEL_BLUE, S_CHANNEL_ALPHA};
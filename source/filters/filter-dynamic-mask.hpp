@@ -23,6 +23,7 @@
 #include <map>
 #include "gfx/gfx-source-texture.hpp"
 #include "obs/gs/gs-effect.hpp"
+#include "obs/gs/gs-mipmapper.hpp"
 #include "obs/obs-source-factory.hpp"
 #include "obs/obs-source-tracker.hpp"
 #include "obs/obs-source.hpp"
@@ -31,6 +32,12 @@
 namespace streamfx::filter::dynamic_mask {
 	enum class channel : int8_t { Invalid = -1, Red, Green, Blue, Alpha };
 
+	enum class input_resolution : int64_t {
+		Native = 0, // Capture the input at its own size.
+		Scale  = 1, // Capture the input at a fraction of its own size.
+		Fixed  = 2, // Capture the input at a fixed size.
+	};
+
 	class dynamic_mask_instance : public obs::source_instance {
 		std::map<std::tuple<channel, channel, std::string>, std::string> _translation_map;
 
@@ -47,6 +54,13 @@ namespace streamfx::filter::dynamic_mask {
 		std::shared_ptr<obs::tools::visible_source> _input_vs;
 		std::shared_ptr<obs::tools::active_source>  _input_ac;
 
+		input_resolution              _input_resolution;
+		float_t                       _input_scale;
+		std::pair<uint32_t, uint32_t> _input_size;
+		bool                          _input_mipmapping;
+		gs::mipmapper                 _input_mipmapper;
+		std::shared_ptr<gs::texture>  _input_mipmapped;
+
 		bool                              _have_final_texture;
 		std::shared_ptr<gs::rendertarget> _final_rt;
 		std::shared_ptr<gs::texture>      _final_texture;
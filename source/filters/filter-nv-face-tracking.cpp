@@ -21,10 +21,16 @@
 #include <algorithm>
 #include <filesystem>
 #include <util/platform.h>
-#include "nvidia/cuda/nvidia-cuda-context-stack.hpp"
+#include "gfx/tracking/gfx-tracking-cpu.hpp"
+#include "gfx/tracking/gfx-tracking-replay.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/obs-roi-channel.hpp"
 #include "obs/obs-tools.hpp"
 
+#ifdef ENABLE_FILTER_NVIDIA_FACE_TRACKING_NVAR
+#include "gfx/tracking/gfx-tracking-nvidia.hpp"
+#endif
+
 #define ST "Filter.Nvidia.FaceTracking"
 #define ST_ROI "Filter.Nvidia.FaceTracking.ROI"
 #define ST_ROI_ZOOM "Filter.Nvidia.FaceTracking.ROI.Zoom"
@@ -36,14 +42,22 @@
 #define SK_ROI_OFFSET_Y "ROI.Offset.Y"
 #define ST_ROI_STABILITY "Filter.Nvidia.FaceTracking.ROI.Stability"
 #define SK_ROI_STABILITY "ROI.Stability"
+#define ST_TRACKER "Filter.Nvidia.FaceTracking.Tracker"
+#define ST_TRACKER_BACKEND "Filter.Nvidia.FaceTracking.Tracker.Backend"
+#define ST_TRACKER_BACKEND_NVIDIA "Filter.Nvidia.FaceTracking.Tracker.Backend.NVIDIA"
+#define ST_TRACKER_BACKEND_CPU "Filter.Nvidia.FaceTracking.Tracker.Backend.CPU"
+#define ST_TRACKER_BACKEND_REPLAY "Filter.Nvidia.FaceTracking.Tracker.Backend.Replay"
+#define SK_TRACKER_BACKEND "Tracker.Backend"
+#define ST_TRACKER_FILE "Filter.Nvidia.FaceTracking.Tracker.File"
+#define SK_TRACKER_FILE "Tracker.File"
+#define ST_TRACKER_DEPTH "Filter.Nvidia.FaceTracking.Tracker.Depth"
+#define SK_TRACKER_DEPTH "Tracker.Depth"
+
+// Limit on how far ahead of the last tracking result the region is predicted, in seconds.
+#define PREDICTION_LIMIT 0.25
 
 using namespace streamfx::filter::nvidia;
 
-void ar_feature_deleter(NvAR_FeatureHandle v)
-{
-	face_tracking_factory::get()->get_ar()->destroy(v);
-}
-
 face_tracking_instance::face_tracking_instance(obs_data_t* settings, obs_source_t* self)
 	: obs::source_instance(settings, self),
 
@@ -53,61 +67,59 @@ face_tracking_instance::face_tracking_instance(obs_data_t* settings, obs_source_
 
 	  _geometry(), _filters(), _values(),
 
-	  _cuda(face_tracking_factory::get()->get_cuda()), _cuda_ctx(face_tracking_factory::get()->get_cuda_context()),
-	  _cuda_stream(),
-
-	  _ar_library(face_tracking_factory::get()->get_ar()), _ar_loaded(false), _ar_feature(), _ar_is_tracking(false),
-	  _ar_bboxes_confidence(), _ar_bboxes_data(), _ar_bboxes(), _ar_texture(), _ar_texture_cuda_fresh(false),
-	  _ar_texture_cuda(), _ar_texture_cuda_mem(), _ar_image(), _ar_image_bgr(), _ar_image_temp()
+	  _tracker_backend(tracker_backend::Invalid), _tracker_file(), _tracker(), _tracker_generation(0),
+	  _tracker_depth(1), _captures(), _capture_index(0)
 {
 #ifdef ENABLE_PROFILING
 	// Profiling
-	_profile_capture         = util::profiler::create();
-	_profile_capture_realloc = util::profiler::create();
-	_profile_capture_copy    = util::profiler::create();
-	_profile_ar_realloc      = util::profiler::create();
-	_profile_ar_copy         = util::profiler::create();
-	_profile_ar_transfer     = util::profiler::create();
-	_profile_ar_run          = util::profiler::create();
-	_profile_ar_calc         = util::profiler::create();
+	_profile_capture       = util::profiler::create();
+	_profile_track_capture = util::profiler::create();
+	_profile_track_run     = util::profiler::create();
+	_profile_track_calc    = util::profiler::create();
 #endif
 
-	{ // Create render target, vertex buffer, and CUDA stream.
-		auto gctx    = gs::context{};
-		_rt          = std::make_shared<gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
-		_geometry    = std::make_shared<gs::vertex_buffer>(uint32_t(4), uint8_t(1));
-		auto cctx    = std::make_shared<::nvidia::cuda::context_stack>(_cuda, _cuda_ctx);
-		_cuda_stream = std::make_shared<::nvidia::cuda::stream>(_cuda, ::nvidia::cuda::stream_flags::NON_BLOCKING, 0);
-	}
-
-	{ // Asynchronously load Face Tracking.
-		async_initialize();
+	{ // Create render target and vertex buffer.
+		auto gctx = gs::context{};
+		_rt       = std::make_shared<gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+		_geometry = std::make_shared<gs::vertex_buffer>(uint32_t(4), uint8_t(1));
 	}
 
 	{ // Set up initial tracking data.
 		_values.center[0] = _values.center[1] = .5;
 		_values.size[0] = _values.size[1] = 1.;
-		refresh_region_of_interest();
+		_values.velocity[0] = _values.velocity[1] = 0.;
+		_values.timestamp                         = 0;
+		_values.has_face                          = false;
 	}
+
+	// Apply the settings, which also asynchronously creates the tracker.
+	update(settings);
 }
 
 face_tracking_instance::~face_tracking_instance()
 {
 	// Kill pending tasks.
 	streamfx::threadpool()->pop(_async_initialize);
-	streamfx::threadpool()->pop(_async_track);
+	for (auto& slot : _captures) {
+		streamfx::threadpool()->pop(slot->task);
+	}
+
+	// Stop encoders from using our regions.
+	if (auto channel = obs::roi_channel::get(); channel) {
+		channel->withdraw(obs_filter_get_parent(_self));
+	}
 
-	_ar_loaded.store(false);
-	std::unique_lock<std::mutex> alk{_ar_lock};
-	_ar_library->image_dealloc(&_ar_image_temp);
-	_ar_library->image_dealloc(&_ar_image_bgr);
+	std::unique_lock<std::mutex> lk{_tracker_lock};
+	_tracker.reset();
 }
 
 void face_tracking_instance::async_initialize(std::shared_ptr<void> ptr)
 {
 	struct async_data {
 		std::shared_ptr<obs_weak_source_t> source;
-		std::string                        models_path;
+		tracker_backend                    backend;
+		std::string                        file;
+		uint64_t                           generation;
 	};
 
 	if (!ptr) {
@@ -115,14 +127,9 @@ void face_tracking_instance::async_initialize(std::shared_ptr<void> ptr)
 		std::shared_ptr<async_data> data = std::make_shared<async_data>();
 		data->source =
 			std::shared_ptr<obs_weak_source_t>(obs_source_get_weak_source(_self), obs::obs_weak_source_deleter);
-
-		{
-			std::filesystem::path models_path = _ar_library->get_ar_sdk_path();
-			models_path                       = models_path.append("models");
-			models_path                       = std::filesystem::absolute(models_path);
-			models_path.concat("\\");
-			data->models_path = models_path.string();
-		}
+		data->backend    = _tracker_backend;
+		data->file       = _tracker_file;
+		data->generation = ++_tracker_generation;
 
 		_async_initialize = streamfx::threadpool()->push(
 			std::bind(&face_tracking_instance::async_initialize, this, std::placeholders::_1), data);
@@ -136,124 +143,115 @@ void face_tracking_instance::async_initialize(std::shared_ptr<void> ptr)
 			return;
 		}
 
-		// Update the current CUDA context for working.
-		gs::context gctx;
-		auto        cctx = std::make_shared<::nvidia::cuda::context_stack>(_cuda, _cuda_ctx);
-
-		// Create Face Detection feature.
-		{
-			NvAR_FeatureHandle fd_inst;
-			if (NvCV_Status res = _ar_library->create(NvAR_Feature_FaceDetection, &fd_inst); res != NVCV_SUCCESS) {
-				throw std::runtime_error("Failed to create Face Detection feature.");
-			}
-			_ar_feature = std::shared_ptr<nvAR_Feature>{fd_inst, ar_feature_deleter};
-		}
-
-		// Set the correct CUDA stream for processing.
-		if (NvCV_Status res = _ar_library->set_cuda_stream(_ar_feature.get(), NvAR_Parameter_Config(CUDAStream),
-														   reinterpret_cast<CUstream>(_cuda_stream->get()));
-			res != NVCV_SUCCESS) {
-			throw std::runtime_error("Failed to set CUDA stream.");
-		}
-
-		// Set the correct models path.
-		if (NvCV_Status res =
-				_ar_library->set_string(_ar_feature.get(), NvAR_Parameter_Config(ModelDir), data->models_path.c_str());
-			res != NVCV_SUCCESS) {
-			throw std::runtime_error("Unable to set model path.");
-		}
-
-		// Finally enable Temporal tracking if possible.
-		if (NvCV_Status res = _ar_library->set_uint32(_ar_feature.get(), NvAR_Parameter_Config(Temporal), 1);
-			res != NVCV_SUCCESS) {
-			DLOG_WARNING("<%s> Unable to enable Temporal tracking mode.", obs_source_get_name(remote_work.get()));
+		// Create the tracker (may take long).
+		std::shared_ptr<gfx::tracking::backend> tracker;
+		try {
+			tracker = face_tracking_factory::get()->create_backend(data->backend, data->file);
+		} catch (const std::exception& ex) {
+			DLOG_ERROR("<%s> Failed to create tracker: %s", obs_source_get_name(remote_work.get()), ex.what());
 		}
 
-		// Create Bounding Boxes Data
-		_ar_bboxes_data.assign(1, {0., 0., 0., 0.});
-		_ar_bboxes.boxes     = _ar_bboxes_data.data();
-		_ar_bboxes.max_boxes = std::clamp<uint8_t>(static_cast<uint8_t>(_ar_bboxes_data.size()), 0, 255);
-		_ar_bboxes.num_boxes = 0;
-		_ar_bboxes_confidence.resize(_ar_bboxes_data.size());
-		if (NvCV_Status res = _ar_library->set_object(_ar_feature.get(), NvAR_Parameter_Output(BoundingBoxes),
-													  &_ar_bboxes, sizeof(NvAR_BBoxes));
-			res != NVCV_SUCCESS) {
-			throw std::runtime_error("Failed to set BoundingBoxes for Face Tracking feature.");
+		// Only keep the tracker if the settings haven't changed in the meantime.
+		std::unique_lock<std::mutex> lk{_tracker_lock};
+		if (data->generation == _tracker_generation) {
+			_tracker = tracker;
+			_async_initialize.reset();
 		}
-		if (NvCV_Status res = _ar_library->set_float32_array(
-				_ar_feature.get(), NvAR_Parameter_Output(BoundingBoxesConfidence), _ar_bboxes_confidence.data(),
-				static_cast<int>(_ar_bboxes_confidence.size()));
-			res != NVCV_SUCCESS) {
-			throw std::runtime_error("Failed to set BoundingBoxesConfidence for Face Tracking feature.");
-		}
-
-		// And finally, load the feature (takes long).
-		if (NvCV_Status res = _ar_library->load(_ar_feature.get()); res != NVCV_SUCCESS) {
-			DLOG_ERROR("<%s> Failed to load Face Tracking feature.", obs_source_get_name(_self));
-			_ar_loaded = false;
-			return;
-		} else {
-			_ar_loaded = true;
-		}
-
-		_async_initialize.reset();
 	}
 }
 
 void face_tracking_instance::async_track(std::shared_ptr<void> ptr)
 {
 	struct async_data {
-		std::shared_ptr<obs_weak_source_t> source;
+		std::shared_ptr<obs_weak_source_t>      source;
+		std::shared_ptr<gfx::tracking::backend> tracker;
+		std::shared_ptr<capture>                slot;
+		std::pair<uint32_t, uint32_t>           size;
 	};
 
-	if (!_ar_loaded)
-		return;
-
 	if (!ptr) {
-		// Check if we can track.
-		if (_ar_is_tracking)
-			return; // Can't track a new frame right now.
+		std::shared_ptr<gfx::tracking::backend> tracker;
+		{
+			std::unique_lock<std::mutex> lk{_tracker_lock};
+			tracker = _tracker;
+		}
+		if (!tracker)
+			return;
 
-#ifdef ENABLE_PROFILING
-		gs::debug_marker gdm{gs::debug_color_convert, "Start Asynchronous Tracking"};
-#endif
+		// Let the tracker read back earlier frames, then hand those it could not read before back to the thread pool.
+		tracker->update();
+		auto dispatch = [this, &tracker](std::shared_ptr<capture> slot) {
+			std::shared_ptr<async_data> data = std::make_shared<async_data>();
+			data->source =
+				std::shared_ptr<obs_weak_source_t>(obs_source_get_weak_source(_self), obs::obs_weak_source_deleter);
+			data->tracker = tracker;
+			data->slot    = slot;
+			data->size    = _size;
+
+			slot->task = streamfx::threadpool()->push(
+				std::bind(&face_tracking_instance::async_track, this, std::placeholders::_1), data);
+		};
+		for (auto& slot : _captures) {
+			if (slot->retry.exchange(false))
+				dispatch(slot);
+		}
 
-		// Don't push additional tracking frames while processing one.
-		_ar_is_tracking = true;
+		// Resize the ring if the depth changed. Frames still in flight keep their slot alive until they are done.
+		if (_captures.size() != _tracker_depth) {
+			_captures.clear();
+			for (uint32_t idx = 0; idx < _tracker_depth; idx++) {
+				auto slot   = std::make_shared<capture>();
+				slot->busy  = false;
+				slot->retry = false;
+				_captures.push_back(slot);
+			}
+			_capture_index = 0;
+		}
 
-		// Spawn the work for the threadpool.
-		std::shared_ptr<async_data> data = std::make_shared<async_data>();
-		data->source =
-			std::shared_ptr<obs_weak_source_t>(obs_source_get_weak_source(_self), obs::obs_weak_source_deleter);
+		// Find the next free slot, or skip this frame if all of them are still being tracked.
+		std::shared_ptr<capture> slot;
+		for (std::size_t idx = 0; idx < _captures.size(); idx++) {
+			auto& candidate = _captures[(_capture_index + idx) % _captures.size()];
+			if (!candidate->busy) {
+				slot           = candidate;
+				_capture_index = (_capture_index + idx + 1) % _captures.size();
+				break;
+			}
+		}
+		if (!slot)
+			return;
 
-		// Check if things exist as planned.
-		if (!_ar_texture || (_ar_texture->get_width() != _size.first) || (_ar_texture->get_height() != _size.second)) {
 #ifdef ENABLE_PROFILING
-			auto             prof = _profile_capture_realloc->track();
-			gs::debug_marker marker{gs::debug_color_allocate, "Reallocate GPU Buffer"};
+		gs::debug_marker gdm{gs::debug_color_convert, "Start Asynchronous Tracking"};
 #endif
-			_ar_texture = std::make_shared<gs::texture>(_size.first, _size.second, GS_RGBA, uint32_t(1), nullptr,
-														gs::texture::flags::None);
-			_ar_texture_cuda_fresh = false;
-		}
 
-		{ // Copy texture
+		{ // Copy the frame into the slot and hand it to the tracker.
+#ifdef ENABLE_PROFILING
+			auto prof = _profile_track_capture->track();
+#endif
+			try {
+				if (!slot->texture || (slot->texture->get_width() != _size.first)
+					|| (slot->texture->get_height() != _size.second)) {
 #ifdef ENABLE_PROFILING
-			auto             prof = _profile_capture_copy->track();
-			gs::debug_marker marker{gs::debug_color_copy, "Copy Capture", obs_source_get_name(_self)};
+					gs::debug_marker marker{gs::debug_color_allocate, "Reallocate Capture"};
 #endif
-			gs_copy_texture(_ar_texture->get_object(), _rt->get_texture()->get_object());
+					slot->texture = std::make_shared<gs::texture>(_size.first, _size.second, GS_RGBA, uint32_t(1),
+																  nullptr, gs::texture::flags::None);
+				}
+				gs_copy_texture(slot->texture->get_object(), _rt->get_texture()->get_object());
+				slot->timestamp = obs_get_video_frame_time();
+
+				tracker->capture(slot->texture);
+			} catch (const std::exception& ex) {
+				DLOG_ERROR("<%s> Failed to capture frame for tracking: %s", obs_source_get_name(_self), ex.what());
+				return;
+			}
 		}
 
-		// Push work
-		_async_track = streamfx::threadpool()->push(
-			std::bind(&face_tracking_instance::async_track, this, std::placeholders::_1), data);
+		// Keep the slot until the tracker is done with it.
+		slot->busy = true;
+		dispatch(slot);
 	} else {
-		// Prevent conflicts.
-		std::unique_lock<std::mutex> alk{_ar_lock};
-		if (!_ar_loaded)
-			return;
-
 		// Try and acquire a strong source reference.
 		std::shared_ptr<async_data>   data = std::static_pointer_cast<async_data>(ptr);
 		std::shared_ptr<obs_source_t> remote_work =
@@ -262,171 +260,96 @@ void face_tracking_instance::async_track(std::shared_ptr<void> ptr)
 			return;
 		}
 
-		// Acquire GS context.
-		gs::context gctx{};
-
-		// Update the current CUDA context for working.
-		auto cctx = std::make_shared<::nvidia::cuda::context_stack>(_cuda, _cuda_ctx);
-
-		// Refresh any now broken buffers.
-		if (!_ar_texture_cuda_fresh) {
+		try {
+			std::vector<gfx::tracking::region> regions;
+			bool                               tracked;
+			{ // Track any faces.
 #ifdef ENABLE_PROFILING
-			auto             prof = _profile_ar_realloc->track();
-			gs::debug_marker marker{gs::debug_color_allocate, "%s: Reallocate CUDA Buffers",
-									obs_source_get_name(_self)};
+				auto prof = _profile_track_run->track();
 #endif
-			// Assign new texture and allocate new memory.
-			std::size_t pitch    = _ar_texture->get_width() * 4ul;
-			_ar_texture_cuda     = std::make_shared<::nvidia::cuda::gstexture>(_cuda, _ar_texture);
-			_ar_texture_cuda_mem = std::make_shared<::nvidia::cuda::memory>(_cuda, pitch * _ar_texture->get_height());
-			_ar_library->image_init(&_ar_image, static_cast<unsigned int>(_ar_texture->get_width()),
-									static_cast<unsigned int>(_ar_texture->get_height()), static_cast<int>(pitch),
-									reinterpret_cast<void*>(_ar_texture_cuda_mem->get()), NVCV_RGBA, NVCV_U8,
-									NVCV_INTERLEAVED, NVCV_CUDA);
-
-			// Reallocate transposed buffer.
-			_ar_library->image_dealloc(&_ar_image_temp);
-			_ar_library->image_dealloc(&_ar_image_bgr);
-			_ar_library->image_alloc(&_ar_image_bgr, _ar_image.width, _ar_image.height, NVCV_BGR, NVCV_U8,
-									 NVCV_INTERLEAVED, NVCV_CUDA, 0);
-
-			// Synchronize Streams.
-			_cuda->cuStreamSynchronize(_cuda_stream->get());
-
-			// Finally set the input object.
-			if (NvCV_Status res = _ar_library->set_object(_ar_feature.get(), NvAR_Parameter_Input(Image),
-														  &_ar_image_bgr, sizeof(NvCVImage));
-				res != NVCV_SUCCESS) {
-				DLOG_ERROR("<%s> Failed to update input image for tracking.", obs_source_get_name(_self));
-				return;
+				tracked = data->tracker->track(data->slot->texture, regions);
 			}
-
-			// And mark the new texture as fresh.
-			_ar_texture_cuda_fresh = true;
-		}
-
-		{ // Copy from CUDA array to CUDA device memory.
-#ifdef ENABLE_PROFILING
-			auto prof = _profile_ar_copy->track();
-#endif
-			::nvidia::cuda::memcpy2d_t mc;
-			mc.src_x_in_bytes  = 0;
-			mc.src_y           = 0;
-			mc.src_memory_type = ::nvidia::cuda::memory_type::ARRAY;
-			mc.src_host        = nullptr;
-			mc.src_device      = 0;
-			mc.src_array       = _ar_texture_cuda->map(_cuda_stream);
-			mc.src_pitch       = static_cast<size_t>(_ar_image.pitch);
-			mc.dst_x_in_bytes  = 0;
-			mc.dst_y           = 0;
-			mc.dst_memory_type = ::nvidia::cuda::memory_type::DEVICE;
-			mc.dst_host        = 0;
-			mc.dst_device      = reinterpret_cast<::nvidia::cuda::device_ptr_t>(_ar_image.pixels);
-			mc.dst_array       = 0;
-			mc.dst_pitch       = static_cast<size_t>(_ar_image.pitch);
-			mc.width_in_bytes  = static_cast<size_t>(_ar_image.pitch);
-			mc.height          = _ar_image.height;
-
-			if (::nvidia::cuda::result res = _cuda->cuMemcpy2DAsync(&mc, _cuda_stream->get());
-				res != ::nvidia::cuda::result::SUCCESS) {
-				DLOG_ERROR("<%s> Failed to prepare buffers for tracking.", obs_source_get_name(_self));
+			if (!tracked) { // Keep the slot, the graphics thread hands it back once the frame can be read.
+				data->slot->retry = true;
 				return;
 			}
-		}
 
-		{ // Convert from RGBA 32-bit to BGR 24-bit.
+			// Are we tracking anything, and confident enough in the tracking?
+			if (regions.empty() || (regions[0].confidence < 0.3333)) {
+				// If not, just return to full frame.
+				std::unique_lock<std::mutex> tlk{_values.lock};
+				if (data->slot->timestamp > _values.timestamp) {
+					_values.center[0]   = .5;
+					_values.center[1]   = .5;
+					_values.size[0]     = 1.;
+					_values.size[1]     = 1.;
+					_values.velocity[0] = 0;
+					_values.velocity[1] = 0;
+					_values.timestamp   = data->slot->timestamp;
+					_values.has_face    = false;
+				}
+			} else {
+				// If yes, begin tracking.
 #ifdef ENABLE_PROFILING
-			auto prof = _profile_ar_transfer->track();
+				auto prof = _profile_track_calc->track();
 #endif
-			if (NvCV_Status res =
-					_ar_library->image_transfer(&_ar_image, &_ar_image_bgr, 1.0,
-												reinterpret_cast<CUstream_st*>(_cuda_stream->get()), &_ar_image_temp);
-				res != NVCV_SUCCESS) {
-				DLOG_ERROR("<%s> Failed to convert from RGBX 32-bit to BGR 24-bit.", obs_source_get_name(_self));
-				return;
-			}
 
-			// Synchronize Streams.
-			_cuda->cuStreamSynchronize(_cuda_stream->get());
-			_cuda->cuCtxSynchronize();
-		}
-
-		{ // Track any faces.
-#ifdef ENABLE_PROFILING
-			auto prof = _profile_ar_run->track();
-#endif
-			if (NvCV_Status res = _ar_library->run(_ar_feature.get()); res != NVCV_SUCCESS) {
-				DLOG_ERROR("<%s> Failed to run tracking.", obs_source_get_name(_self));
-				return;
+				double_t sx     = static_cast<double_t>(data->size.first);
+				double_t sy     = static_cast<double_t>(data->size.second);
+				double_t aspect = double_t(sx) / double_t(sy);
+
+				// Store values and center.
+				double_t bw  = regions[0].width * sx;
+				double_t bh  = regions[0].height * sy;
+				double_t bsx = bw;
+				double_t bsy = bh;
+				double_t bcx = regions[0].x * sx + bsx / 2.0;
+				double_t bcy = regions[0].y * sy + bsy / 2.0;
+
+				// Zoom, Aspect Ratio, Offset
+				bsy = util::math::lerp<double_t>(sy, bsy, _cfg_zoom);
+				bsy = std::clamp(bsy, 10 * aspect, sy);
+				bsx = bsy * aspect;
+				bcx += bw * _cfg_offset.first;
+				bcy += bh * _cfg_offset.second;
+
+				// Fit back into the frame
+				// - Above code guarantees that height is never bigger than the height of the frame.
+				// - Which also guarantees that width is never bigger than the width of the frame.
+				// Only cx and cy need to be adjusted now to always be in the frame.
+				bcx = std::clamp(bcx, (bsx / 2.), sx - (bsx / 2.));
+				bcy = std::clamp(bcy, (bsy / 2.), sy - (bsy / 2.));
+
+				{ // Update target values, unless a result for a newer frame already arrived.
+					std::unique_lock<std::mutex> tlk{_values.lock};
+					if (data->slot->timestamp > _values.timestamp) {
+						double_t cx = bcx / sx;
+						double_t cy = bcy / sy;
+						if (_values.has_face) {
+							uint64_t delta      = data->slot->timestamp - _values.timestamp;
+							double_t dt         = static_cast<double_t>(delta) / 1e9;
+							_values.velocity[0] = (cx - _values.center[0]) / dt;
+							_values.velocity[1] = (cy - _values.center[1]) / dt;
+						} else {
+							_values.velocity[0] = 0;
+							_values.velocity[1] = 0;
+						}
+						_values.center[0] = cx;
+						_values.center[1] = cy;
+						_values.size[0]   = bsx / sx;
+						_values.size[1]   = bsy / sy;
+						_values.timestamp = data->slot->timestamp;
+						_values.has_face  = true;
+						_values.face      = regions[0];
+					}
+				}
 			}
+		} catch (const std::exception& ex) {
+			DLOG_ERROR("<%s> Failed to track frame: %s", obs_source_get_name(remote_work.get()), ex.what());
 		}
 
-		// Are we tracking anything, and confident enough in the tracking?
-		if ((_ar_bboxes.num_boxes == 0) || (_ar_bboxes_confidence.at(0) < 0.3333)) {
-			// If not, just return to full frame.
-			std::unique_lock<std::mutex> tlk{_values.lock};
-			_values.center[0]   = .5;
-			_values.center[1]   = .5;
-			_values.size[0]     = 1.;
-			_values.size[1]     = 1.;
-			_values.velocity[0] = 0;
-			_values.velocity[1] = 0;
-		} else {
-			// If yes, begin tracking.
-#ifdef ENABLE_PROFILING
-			auto prof = _profile_ar_calc->track();
-#endif
-
-			double_t sx     = static_cast<double_t>(_ar_image_bgr.width);
-			double_t sy     = static_cast<double_t>(_ar_image_bgr.height);
-			double_t aspect = double_t(sx) / double_t(sy);
-			double_t fps    = 0.;
-
-			{
-				obs_video_info ovi;
-				obs_get_video_info(&ovi);
-				fps = static_cast<double_t>(ovi.fps_num) / static_cast<double_t>(ovi.fps_den);
-			}
-
-			// Store values and center.
-			double_t bsx = _ar_bboxes.boxes[0].width;
-			double_t bsy = _ar_bboxes.boxes[0].height;
-			double_t bcx = _ar_bboxes.boxes[0].x + bsx / 2.0;
-			double_t bcy = _ar_bboxes.boxes[0].y + bsy / 2.0;
-
-			// Zoom, Aspect Ratio, Offset
-			bsy = util::math::lerp<double_t>(sy, bsy, _cfg_zoom);
-			bsy = std::clamp(bsy, 10 * aspect, static_cast<double_t>(_size.second));
-			bsx = bsy * aspect;
-			bcx += _ar_bboxes.boxes[0].width * _cfg_offset.first;
-			bcy += _ar_bboxes.boxes[0].height * _cfg_offset.second;
-
-			// Fit back into the frame
-			// - Above code guarantees that height is never bigger than the height of the frame.
-			// - Which also guarantees that width is never bigger than the width of the frame.
-			// Only cx and cy need to be adjusted now to always be in the frame.
-			bcx = std::clamp(bcx, (bsx / 2.), sx - (bsx / 2.));
-			bcy = std::clamp(bcy, (bsy / 2.), sy - (bsy / 2.));
-
-			{ // Update target values.
-				std::unique_lock<std::mutex> tlk{_values.lock};
-				_values.velocity[0] = -_values.center[0];
-				_values.velocity[1] = -_values.center[1];
-				_values.center[0]   = bcx / sx;
-				_values.center[1]   = bcy / sy;
-				_values.velocity[0] += _values.center[0];
-				_values.velocity[1] += _values.center[1];
-				_values.velocity[0] *= fps;
-				_values.velocity[1] *= fps;
-				_values.size[0] = bsx / sx;
-				_values.size[1] = bsy / sy;
-			}
-		}
-
-		_async_track.reset();
-
-		// Allow new frames to be queued again.
-		_ar_is_tracking = false;
+		// Allow the slot to be reused.
+		data->slot->busy = false;
 	}
 }
 
@@ -482,16 +405,29 @@ void face_tracking_instance::update(obs_data_t* data)
 	_cfg_offset.first  = obs_data_get_double(data, SK_ROI_OFFSET_X) / 100.0;
 	_cfg_offset.second = obs_data_get_double(data, SK_ROI_OFFSET_Y) / 100.0;
 	_cfg_stability     = obs_data_get_double(data, SK_ROI_STABILITY) / 100.0;
+	_tracker_depth     = static_cast<uint32_t>(std::clamp<int64_t>(obs_data_get_int(data, SK_TRACKER_DEPTH), 1, 4));
 
 	// Refresh the Region Of Interest
 	refresh_region_of_interest();
+
+	{ // Recreate the tracker only if the backend or its input changed.
+		tracker_backend backend = static_cast<tracker_backend>(obs_data_get_int(data, SK_TRACKER_BACKEND));
+		std::string     file    = obs_data_get_string(data, SK_TRACKER_FILE);
+		if ((backend != _tracker_backend) || ((backend == tracker_backend::Replay) && (file != _tracker_file))) {
+			_tracker_backend = backend;
+			_tracker_file    = file;
+			async_initialize();
+		}
+	}
 }
 
 void face_tracking_instance::video_tick(float_t seconds)
 {
 	// If we aren't yet ready to do work, abort for now.
-	if (!_ar_loaded) {
-		return;
+	{
+		std::unique_lock<std::mutex> lk{_tracker_lock};
+		if (!_tracker)
+			return;
 	}
 
 	// Update the input size.
@@ -503,12 +439,19 @@ void face_tracking_instance::video_tick(float_t seconds)
 	// Update filters and geometry
 	{
 		std::unique_lock<std::mutex> tlk(_values.lock);
-		_filters.center[0].filter(_values.center[0]);
-		_filters.center[1].filter(_values.center[1]);
-		_filters.size[0].filter(_values.size[0]);
-		_filters.size[1].filter(_values.size[1]);
-		_values.center[0] += _values.velocity[0] * seconds;
-		_values.center[1] += _values.velocity[1] * seconds;
+
+		// Tracking results describe a frame from a while ago, so predict where the face is in the frame that is about
+		// to be rendered instead of chasing where it was.
+		double_t ahead = 0.;
+		if (uint64_t now = obs_get_video_frame_time(); _values.timestamp && (now > _values.timestamp)) {
+			ahead = std::min(static_cast<double_t>(now - _values.timestamp) / 1e9, PREDICTION_LIMIT);
+		}
+		for (std::size_t idx = 0; idx < 2; idx++) {
+			double_t half   = _values.size[idx] / 2.;
+			double_t center = std::clamp(_values.center[idx] + _values.velocity[idx] * ahead, half, 1. - half);
+			_filters.center[idx].filter(center);
+			_filters.size[idx].filter(_values.size[idx]);
+		}
 	}
 	refresh_geometry();
 
@@ -520,14 +463,20 @@ void face_tracking_instance::video_render(gs_effect_t* effect)
 	obs_source_t* filter_parent  = obs_filter_get_parent(_self);
 	obs_source_t* filter_target  = obs_filter_get_target(_self);
 	gs_effect_t*  default_effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+	bool          has_tracker    = false;
 
-	if (!filter_parent || !filter_target || !_size.first || !_size.second || !_ar_loaded) {
+	{
+		std::unique_lock<std::mutex> lk{_tracker_lock};
+		has_tracker = (_tracker != nullptr);
+	}
+
+	if (!filter_parent || !filter_target || !_size.first || !_size.second || !has_tracker) {
 		obs_source_skip_video_filter(_self);
 		return;
 	}
 
 #ifdef ENABLE_PROFILING
-	gs::debug_marker gdmp{gs::debug_color_source, "NVIDIA Face Tracking '%s'...", obs_source_get_name(_self)};
+	gs::debug_marker gdmp{gs::debug_color_source, "Face Tracking '%s'...", obs_source_get_name(_self)};
 	gs::debug_marker gdmp2{gs::debug_color_source, "... on '%s'", obs_source_get_name(obs_filter_get_parent(_self))};
 #endif
 
@@ -576,6 +525,38 @@ void face_tracking_instance::video_render(gs_effect_t* effect)
 		}
 		gs_load_vertexbuffer(nullptr);
 	}
+
+	// Publish where the face ends up in our output, so that encoders can spend more bits on it.
+	if (auto channel = obs::roi_channel::get(); channel) {
+		std::vector<obs::roi_channel::region> regions;
+		gfx::tracking::region                 face;
+		bool                                  has_face;
+		{
+			std::unique_lock<std::mutex> tlk{_values.lock};
+			has_face = _values.has_face;
+			face     = _values.face;
+		}
+
+		if (has_face) {
+			double_t sx = _filters.size[0].get();
+			double_t sy = _filters.size[1].get();
+			double_t x0 = std::clamp((face.x - (_filters.center[0].get() - sx / 2.)) / sx, 0., 1.);
+			double_t y0 = std::clamp((face.y - (_filters.center[1].get() - sy / 2.)) / sy, 0., 1.);
+			double_t x1 = std::clamp((face.x + face.width - (_filters.center[0].get() - sx / 2.)) / sx, 0., 1.);
+			double_t y1 = std::clamp((face.y + face.height - (_filters.center[1].get() - sy / 2.)) / sy, 0., 1.);
+			if ((x1 > x0) && (y1 > y0)) {
+				obs::roi_channel::region region;
+				region.x      = static_cast<float_t>(x0);
+				region.y      = static_cast<float_t>(y0);
+				region.width  = static_cast<float_t>(x1 - x0);
+				region.height = static_cast<float_t>(y1 - y0);
+				region.weight = std::clamp(face.confidence, 0.f, 1.f);
+				regions.push_back(region);
+			}
+		}
+
+		channel->publish(filter_parent, obs_get_video_frame_time(), regions);
+	}
 }
 
 #ifdef ENABLE_PROFILING
@@ -584,10 +565,10 @@ bool face_tracking_instance::button_profile(obs_properties_t* props, obs_propert
 	DLOG_INFO("%-22s: %-10s %-10s %-10s %-10s %-10s", "Task", "Total", "Count", "Average", "99.9%ile", "95.0%ile");
 
 	std::pair<std::string, std::shared_ptr<util::profiler>> profilers[]{
-		{"Capture", _profile_capture},   {"Reallocate", _profile_capture_realloc},
-		{"Copy", _profile_capture_copy}, {"AR Reallocate", _profile_ar_realloc},
-		{"AR Copy", _profile_ar_copy},   {"AR Convert", _profile_ar_transfer},
-		{"AR Run", _profile_ar_run},     {"AR Calculate", _profile_ar_calc},
+		{"Capture", _profile_capture},
+		{"Tracker Capture", _profile_track_capture},
+		{"Tracker Run", _profile_track_run},
+		{"Calculate", _profile_track_calc},
 	};
 	for (auto& kv : profilers) {
 		DLOG_INFO("  %-20s: %8lldµs %10lld %8lldµs %8lldµs %8lldµs", kv.first.c_str(),
@@ -603,14 +584,12 @@ bool face_tracking_instance::button_profile(obs_properties_t* props, obs_propert
 
 face_tracking_factory::face_tracking_factory()
 {
-	// Try and load CUDA.
-	_cuda = ::nvidia::cuda::cuda::get();
-
-	// Try and load AR.
-	_ar = std::make_shared<::nvidia::ar::ar>();
+#ifdef ENABLE_FILTER_NVIDIA_FACE_TRACKING_NVAR
+	// Try and load CUDA and AR, without them only the other backends are available.
+	try {
+		_cuda = ::nvidia::cuda::cuda::get();
+		_ar   = std::make_shared<::nvidia::ar::ar>();
 
-	// Initialize CUDA
-	{
 		auto gctx = gs::context{};
 #ifdef WIN32
 		if (gs_get_device_type() == GS_DEVICE_DIRECT3D_11) {
@@ -618,10 +597,16 @@ face_tracking_factory::face_tracking_factory()
 				std::make_shared<::nvidia::cuda::context>(_cuda, reinterpret_cast<ID3D11Device*>(gs_get_device_obj()));
 		}
 #endif
-		if (gs_get_device_type() == GS_DEVICE_OPENGL) {
-			throw std::runtime_error("OpenGL not supported.");
+		if (!_cuda_ctx) {
+			throw std::runtime_error("Only Direct3D 11 is supported.");
 		}
+	} catch (const std::exception& ex) {
+		DLOG_WARNING("<Face Tracking Filter> NVIDIA backend is unavailable: %s", ex.what());
+		_cuda_ctx.reset();
+		_ar.reset();
+		_cuda.reset();
 	}
+#endif
 
 	// Info
 	_info.id           = PREFIX "filter-nvidia-face-tracking";
@@ -642,6 +627,11 @@ const char* face_tracking_factory::get_name()
 
 void face_tracking_factory::get_defaults2(obs_data_t* data)
 {
+	tracker_backend backend =
+		is_backend_available(tracker_backend::NVIDIA) ? tracker_backend::NVIDIA : tracker_backend::CPU;
+	obs_data_set_default_int(data, SK_TRACKER_BACKEND, static_cast<int64_t>(backend));
+	obs_data_set_default_string(data, SK_TRACKER_FILE, "");
+	obs_data_set_default_int(data, SK_TRACKER_DEPTH, 2);
 	obs_data_set_default_double(data, SK_ROI_ZOOM, 50.0);
 	obs_data_set_default_double(data, SK_ROI_OFFSET_X, 0.0);
 	obs_data_set_default_double(data, SK_ROI_OFFSET_Y, -15.0);
@@ -652,6 +642,35 @@ obs_properties_t* face_tracking_factory::get_properties2(face_tracking_instance*
 {
 	obs_properties_t* pr = obs_properties_create();
 
+	{
+		auto grp = obs_properties_create();
+		obs_properties_add_group(pr, ST_TRACKER, D_TRANSLATE(ST_TRACKER), OBS_GROUP_NORMAL, grp);
+		{
+			auto p = obs_properties_add_list(grp, SK_TRACKER_BACKEND, D_TRANSLATE(ST_TRACKER_BACKEND),
+											 OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+			obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_TRACKER_BACKEND)));
+			std::pair<const char*, tracker_backend> els[] = {
+				{ST_TRACKER_BACKEND_NVIDIA, tracker_backend::NVIDIA},
+				{ST_TRACKER_BACKEND_CPU, tracker_backend::CPU},
+				{ST_TRACKER_BACKEND_REPLAY, tracker_backend::Replay},
+			};
+			for (auto kv : els) {
+				if (is_backend_available(kv.second)) {
+					obs_property_list_add_int(p, D_TRANSLATE(kv.first), static_cast<int64_t>(kv.second));
+				}
+			}
+		}
+		{
+			auto p = obs_properties_add_path(grp, SK_TRACKER_FILE, D_TRANSLATE(ST_TRACKER_FILE), OBS_PATH_FILE,
+											 S_FILEFILTERS_TEXT, nullptr);
+			obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_TRACKER_FILE)));
+		}
+		{
+			auto p = obs_properties_add_int_slider(grp, SK_TRACKER_DEPTH, D_TRANSLATE(ST_TRACKER_DEPTH), 1, 4, 1);
+			obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_TRACKER_DEPTH)));
+		}
+	}
+
 	{
 		auto grp = obs_properties_create();
 		obs_properties_add_group(pr, ST_ROI, D_TRANSLATE(ST_ROI), OBS_GROUP_NORMAL, grp);
@@ -698,19 +717,41 @@ obs_properties_t* face_tracking_factory::get_properties2(face_tracking_instance*
 	return pr;
 }
 
-std::shared_ptr<::nvidia::cuda::cuda> face_tracking_factory::get_cuda()
+bool face_tracking_factory::is_backend_available(tracker_backend backend)
 {
-	return _cuda;
+	switch (backend) {
+	case tracker_backend::NVIDIA:
+#ifdef ENABLE_FILTER_NVIDIA_FACE_TRACKING_NVAR
+		return _cuda_ctx != nullptr;
+#else
+		return false;
+#endif
+	case tracker_backend::CPU:
+	case tracker_backend::Replay:
+		return true;
+	default:
+		return false;
+	}
 }
 
-std::shared_ptr<::nvidia::cuda::context> face_tracking_factory::get_cuda_context()
+std::shared_ptr<gfx::tracking::backend> face_tracking_factory::create_backend(tracker_backend    backend,
+																			  const std::string& file)
 {
-	return _cuda_ctx;
-}
+	if (!is_backend_available(backend))
+		throw std::runtime_error("Tracker backend is not available.");
 
-std::shared_ptr<::nvidia::ar::ar> face_tracking_factory::get_ar()
-{
-	return _ar;
+	switch (backend) {
+#ifdef ENABLE_FILTER_NVIDIA_FACE_TRACKING_NVAR
+	case tracker_backend::NVIDIA:
+		return std::make_shared<gfx::tracking::nvidia>(_cuda, _cuda_ctx, _ar);
+#endif
+	case tracker_backend::CPU:
+		return std::make_shared<gfx::tracking::cpu>();
+	case tracker_backend::Replay:
+		return std::make_shared<gfx::tracking::replay>(std::filesystem::u8path(file));
+	default:
+		throw std::runtime_error("Tracker backend is not available.");
+	}
 }
 
 std::shared_ptr<face_tracking_factory> _filter_nvidia_face_tracking_factory_instance = nullptr;
@@ -720,7 +761,7 @@ void streamfx::filter::nvidia::face_tracking_factory::initialize()
 	try {
 		_filter_nvidia_face_tracking_factory_instance = std::make_shared<filter::nvidia::face_tracking_factory>();
 	} catch (const std::exception& ex) {
-		DLOG_ERROR("<NVIDIA Face Tracking Filter> %s", ex.what());
+		DLOG_ERROR("<Face Tracking Filter> %s", ex.what());
 	}
 }
 
@@ -21,20 +21,27 @@
 #include "common.hpp"
 #include <atomic>
 #include <vector>
+#include "gfx/tracking/gfx-tracking.hpp"
 #include "obs/gs/gs-effect.hpp"
 #include "obs/gs/gs-rendertarget.hpp"
 #include "obs/gs/gs-vertexbuffer.hpp"
 #include "obs/obs-source-factory.hpp"
 
 // Nvidia
+#ifdef ENABLE_FILTER_NVIDIA_FACE_TRACKING_NVAR
 #include "nvidia/ar/nvidia-ar.hpp"
 #include "nvidia/cuda/nvidia-cuda-context.hpp"
-#include "nvidia/cuda/nvidia-cuda-gs-texture.hpp"
-#include "nvidia/cuda/nvidia-cuda-memory.hpp"
-#include "nvidia/cuda/nvidia-cuda-stream.hpp"
 #include "nvidia/cuda/nvidia-cuda.hpp"
+#endif
 
 namespace streamfx::filter::nvidia {
+	enum class tracker_backend : int64_t {
+		Invalid = -1,
+		NVIDIA  = 0,
+		CPU     = 1,
+		Replay  = 2,
+	};
+
 	class face_tracking_instance : public obs::source_instance {
 		// Filter Cache
 		std::pair<uint32_t, uint32_t>     _size;
@@ -55,48 +62,43 @@ namespace streamfx::filter::nvidia {
 			util::math::kalman1D<double_t> size[2];
 		} _filters;
 		struct {
-			std::mutex lock;
-			double_t   center[2];
-			double_t   size[2];
-			double_t   velocity[2];
+			std::mutex            lock;
+			double_t              center[2];
+			double_t              size[2];
+			double_t              velocity[2];
+			uint64_t              timestamp;
+			bool                  has_face;
+			gfx::tracking::region face;
 		} _values;
 
-		// Nvidia CUDA interop
-		std::shared_ptr<::nvidia::cuda::cuda>    _cuda;
-		std::shared_ptr<::nvidia::cuda::context> _cuda_ctx;
-		std::shared_ptr<::nvidia::cuda::stream>  _cuda_stream;
-
-		// Nvidia AR interop
-		std::shared_ptr<::nvidia::ar::ar>          _ar_library;
-		std::atomic_bool                           _ar_loaded;
-		std::shared_ptr<nvAR_Feature>              _ar_feature;
-		std::atomic_bool                           _ar_is_tracking;
-		std::mutex                                 _ar_lock;
-		std::vector<float_t>                       _ar_bboxes_confidence;
-		std::vector<NvAR_Rect>                     _ar_bboxes_data;
-		NvAR_BBoxes                                _ar_bboxes;
-		std::shared_ptr<gs::texture>               _ar_texture;
-		bool                                       _ar_texture_cuda_fresh;
-		std::shared_ptr<::nvidia::cuda::gstexture> _ar_texture_cuda;
-		std::shared_ptr<::nvidia::cuda::memory>    _ar_texture_cuda_mem;
-		NvCVImage                                  _ar_image;
-		NvCVImage                                  _ar_image_bgr;
-		NvCVImage                                  _ar_image_temp;
+		// Tracking
+		tracker_backend                         _tracker_backend;
+		std::string                             _tracker_file;
+		std::mutex                              _tracker_lock;
+		std::shared_ptr<gfx::tracking::backend> _tracker;
+		std::atomic<uint64_t>                   _tracker_generation;
+		uint32_t                                _tracker_depth;
+
+		// Frames in flight, each held until the tracker is done with it.
+		struct capture {
+			std::shared_ptr<gs::texture>              texture;
+			uint64_t                                  timestamp;
+			std::atomic_bool                          busy;
+			std::atomic_bool                          retry; // The tracker could not read the frame yet.
+			std::shared_ptr<::util::threadpool::task> task;
+		};
+		std::vector<std::shared_ptr<capture>> _captures;
+		std::size_t                           _capture_index;
 
 		// Tasks
 		std::shared_ptr<::util::threadpool::task> _async_initialize;
-		std::shared_ptr<::util::threadpool::task> _async_track;
 
 #ifdef ENABLE_PROFILING
 		// Profiling
 		std::shared_ptr<util::profiler> _profile_capture;
-		std::shared_ptr<util::profiler> _profile_capture_realloc;
-		std::shared_ptr<util::profiler> _profile_capture_copy;
-		std::shared_ptr<util::profiler> _profile_ar_realloc;
-		std::shared_ptr<util::profiler> _profile_ar_copy;
-		std::shared_ptr<util::profiler> _profile_ar_transfer;
-		std::shared_ptr<util::profiler> _profile_ar_run;
-		std::shared_ptr<util::profiler> _profile_ar_calc;
+		std::shared_ptr<util::profiler> _profile_track_capture;
+		std::shared_ptr<util::profiler> _profile_track_run;
+		std::shared_ptr<util::profiler> _profile_track_calc;
 #endif
 
 		public:
@@ -129,9 +131,11 @@ namespace streamfx::filter::nvidia {
 
 	class face_tracking_factory
 		: public obs::source_factory<filter::nvidia::face_tracking_factory, filter::nvidia::face_tracking_instance> {
+#ifdef ENABLE_FILTER_NVIDIA_FACE_TRACKING_NVAR
 		std::shared_ptr<::nvidia::cuda::cuda>    _cuda;
 		std::shared_ptr<::nvidia::cuda::context> _cuda_ctx;
 		std::shared_ptr<::nvidia::ar::ar>        _ar;
+#endif
 
 		public:
 		face_tracking_factory();
@@ -143,11 +147,9 @@ namespace streamfx::filter::nvidia {
 
 		virtual obs_properties_t* get_properties2(filter::nvidia::face_tracking_instance* data) override;
 
-		std::shared_ptr<::nvidia::cuda::cuda> get_cuda();
-
-		std::shared_ptr<::nvidia::cuda::context> get_cuda_context();
+		bool is_backend_available(tracker_backend backend);
 
-		std::shared_ptr<::nvidia::ar::ar> get_ar();
+		std::shared_ptr<gfx::tracking::backend> create_backend(tracker_backend backend, const std::string& file);
 
 		public: // Singleton
 		static void initialize();
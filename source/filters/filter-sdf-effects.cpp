@@ -19,6 +19,7 @@
 
 #include "filter-sdf-effects.hpp"
 #include "strings.hpp"
+#include <chrono>
 #include <stdexcept>
 #include "obs/gs/gs-helper.hpp"
 
@@ -107,6 +108,9 @@ sdf_effects_instance::sdf_effects_instance(obs_data_t* settings, obs_source_t* s
 		}
 	}
 
+	if (auto governor = ::gfx::resolution_governor::get(); governor)
+		_resolution = governor->register_client(obs_source_get_name(_self));
+
 	update(settings);
 }
 
@@ -252,6 +256,9 @@ void sdf_effects_instance::update(obs_data_t* data)
 
 	_sdf_scale     = double_t(obs_data_get_double(data, ST_SDF_SCALE) / 100.0);
 	_sdf_threshold = float_t(obs_data_get_double(data, ST_SDF_THRESHOLD) / 100.0);
+
+	if (_resolution)
+		_resolution->update(data);
 }
 
 void sdf_effects_instance::video_tick(float_t)
@@ -300,6 +307,8 @@ void sdf_effects_instance::video_render(gs_effect_t* effect)
 		gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
 
 		if (!_source_rendered) {
+			auto begin = std::chrono::high_resolution_clock::now();
+
 			// Store input texture.
 			{
 #ifdef ENABLE_PROFILING
@@ -332,10 +341,11 @@ void sdf_effects_instance::video_render(gs_effect_t* effect)
 					throw std::runtime_error("SDF Effect no loaded");
 				}
 
-				// Scale SDF Size
+				// Scale SDF Size, further reduced by the resolution governor if necessary.
+				double_t scale = _sdf_scale * (_resolution ? _resolution->scale() : 1.0);
 				double_t sdfW, sdfH;
-				sdfW = baseW * _sdf_scale;
-				sdfH = baseH * _sdf_scale;
+				sdfW = baseW * scale;
+				sdfH = baseH * scale;
 				if (sdfW <= 1) {
 					sdfW = 1.0;
 				}
@@ -368,6 +378,9 @@ void sdf_effects_instance::video_render(gs_effect_t* effect)
 				}
 			}
 
+			if (_resolution)
+				_resolution->track(std::chrono::high_resolution_clock::now() - begin);
+
 			_source_rendered = true;
 		}
 
@@ -571,6 +584,7 @@ void sdf_effects_factory::get_defaults2(obs_data_t* data)
 	obs_data_set_default_bool(data, S_ADVANCED, false);
 	obs_data_set_default_double(data, ST_SDF_SCALE, 100.0);
 	obs_data_set_default_double(data, ST_SDF_THRESHOLD, 50.0);
+	::gfx::resolution_governor::defaults(data);
 }
 
 bool cb_modified_shadow_inside(void*, obs_properties_t* props, obs_property*, obs_data_t* settings) noexcept
@@ -663,6 +677,7 @@ try {
 	bool show_advanced = obs_data_get_bool(settings, S_ADVANCED);
 	obs_property_set_visible(obs_properties_get(props, ST_SDF_SCALE), show_advanced);
 	obs_property_set_visible(obs_properties_get(props, ST_SDF_THRESHOLD), show_advanced);
+	obs_property_set_visible(obs_properties_get(props, S_DYNAMICRESOLUTION), show_advanced);
 	return true;
 } catch (const std::exception& ex) {
 	DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
@@ -794,6 +809,8 @@ obs_properties_t* sdf_effects_factory::get_properties2(sdf_effects_instance* dat
 
 		p = obs_properties_add_float_slider(props, ST_SDF_THRESHOLD, D_TRANSLATE(ST_SDF_THRESHOLD), 0.0, 100.0, 0.01);
 		obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_SDF_THRESHOLD)));
+
+		::gfx::resolution_governor::properties(props);
 	}
 
 	return props;
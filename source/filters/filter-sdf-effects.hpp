@@ -19,6 +19,7 @@
 
 #pragma once
 #include "common.hpp"
+#include "gfx/gfx-resolution-governor.hpp"
 #include "obs/gs/gs-effect.hpp"
 #include "obs/gs/gs-rendertarget.hpp"
 #include "obs/gs/gs-sampler.hpp"
@@ -43,6 +44,9 @@ namespace streamfx::filter::sdf_effects {
 		double_t                          _sdf_scale;
 		float_t                           _sdf_threshold;
 
+		// Dynamic Resolution
+		std::shared_ptr<::gfx::resolution_governor::client> _resolution;
+
 		// Effects
 		bool                              _output_rendered;
 		std::shared_ptr<gs::texture>      _output_texture;
@@ -270,6 +270,32 @@ void transform_instance::video_tick(float_t)
 	_source_rendered = false;
 }
 
+void transform_instance::mesh_matrix(matrix4& matrix, uint32_t width, uint32_t height)
+{
+	// The mesh is an affine function of its UVs, so three of its corners describe it completely.
+	vec3* v0 = _vertex_buffer->at(0).position;
+	vec3* v1 = _vertex_buffer->at(1).position;
+	vec3* v2 = _vertex_buffer->at(2).position;
+
+	float_t iw = 1.f / static_cast<float_t>(width);
+	float_t ih = 1.f / static_cast<float_t>(height);
+	vec4_set(&matrix.x, (v1->x - v0->x) * iw, (v1->y - v0->y) * iw, (v1->z - v0->z) * iw, 0.f);
+	vec4_set(&matrix.y, (v2->x - v0->x) * ih, (v2->y - v0->y) * ih, (v2->z - v0->z) * ih, 0.f);
+	vec4_set(&matrix.z, 0.f, 0.f, 0.f, 0.f);
+	vec4_set(&matrix.t, v0->x, v0->y, v0->z, 1.f);
+}
+
+bool transform_instance::mesh_inside()
+{
+	for (uint32_t idx = 0; idx < 4; idx++) {
+		vec3* v = _vertex_buffer->at(idx).position;
+		if ((std::fabs(v->x) > 1.f) || (std::fabs(v->y) > 1.f)) {
+			return false;
+		}
+	}
+	return true;
+}
+
 void transform_instance::video_render(gs_effect_t* effect)
 {
 	obs_source_t* parent         = obs_filter_get_parent(_self);
@@ -290,6 +316,40 @@ void transform_instance::video_render(gs_effect_t* effect)
 						  obs_source_get_name(obs_filter_get_parent(_self))};
 #endif
 
+	// Without mipmapping the source is never needed as a texture, so draw it through the mesh directly.
+	matrix4 mesh;
+	if (!_mipmap_enabled) {
+		mesh_matrix(mesh, base_width, base_height);
+
+		// If the mesh stays within the bounds of the filter, there is nothing to clip and no intermediate is needed.
+		if (_camera_orthographic && mesh_inside()) {
+#ifdef ENABLE_PROFILING
+			gs::debug_marker gdm{gs::debug_color_render, "Render (Direct)"};
+#endif
+
+			// Map the orthographic view onto the output, and flatten it as depth has no meaning here.
+			matrix4 view;
+			vec4_set(&view.x, base_width / 2.f, 0.f, 0.f, 0.f);
+			vec4_set(&view.y, 0.f, base_height / 2.f, 0.f, 0.f);
+			vec4_set(&view.z, 0.f, 0.f, 0.f, 0.f);
+			vec4_set(&view.t, base_width / 2.f, base_height / 2.f, 0.f, 1.f);
+			matrix4_mul(&mesh, &mesh, &view);
+
+			gs_cull_mode cull_mode = gs_get_cull_mode();
+			gs_set_cull_mode(GS_NEITHER);
+			gs_matrix_push();
+			gs_matrix_mul(&mesh);
+			if (obs_source_process_filter_begin(_self, GS_RGBA, OBS_ALLOW_DIRECT_RENDERING)) {
+				obs_source_process_filter_end(_self, effect, base_width, base_height);
+			} else {
+				obs_source_skip_video_filter(_self);
+			}
+			gs_matrix_pop();
+			gs_set_cull_mode(cull_mode);
+			return;
+		}
+	}
+
 	uint32_t cache_width  = base_width;
 	uint32_t cache_height = base_height;
 
@@ -309,49 +369,47 @@ void transform_instance::video_render(gs_effect_t* effect)
 				uint32_t(pow(2, util::math::get_power_of_two_exponent_ceil(uint64_t(cache_height * aspect)))), 1u,
 				16384u);
 		}
-	}
 
-	if (!_cache_rendered) {
+		if (!_cache_rendered) {
 #ifdef ENABLE_PROFILING
-		gs::debug_marker gdm{gs::debug_color_cache, "Cache"};
+			gs::debug_marker gdm{gs::debug_color_cache, "Cache"};
 #endif
 
-		auto op = _cache_rt->render(cache_width, cache_height);
+			auto op = _cache_rt->render(cache_width, cache_height);
 
-		gs_ortho(0, static_cast<float_t>(base_width), 0, static_cast<float_t>(base_height), -1, 1);
+			gs_ortho(0, static_cast<float_t>(base_width), 0, static_cast<float_t>(base_height), -1, 1);
 
-		vec4 clear_color = {0, 0, 0, 0};
-		gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &clear_color, 0, 0);
+			vec4 clear_color = {0, 0, 0, 0};
+			gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &clear_color, 0, 0);
 
-		/// Render original source
-		if (obs_source_process_filter_begin(_self, GS_RGBA, OBS_NO_DIRECT_RENDERING)) {
-			gs_blend_state_push();
-			gs_reset_blend_state();
-			gs_enable_blending(false);
-			gs_blend_function_separate(GS_BLEND_ONE, GS_BLEND_ZERO, GS_BLEND_SRCALPHA, GS_BLEND_ZERO);
-			gs_enable_depth_test(false);
-			gs_enable_stencil_test(false);
-			gs_enable_stencil_write(false);
-			gs_enable_color(true, true, true, true);
-			gs_set_cull_mode(GS_NEITHER);
+			/// Render original source
+			if (obs_source_process_filter_begin(_self, GS_RGBA, OBS_NO_DIRECT_RENDERING)) {
+				gs_blend_state_push();
+				gs_reset_blend_state();
+				gs_enable_blending(false);
+				gs_blend_function_separate(GS_BLEND_ONE, GS_BLEND_ZERO, GS_BLEND_SRCALPHA, GS_BLEND_ZERO);
+				gs_enable_depth_test(false);
+				gs_enable_stencil_test(false);
+				gs_enable_stencil_write(false);
+				gs_enable_color(true, true, true, true);
+				gs_set_cull_mode(GS_NEITHER);
 
-			obs_source_process_filter_end(_self, default_effect, base_width, base_height);
+				obs_source_process_filter_end(_self, default_effect, base_width, base_height);
 
-			gs_blend_state_pop();
-		} else {
+				gs_blend_state_pop();
+			} else {
+				obs_source_skip_video_filter(_self);
+				return;
+			}
+
+			_cache_rendered = true;
+		}
+		_cache_rt->get_texture(_cache_texture);
+		if (!_cache_texture) {
 			obs_source_skip_video_filter(_self);
 			return;
 		}
 
-		_cache_rendered = true;
-	}
-	_cache_rt->get_texture(_cache_texture);
-	if (!_cache_texture) {
-		obs_source_skip_video_filter(_self);
-		return;
-	}
-
-	if (_mipmap_enabled) {
 #ifdef ENABLE_PROFILING
 		gs::debug_marker gdm{gs::debug_color_convert, "Mipmap"};
 #endif
@@ -377,7 +435,7 @@ void transform_instance::video_render(gs_effect_t* effect)
 		}
 	}
 
-	{
+	if (!_source_rendered) {
 #ifdef ENABLE_PROFILING
 		gs::debug_marker gdm{gs::debug_color_convert, "Transform"};
 #endif
@@ -406,18 +464,26 @@ void transform_instance::video_render(gs_effect_t* effect)
 		vec4 clear_color = {0, 0, 0, 0};
 		gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &clear_color, 0, 0);
 
-		gs_load_vertexbuffer(_vertex_buffer->update(false));
-		gs_load_indexbuffer(nullptr);
-		gs_effect_set_texture(gs_effect_get_param_by_name(default_effect, "image"),
-							  _mipmap_enabled
-								  ? (_mipmap_texture ? _mipmap_texture->get_object() : _cache_texture->get_object())
-								  : _cache_texture->get_object());
-		while (gs_effect_loop(default_effect, "Draw")) {
-			gs_draw(GS_TRISTRIP, 0, 4);
+		if (_mipmap_enabled) {
+			gs_load_vertexbuffer(_vertex_buffer->update(false));
+			gs_load_indexbuffer(nullptr);
+			gs_effect_set_texture(gs_effect_get_param_by_name(default_effect, "image"),
+								  _mipmap_texture ? _mipmap_texture->get_object() : _cache_texture->get_object());
+			while (gs_effect_loop(default_effect, "Draw")) {
+				gs_draw(GS_TRISTRIP, 0, 4);
+			}
+			gs_load_vertexbuffer(nullptr);
+		} else {
+			// Draw the parent straight through the mesh instead of going through the cache.
+			gs_matrix_mul(&mesh);
+			if (obs_source_process_filter_begin(_self, GS_RGBA, OBS_ALLOW_DIRECT_RENDERING)) {
+				obs_source_process_filter_end(_self, default_effect, base_width, base_height);
+			}
 		}
-		gs_load_vertexbuffer(nullptr);
 
 		gs_blend_state_pop();
+
+		_source_rendered = true;
 	}
 	_source_rt->get_texture(_source_texture);
 	if (!_source_texture) {
@@ -68,6 +68,13 @@ namespace streamfx::filter::transform {
 
 		virtual void video_tick(float_t) override;
 		virtual void video_render(gs_effect_t*) override;
+
+		private:
+		/** Matrix that maps source pixels onto the mesh, used to draw the source without a cache. */
+		void mesh_matrix(matrix4& matrix, uint32_t width, uint32_t height);
+
+		/** Whether the mesh lies entirely within the orthographic view. */
+		bool mesh_inside();
 	};
 
 	class transform_factory
@@ -16,8 +16,59 @@
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
 
 #include "gfx-blur-base.hpp"
+#include <algorithm>
+#include <cmath>
 #include <stdexcept>
 
+void gfx::blur::base::set_region(uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+{
+	_region.x  = static_cast<int>(x);
+	_region.y  = static_cast<int>(y);
+	_region.cx = static_cast<int>(width);
+	_region.cy = static_cast<int>(height);
+}
+
+void gfx::blur::base::get_region(uint32_t& x, uint32_t& y, uint32_t& width, uint32_t& height)
+{
+	x      = static_cast<uint32_t>(_region.x);
+	y      = static_cast<uint32_t>(_region.y);
+	width  = static_cast<uint32_t>(_region.cx);
+	height = static_cast<uint32_t>(_region.cy);
+}
+
+void gfx::blur::base::begin_region(uint32_t width, uint32_t height, double_t scale, double_t margin)
+{
+	if ((_region.cx <= 0) || (_region.cy <= 0)) {
+		_region_active = false;
+		return;
+	}
+
+	double_t left   = std::floor((_region.x - margin) * scale);
+	double_t top    = std::floor((_region.y - margin) * scale);
+	double_t right  = std::ceil((_region.x + _region.cx + margin) * scale);
+	double_t bottom = std::ceil((_region.y + _region.cy + margin) * scale);
+
+	gs_rect rect;
+	rect.x  = static_cast<int>(std::clamp<double_t>(left, 0., width));
+	rect.y  = static_cast<int>(std::clamp<double_t>(top, 0., height));
+	rect.cx = static_cast<int>(std::clamp<double_t>(right, 0., width)) - rect.x;
+	rect.cy = static_cast<int>(std::clamp<double_t>(bottom, 0., height)) - rect.y;
+	if (gs_get_device_type() == GS_DEVICE_OPENGL) {
+		// libobs flips viewports for OpenGL but passes scissor rectangles as is, which count rows from the bottom.
+		rect.y = static_cast<int>(height) - (rect.y + rect.cy);
+	}
+	gs_set_scissor_rect(&rect);
+	_region_active = true;
+}
+
+void gfx::blur::base::end_region()
+{
+	if (_region_active) {
+		gs_set_scissor_rect(nullptr);
+		_region_active = false;
+	}
+}
+
 void gfx::blur::base::set_step_scale_x(double_t v)
 {
 	this->set_step_scale(v, this->get_step_scale_y());
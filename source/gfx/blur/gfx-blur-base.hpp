@@ -30,6 +30,9 @@ namespace gfx {
 		};
 
 		class base {
+			gs_rect _region = {0, 0, 0, 0};
+			bool    _region_active = false;
+
 			public:
 			virtual ~base() {}
 
@@ -56,6 +59,23 @@ namespace gfx {
 			virtual std::shared_ptr<::gs::texture> render() = 0;
 
 			virtual std::shared_ptr<::gs::texture> get() = 0;
+
+			/** Restrict rendering to a rectangle of the input texture, in pixels.
+			 *
+			 * Implementations expand the rectangle by the reach of their kernel where needed, so that the output is
+			 * correct inside of it. Content outside of it is undefined and must be replaced by the caller. A zero
+			 * width or height disables the restriction.
+			 */
+			virtual void set_region(uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+
+			virtual void get_region(uint32_t& x, uint32_t& y, uint32_t& width, uint32_t& height);
+
+			protected:
+			// Apply the region as scissor rectangle to a pass of the given size, scaled by 'scale' and expanded by
+			// 'margin' input pixels. Must be paired with end_region() before the render target op ends.
+			void begin_region(uint32_t width, uint32_t height, double_t scale, double_t margin);
+
+			void end_region();
 		};
 
 		class base_angle {
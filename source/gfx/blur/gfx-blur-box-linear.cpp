@@ -16,6 +16,7 @@
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
 
 #include "gfx-blur-box-linear.hpp"
+#include <algorithm>
 #include <cmath>
 #include <memory>
 #include <stdexcept>
@@ -251,6 +252,9 @@ std::shared_ptr<::gs::texture> gfx::blur::box_linear::render()
 	float_t width  = float_t(_input_texture->get_width());
 	float_t height = float_t(_input_texture->get_height());
 
+	// The first pass must also cover what the second pass samples, so expand by the full reach of the kernel.
+	double_t margin = _size * std::max(_step_scale.first, _step_scale.second) + 1.;
+
 	gs_set_cull_mode(GS_NEITHER);
 	gs_enable_color(true, true, true, true);
 	gs_enable_depth_test(false);
@@ -281,9 +285,11 @@ std::shared_ptr<::gs::texture> gfx::blur::box_linear::render()
 
 			auto op = _rendertarget2->render(uint32_t(width), uint32_t(height));
 			gs_ortho(0, 1., 0, 1., 0, 1.);
+			begin_region(uint32_t(width), uint32_t(height), 1., margin);
 			while (gs_effect_loop(effect.get_object(), "Draw")) {
 				streamfx::gs_draw_fullscreen_tri();
 			}
+			end_region();
 		}
 
 		// Pass 2
@@ -297,9 +303,11 @@ std::shared_ptr<::gs::texture> gfx::blur::box_linear::render()
 
 			auto op = _rendertarget->render(uint32_t(width), uint32_t(height));
 			gs_ortho(0, 1., 0, 1., 0, 1.);
+			begin_region(uint32_t(width), uint32_t(height), 1., margin);
 			while (gs_effect_loop(effect.get_object(), "Draw")) {
 				streamfx::gs_draw_fullscreen_tri();
 			}
+			end_region();
 		}
 	}
 
@@ -367,9 +375,11 @@ std::shared_ptr<::gs::texture> gfx::blur::box_linear_directional::render()
 		{
 			auto op = _rendertarget->render(uint32_t(width), uint32_t(height));
 			gs_ortho(0, 1., 0, 1., 0, 1.);
+			begin_region(uint32_t(width), uint32_t(height), 1., 0.);
 			while (gs_effect_loop(effect.get_object(), "Draw")) {
 				streamfx::gs_draw_fullscreen_tri();
 			}
+			end_region();
 		}
 	}
 
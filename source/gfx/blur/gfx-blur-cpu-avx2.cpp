@@ -0,0 +1,69 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "gfx-blur-cpu-kernels.hpp"
+
+// Built with AVX2 and FMA enabled on x86, see CMakeLists.txt. Only ever called after checking the CPU for support.
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#include <immintrin.h>
+
+using namespace gfx::blur::cpu;
+
+namespace {
+	struct avx2 {
+		// Holds the weighted left texels in the lower and the right texels in the upper half.
+		using accumulator = __m256;
+
+		static inline accumulator zero()
+		{
+			return _mm256_setzero_ps();
+		}
+
+		static inline void sample(accumulator& acc, kernels::source const& input, float_t u, float_t v, float_t weight)
+		{
+			auto fp = kernels::locate(input, u, v);
+
+			// Load both texels of a row at once, and blend the rows first.
+			__m256 top    = _mm256_loadu_ps(fp.top);
+			__m256 bottom = _mm256_loadu_ps(fp.bottom);
+			__m256 row    = _mm256_fmadd_ps(_mm256_sub_ps(bottom, top), _mm256_set1_ps(fp.fy), top);
+
+			float_t right = weight * fp.fx;
+			float_t left  = weight - right;
+			acc = _mm256_fmadd_ps(row, _mm256_blend_ps(_mm256_set1_ps(left), _mm256_set1_ps(right), 0xF0), acc);
+		}
+
+		static inline void store(float_t* out, accumulator const& acc)
+		{
+			_mm_storeu_ps(out, _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1)));
+		}
+	};
+} // namespace
+
+kernels::functions const* gfx::blur::cpu::kernels::avx2()
+{
+	return instantiate<::avx2>();
+}
+#else
+gfx::blur::cpu::kernels::functions const* gfx::blur::cpu::kernels::avx2()
+{
+	return nullptr;
+}
+#endif
@@ -0,0 +1,198 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+#include "common.hpp"
+#include "gfx-blur-cpu.hpp"
+
+// Passes shared by every instruction set. Each instruction set provides a type with an 'accumulator', 'zero()',
+// 'sample()' and 'store()', and instantiates the passes below with it in its own translation unit, so that only that
+// unit has to be compiled for the instruction set.
+
+namespace gfx {
+	namespace blur {
+		namespace cpu {
+			namespace kernels {
+				struct tap {
+					float_t x;
+					float_t y;
+					float_t weight;
+				};
+
+				struct functions {
+					// Sample each tap at an offset in UV space from the center of every output texel.
+					void (*convolve)(image const& input, image& output, tap const* taps, std::size_t count);
+
+					// Sample each tap rotated around the center, with the cosine and sine of the angle in x and y.
+					void (*rotate)(image const& input, image& output, tap const* taps, std::size_t count,
+								   float_t center_x, float_t center_y);
+
+					// Sample each tap along the direction away from the center, with the step count in x.
+					void (*zoom)(image const& input, image& output, tap const* taps, std::size_t count,
+								 float_t center_x, float_t center_y, float_t step_x, float_t step_y);
+				};
+
+				::gfx::blur::cpu::kernels::functions const* scalar();
+
+				// Returns nullptr if the instruction set was not compiled in.
+				::gfx::blur::cpu::kernels::functions const* avx2();
+
+				// Returns nullptr if the instruction set was not compiled in.
+				::gfx::blur::cpu::kernels::functions const* neon();
+
+				// Raw view of an image, so that sampling does not have to go through its accessors.
+				struct source {
+					const float_t* data;
+					int32_t        width;
+					int32_t        height;
+				};
+
+				/** The two rows of the 2x2 texel footprint of a linearly filtered sample with clamped addressing.
+				 *
+				 * 'top' and 'bottom' point at the left texel of each row, the right texel follows directly after it.
+				 */
+				struct footprint {
+					const float_t* top;
+					const float_t* bottom;
+					float_t        fx;
+					float_t        fy;
+				};
+
+				// These are compiled into every instruction set's unit, so they must not be shared between them as
+				// an inline function would be: the linker could pick the copy built for an unsupported CPU.
+				static inline source make_source(image const& input)
+				{
+					return {input.data(), static_cast<int32_t>(input.get_width()),
+							static_cast<int32_t>(input.get_height())};
+				}
+
+				static inline int32_t locate_axis(float_t uv, int32_t size, float_t& fraction)
+				{
+					float_t position = uv * float_t(size) - .5f;
+					position         = (position > 0.f) ? position : 0.f;
+					position         = (position < float_t(size - 1)) ? position : float_t(size - 1);
+					int32_t index    = static_cast<int32_t>(position);
+					index            = (index < size - 2) ? index : ((size > 1) ? (size - 2) : 0);
+					fraction         = position - float_t(index);
+					return index;
+				}
+
+				static inline footprint locate(source const& input, float_t u, float_t v)
+				{
+					footprint fp;
+					int32_t   x = locate_axis(u, input.width, fp.fx);
+					int32_t   y = locate_axis(v, input.height, fp.fy);
+					fp.top      = input.data + (static_cast<std::size_t>(y) * input.width + x) * 4;
+					fp.bottom   = (input.height > 1) ? (fp.top + static_cast<std::size_t>(input.width) * 4) : fp.top;
+					return fp;
+				}
+
+				template<typename T>
+				void convolve(image const& input, image& output, tap const* taps, std::size_t count)
+				{
+					source   src     = make_source(input);
+					uint32_t width   = output.get_width();
+					uint32_t height  = output.get_height();
+					float_t  texel_x = 1.f / float_t(width);
+					float_t  texel_y = 1.f / float_t(height);
+					for (uint32_t y = 0; y < height; y++) {
+						float_t  v   = (float_t(y) + .5f) * texel_y;
+						float_t* out = output.at(0, y);
+						for (uint32_t x = 0; x < width; x++, out += 4) {
+							float_t u   = (float_t(x) + .5f) * texel_x;
+							auto    acc = T::zero();
+							for (std::size_t idx = 0; idx < count; idx++) {
+								T::sample(acc, src, u + taps[idx].x, v + taps[idx].y, taps[idx].weight);
+							}
+							T::store(out, acc);
+						}
+					}
+				}
+
+				template<typename T>
+				void rotate(image const& input, image& output, tap const* taps, std::size_t count, float_t center_x,
+							float_t center_y)
+				{
+					source   src     = make_source(input);
+					uint32_t width   = output.get_width();
+					uint32_t height  = output.get_height();
+					float_t  texel_x = 1.f / float_t(width);
+					float_t  texel_y = 1.f / float_t(height);
+					for (uint32_t y = 0; y < height; y++) {
+						float_t  dy  = (float_t(y) + .5f) * texel_y - center_y;
+						float_t* out = output.at(0, y);
+						for (uint32_t x = 0; x < width; x++, out += 4) {
+							float_t dx  = (float_t(x) + .5f) * texel_x - center_x;
+							auto    acc = T::zero();
+							for (std::size_t idx = 0; idx < count; idx++) {
+								float_t cp = taps[idx].x;
+								float_t sp = taps[idx].y;
+								T::sample(acc, src, dx * cp - dy * sp + center_x, dx * sp + dy * cp + center_y,
+										  taps[idx].weight);
+							}
+							T::store(out, acc);
+						}
+					}
+				}
+
+				template<typename T>
+				void zoom(image const& input, image& output, tap const* taps, std::size_t count, float_t center_x,
+						  float_t center_y, float_t step_x, float_t step_y)
+				{
+					source   src     = make_source(input);
+					uint32_t width   = output.get_width();
+					uint32_t height  = output.get_height();
+					float_t  texel_x = 1.f / float_t(width);
+					float_t  texel_y = 1.f / float_t(height);
+					for (uint32_t y = 0; y < height; y++) {
+						float_t  v   = (float_t(y) + .5f) * texel_y;
+						float_t* out = output.at(0, y);
+						for (uint32_t x = 0; x < width; x++, out += 4) {
+							float_t u = (float_t(x) + .5f) * texel_x;
+
+							// normalize(uv - center) * step * distance(uv, center) reduces to (uv - center) * step,
+							// which also avoids the division by zero at the center itself.
+							float_t dir_x = (u - center_x) * step_x;
+							float_t dir_y = (v - center_y) * step_y;
+
+							auto acc = T::zero();
+							for (std::size_t idx = 0; idx < count; idx++) {
+								T::sample(acc, src, u + dir_x * taps[idx].x, v + dir_y * taps[idx].x,
+										  taps[idx].weight);
+							}
+							T::store(out, acc);
+						}
+					}
+				}
+
+				template<typename T>
+				::gfx::blur::cpu::kernels::functions const* instantiate()
+				{
+					static const ::gfx::blur::cpu::kernels::functions fns = {
+						&convolve<T>,
+						&rotate<T>,
+						&zoom<T>,
+					};
+					return &fns;
+				}
+			} // namespace kernels
+		} // namespace cpu
+	} // namespace blur
+} // namespace gfx
@@ -0,0 +1,66 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "gfx-blur-cpu-kernels.hpp"
+
+// NEON is part of every ARMv8 CPU, and of ARMv7 builds that explicitly enable it.
+#if defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+
+using namespace gfx::blur::cpu;
+
+namespace {
+	struct neon {
+		using accumulator = float32x4_t;
+
+		static inline accumulator zero()
+		{
+			return vdupq_n_f32(0.f);
+		}
+
+		static inline void sample(accumulator& acc, kernels::source const& input, float_t u, float_t v, float_t weight)
+		{
+			auto fp = kernels::locate(input, u, v);
+
+			float_t     wb  = weight * fp.fy;
+			float_t     wt  = weight - wb;
+			float32x4_t top = vmlaq_n_f32(vmulq_n_f32(vld1q_f32(fp.top), 1.f - fp.fx), vld1q_f32(fp.top + 4), fp.fx);
+			float32x4_t bottom =
+				vmlaq_n_f32(vmulq_n_f32(vld1q_f32(fp.bottom), 1.f - fp.fx), vld1q_f32(fp.bottom + 4), fp.fx);
+			acc = vmlaq_n_f32(vmlaq_n_f32(acc, top, wt), bottom, wb);
+		}
+
+		static inline void store(float_t* out, accumulator const& acc)
+		{
+			vst1q_f32(out, acc);
+		}
+	};
+} // namespace
+
+kernels::functions const* gfx::blur::cpu::kernels::neon()
+{
+	return instantiate<::neon>();
+}
+#else
+gfx::blur::cpu::kernels::functions const* gfx::blur::cpu::kernels::neon()
+{
+	return nullptr;
+}
+#endif
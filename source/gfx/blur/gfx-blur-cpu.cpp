@@ -0,0 +1,474 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "gfx-blur-cpu.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "gfx-blur-box-linear.hpp"
+#include "gfx-blur-box.hpp"
+#include "gfx-blur-cpu-kernels.hpp"
+#include "gfx-blur-dual-filtering.hpp"
+#include "gfx-blur-gaussian-linear.hpp"
+#include "gfx-blur-gaussian.hpp"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+// Upper bound of the sampling loops in the effect files.
+#define MAX_KERNEL_STEPS 128
+// Deepest level of Dual Filtering, also change this in gfx-blur-dual-filtering.cpp if modified.
+#define MAX_LEVELS 16
+
+using namespace gfx::blur::cpu;
+
+namespace {
+	struct scalar {
+		struct accumulator {
+			float_t v[4];
+		};
+
+		static inline accumulator zero()
+		{
+			return {{0.f, 0.f, 0.f, 0.f}};
+		}
+
+		static inline void sample(accumulator& acc, kernels::source const& input, float_t u, float_t v, float_t weight)
+		{
+			auto    fp = kernels::locate(input, u, v);
+			float_t wb = weight * fp.fy;
+			float_t wt = weight - wb;
+			float_t w[4] = {wt - wt * fp.fx, wt * fp.fx, wb - wb * fp.fx, wb * fp.fx};
+			for (std::size_t idx = 0; idx < 4; idx++) {
+				acc.v[idx] += fp.top[idx] * w[0] + fp.top[idx + 4] * w[1] + fp.bottom[idx] * w[2]
+							  + fp.bottom[idx + 4] * w[3];
+			}
+		}
+
+		static inline void store(float_t* out, accumulator const& acc)
+		{
+			std::copy(acc.v, acc.v + 4, out);
+		}
+	};
+
+	bool cpu_has_avx2()
+	{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+		int regs[4];
+		__cpuid(regs, 0);
+		if (regs[0] < 7)
+			return false;
+
+		// FMA and OS support for saving the YMM registers.
+		__cpuid(regs, 1);
+		if (((regs[2] & (1 << 12)) == 0) || ((regs[2] & (1 << 27)) == 0))
+			return false;
+		if ((_xgetbv(0) & 0x6) != 0x6)
+			return false;
+
+		__cpuidex(regs, 7, 0);
+		return (regs[1] & (1 << 5)) != 0;
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+		return false;
+#endif
+	}
+
+	kernels::functions const* get_functions(instruction_set v)
+	{
+		switch (v) {
+		case instruction_set::Scalar:
+			return kernels::scalar();
+		case instruction_set::AVX2:
+			return cpu_has_avx2() ? kernels::avx2() : nullptr;
+		case instruction_set::NEON:
+			return kernels::neon();
+		}
+		return nullptr;
+	}
+
+	/** Distance in steps and weight of every sample on one side of a 1D kernel, the center first.
+	 *
+	 * Matches the loops in the effect files, which compare a float size against an integer step.
+	 */
+	std::vector<std::pair<float_t, float_t>> line_taps(algorithm algo, double_t size)
+	{
+		std::vector<std::pair<float_t, float_t>> taps;
+		float_t                                  fsize   = float_t(size);
+		bool                                     is_odd  = (std::lround(fsize) % 2) == 1;
+		float_t                                  inv_mul = 1.f / (fsize * 2.f + 1.f);
+
+		switch (algo) {
+		case algorithm::Box:
+			taps.emplace_back(0.f, inv_mul);
+			for (int32_t n = 1; n <= MAX_KERNEL_STEPS; n++) {
+				taps.emplace_back(float_t(n), inv_mul);
+				if (float_t(n) >= fsize)
+					break;
+			}
+			break;
+		case algorithm::BoxLinear:
+			taps.emplace_back(0.f, inv_mul);
+			for (int32_t n = 1; (n <= MAX_KERNEL_STEPS) && (float_t(n) < fsize); n += 2) {
+				taps.emplace_back(float_t(n) + .5f, inv_mul * 2.f);
+			}
+			if (is_odd)
+				taps.emplace_back(fsize, inv_mul);
+			break;
+		case algorithm::Gaussian: {
+			auto kernel = ::gfx::blur::gaussian_data::generate_kernel(std::size_t(size));
+			taps.emplace_back(0.f, kernel[0]);
+			for (int32_t n = 1; n < int32_t(kernel.size()); n++) {
+				taps.emplace_back(float_t(n), kernel[n]);
+				if (float_t(n) >= fsize)
+					break;
+			}
+			break;
+		}
+		case algorithm::GaussianLinear: {
+			auto kernel = ::gfx::blur::gaussian_data::generate_kernel(std::size_t(size));
+			taps.emplace_back(0.f, kernel[0]);
+			for (int32_t n = 1; (n + 1 < int32_t(kernel.size())) && (float_t(n) < fsize); n += 2) {
+				taps.emplace_back(float_t(n) + .5f, kernel[n] + kernel[n + 1]);
+			}
+			if (is_odd)
+				taps.emplace_back(fsize, kernel[std::min<std::size_t>(std::size_t(fsize), kernel.size() - 1)]);
+			break;
+		}
+		default:
+			throw std::runtime_error("Invalid algorithm.");
+		}
+
+		return taps;
+	}
+
+	// Mirror the one-sided taps along a direction, given in UV units per step.
+	std::vector<kernels::tap> mirror_taps(std::vector<std::pair<float_t, float_t>> const& line, float_t x, float_t y)
+	{
+		std::vector<kernels::tap> taps;
+		taps.reserve(line.size() * 2);
+		for (auto const& kv : line) {
+			taps.push_back({x * kv.first, y * kv.first, kv.second});
+			if (kv.first > 0.f)
+				taps.push_back({-x * kv.first, -y * kv.first, kv.second});
+		}
+		return taps;
+	}
+} // namespace
+
+image::image() : _width(0), _height(0), _data() {}
+
+image::image(uint32_t width, uint32_t height) : image()
+{
+	resize(width, height);
+}
+
+image::~image() {}
+
+void image::resize(uint32_t width, uint32_t height)
+{
+	_width  = width;
+	_height = height;
+	_data.resize((static_cast<std::size_t>(width) * height + 1) * 4);
+}
+
+uint32_t image::get_width() const
+{
+	return _width;
+}
+
+uint32_t image::get_height() const
+{
+	return _height;
+}
+
+float_t* image::data()
+{
+	return _data.data();
+}
+
+const float_t* image::data() const
+{
+	return _data.data();
+}
+
+float_t* image::at(uint32_t x, uint32_t y)
+{
+	return _data.data() + (static_cast<std::size_t>(y) * _width + x) * 4;
+}
+
+const float_t* image::at(uint32_t x, uint32_t y) const
+{
+	return _data.data() + (static_cast<std::size_t>(y) * _width + x) * 4;
+}
+
+const char* gfx::blur::cpu::to_string(instruction_set v)
+{
+	switch (v) {
+	case instruction_set::Scalar:
+		return "Scalar";
+	case instruction_set::AVX2:
+		return "AVX2";
+	case instruction_set::NEON:
+		return "NEON";
+	}
+	return "Unknown";
+}
+
+bool gfx::blur::cpu::is_instruction_set_supported(instruction_set v)
+{
+	return get_functions(v) != nullptr;
+}
+
+instruction_set gfx::blur::cpu::get_best_instruction_set()
+{
+	for (auto v : {instruction_set::AVX2, instruction_set::NEON}) {
+		if (is_instruction_set_supported(v))
+			return v;
+	}
+	return instruction_set::Scalar;
+}
+
+kernels::functions const* gfx::blur::cpu::kernels::scalar()
+{
+	return instantiate<::scalar>();
+}
+
+gfx::blur::cpu::blur::blur(algorithm algorithm, ::gfx::blur::type type)
+	: _algorithm(algorithm), _type(type), _instruction_set(get_best_instruction_set()), _size(1.),
+	  _step_scale({1., 1.}), _angle(0.), _center({.5, .5}), _levels()
+{
+	if (!get_factory(algorithm).is_type_supported(type))
+		throw std::runtime_error("Invalid type.");
+}
+
+gfx::blur::cpu::blur::~blur() {}
+
+algorithm gfx::blur::cpu::blur::get_algorithm()
+{
+	return _algorithm;
+}
+
+::gfx::blur::type gfx::blur::cpu::blur::get_type()
+{
+	return _type;
+}
+
+instruction_set gfx::blur::cpu::blur::get_instruction_set()
+{
+	return _instruction_set;
+}
+
+void gfx::blur::cpu::blur::set_instruction_set(instruction_set v)
+{
+	if (!is_instruction_set_supported(v))
+		throw std::runtime_error("Instruction set is not supported.");
+	_instruction_set = v;
+}
+
+double_t gfx::blur::cpu::blur::get_size()
+{
+	return _size;
+}
+
+void gfx::blur::cpu::blur::set_size(double_t width)
+{
+	auto& factory = get_factory(_algorithm);
+	_size         = std::clamp(width, factory.get_min_size(_type), factory.get_max_size(_type));
+}
+
+void gfx::blur::cpu::blur::get_step_scale(double_t& x, double_t& y)
+{
+	x = _step_scale.first;
+	y = _step_scale.second;
+}
+
+void gfx::blur::cpu::blur::set_step_scale(double_t x, double_t y)
+{
+	_step_scale.first  = x;
+	_step_scale.second = y;
+}
+
+double_t gfx::blur::cpu::blur::get_angle()
+{
+	return _angle;
+}
+
+void gfx::blur::cpu::blur::set_angle(double_t angle)
+{
+	_angle = angle;
+}
+
+void gfx::blur::cpu::blur::get_center(double_t& x, double_t& y)
+{
+	x = _center.first;
+	y = _center.second;
+}
+
+void gfx::blur::cpu::blur::set_center(double_t x, double_t y)
+{
+	_center.first  = x;
+	_center.second = y;
+}
+
+void gfx::blur::cpu::blur::render(image const& input, image& output)
+{
+	if (&input == &output)
+		throw std::runtime_error("Input and output must be different images.");
+
+	auto fns = get_functions(_instruction_set);
+	if (!fns)
+		throw std::runtime_error("Instruction set is not supported.");
+
+	uint32_t width  = input.get_width();
+	uint32_t height = input.get_height();
+	if ((width == 0) || (height == 0)) {
+		output.resize(width, height);
+		return;
+	}
+
+	// Dual Filtering halves the image per level, instead of sampling along a kernel.
+	if (_algorithm == algorithm::DualFiltering) {
+		std::size_t iterations = std::min<std::size_t>(std::size_t(std::lround(_size)), std::size_t(MAX_LEVELS));
+		_levels.resize(iterations + 1);
+
+		// Downsample
+		for (std::size_t n = 1; n <= iterations; n++) {
+			uint32_t owidth  = width >> n;
+			uint32_t oheight = height >> n;
+			if ((owidth <= 0) || (oheight <= 0)) {
+				iterations = n - 1;
+				break;
+			}
+
+			float_t      hx      = .5f / float_t(owidth);
+			float_t      hy      = .5f / float_t(oheight);
+			kernels::tap taps[5] = {
+				{0.f, 0.f, .5f}, {-hx, -hy, .125f}, {hx, hy, .125f}, {hx, -hy, .125f}, {-hx, hy, .125f},
+			};
+			_levels[n].resize(owidth, oheight);
+			fns->convolve((n > 1) ? _levels[n - 1] : input, _levels[n], taps, 5);
+		}
+
+		if (iterations == 0) {
+			output = input;
+			return;
+		}
+
+		// Upsample
+		for (std::size_t n = iterations; n > 0; n--) {
+			float_t      hx      = .5f / float_t(width >> n);
+			float_t      hy      = .5f / float_t(height >> n);
+			float_t      edge    = float_t(1. / 12.);
+			float_t      corner  = float_t(2. / 12.);
+			kernels::tap taps[8] = {
+				{-hx * 2.f, 0.f, edge}, {hx * 2.f, 0.f, edge}, {0.f, hy * 2.f, edge}, {0.f, -hy * 2.f, edge},
+				{-hx, hy, corner},      {hx, hy, corner},      {hx, -hy, corner},     {-hx, -hy, corner},
+			};
+			image& target = (n > 1) ? _levels[n - 1] : output;
+			target.resize(width >> (n - 1), height >> (n - 1));
+			fns->convolve(_levels[n], target, taps, 8);
+		}
+		return;
+	}
+
+	// The Gaussian variants skip rendering entirely when there is nothing to step over.
+	bool is_gaussian = (_algorithm == algorithm::Gaussian) || (_algorithm == algorithm::GaussianLinear);
+	if (is_gaussian && ((_step_scale.first + _step_scale.second) < std::numeric_limits<double_t>::epsilon())) {
+		output = input;
+		return;
+	}
+
+	auto    line    = line_taps(_algorithm, _size);
+	float_t texel_x = 1.f / float_t(width);
+	float_t texel_y = 1.f / float_t(height);
+	float_t step_x  = float_t(_step_scale.first);
+	float_t step_y  = float_t(_step_scale.second);
+	output.resize(width, height);
+
+	switch (_type) {
+	case ::gfx::blur::type::Area: {
+		bool horizontal = !is_gaussian || (_step_scale.first > std::numeric_limits<double_t>::epsilon());
+		bool vertical   = !is_gaussian || (_step_scale.second > std::numeric_limits<double_t>::epsilon());
+		_levels.resize(1);
+
+		image const* source = &input;
+		if (horizontal) {
+			auto   taps   = mirror_taps(line, texel_x * step_x, 0.f);
+			image& target = vertical ? _levels[0] : output;
+			target.resize(width, height);
+			fns->convolve(*source, target, taps.data(), taps.size());
+			source = &target;
+		}
+		if (vertical) {
+			auto taps = mirror_taps(line, 0.f, texel_y * step_y);
+			fns->convolve(*source, output, taps.data(), taps.size());
+		}
+		break;
+	}
+	case ::gfx::blur::type::Directional: {
+		double_t angle = D_DEG_TO_RAD(_angle);
+		float_t  dir_x = float_t(texel_x * cos(angle)) * step_x;
+		float_t  dir_y = float_t(texel_y * sin(angle)) * step_y;
+		auto     taps  = mirror_taps(line, dir_x, dir_y);
+		fns->convolve(input, output, taps.data(), taps.size());
+		break;
+	}
+	case ::gfx::blur::type::Rotational: {
+		// The effect rotates in UV space by a fraction of the angle per step.
+		float_t                   step = float_t(D_DEG_TO_RAD(_angle) / _size) * step_x;
+		std::vector<kernels::tap> taps;
+		for (auto const& kv : mirror_taps(line, step, 0.f)) {
+			taps.push_back({std::cos(kv.x), std::sin(kv.x), kv.weight});
+		}
+		fns->rotate(input, output, taps.data(), taps.size(), float_t(_center.first), float_t(_center.second));
+		break;
+	}
+	case ::gfx::blur::type::Zoom: {
+		auto taps = mirror_taps(line, 1.f, 0.f);
+		fns->zoom(input, output, taps.data(), taps.size(), float_t(_center.first), float_t(_center.second),
+				  texel_x * step_x, texel_y * step_y);
+		break;
+	}
+	default:
+		throw std::runtime_error("Invalid type.");
+	}
+}
+
+::gfx::blur::ifactory& gfx::blur::cpu::blur::get_factory(algorithm algorithm)
+{
+	switch (algorithm) {
+	case algorithm::Box:
+		return ::gfx::blur::box_factory::get();
+	case algorithm::BoxLinear:
+		return ::gfx::blur::box_linear_factory::get();
+	case algorithm::Gaussian:
+		return ::gfx::blur::gaussian_factory::get();
+	case algorithm::GaussianLinear:
+		return ::gfx::blur::gaussian_linear_factory::get();
+	case algorithm::DualFiltering:
+		return ::gfx::blur::dual_filtering_factory::get();
+	}
+	throw std::runtime_error("Invalid algorithm.");
+}
@@ -0,0 +1,131 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+#include "common.hpp"
+#include <vector>
+#include "gfx-blur-base.hpp"
+
+namespace gfx {
+	namespace blur {
+		namespace cpu {
+			/** Floating point RGBA image in system memory, laid out like a GS_RGBA32F texture.
+			 *
+			 * One extra texel is allocated past the last row, so that two horizontally neighbouring texels can always
+			 * be loaded together even at the right-most edge.
+			 */
+			class image {
+				uint32_t             _width;
+				uint32_t             _height;
+				std::vector<float_t> _data;
+
+				public:
+				image();
+				image(uint32_t width, uint32_t height);
+				~image();
+
+				void resize(uint32_t width, uint32_t height);
+
+				uint32_t get_width() const;
+
+				uint32_t get_height() const;
+
+				float_t* data();
+
+				const float_t* data() const;
+
+				float_t* at(uint32_t x, uint32_t y);
+
+				const float_t* at(uint32_t x, uint32_t y) const;
+			};
+
+			enum class algorithm {
+				Box,
+				BoxLinear,
+				Gaussian,
+				GaussianLinear,
+				DualFiltering,
+			};
+
+			enum class instruction_set {
+				Scalar,
+				AVX2,
+				NEON,
+			};
+
+			const char* to_string(instruction_set v);
+
+			bool is_instruction_set_supported(instruction_set v);
+
+			instruction_set get_best_instruction_set();
+
+			/** Reference implementation of the blur effects in data/effects/blur.
+			 *
+			 * Mirrors the sampling positions, kernels and passes of the matching gfx::blur class, including linear
+			 * filtering with clamped addressing, so the result can be compared against the GPU output of the same
+			 * settings. Limits are taken from the factory of the algorithm.
+			 */
+			class blur {
+				::gfx::blur::cpu::algorithm       _algorithm;
+				::gfx::blur::type                 _type;
+				::gfx::blur::cpu::instruction_set _instruction_set;
+				double_t                          _size;
+				std::pair<double_t, double_t>     _step_scale;
+				double_t                          _angle;
+				std::pair<double_t, double_t>     _center;
+
+				std::vector<::gfx::blur::cpu::image> _levels;
+
+				public:
+				blur(::gfx::blur::cpu::algorithm algorithm, ::gfx::blur::type type);
+				~blur();
+
+				::gfx::blur::cpu::algorithm get_algorithm();
+
+				::gfx::blur::type get_type();
+
+				::gfx::blur::cpu::instruction_set get_instruction_set();
+
+				void set_instruction_set(::gfx::blur::cpu::instruction_set v);
+
+				double_t get_size();
+
+				void set_size(double_t width);
+
+				void get_step_scale(double_t& x, double_t& y);
+
+				void set_step_scale(double_t x, double_t y);
+
+				double_t get_angle();
+
+				void set_angle(double_t angle);
+
+				void get_center(double_t& x, double_t& y);
+
+				void set_center(double_t x, double_t y);
+
+				void render(::gfx::blur::cpu::image const& input, ::gfx::blur::cpu::image& output);
+
+				public:
+				static ::gfx::blur::ifactory& get_factory(::gfx::blur::cpu::algorithm algorithm);
+			};
+		} // namespace cpu
+	} // namespace blur
+} // namespace gfx
@@ -254,6 +254,10 @@ std::shared_ptr<::gs::texture> gfx::blur::dual_filtering::render()
 	uint32_t width  = _input_texture->get_width();
 	uint32_t height = _input_texture->get_height();
 
+	// Every level samples a few texels around each pixel of the previous one, so the region has to grow with the
+	// deepest level that is visited. Each level is then restricted to the region scaled down to its size.
+	double_t margin = double_t(size_t(4) << actual_iterations);
+
 	// Downsample
 	for (std::size_t n = 1; n <= actual_iterations; n++) {
 #ifdef ENABLE_PROFILING
@@ -285,9 +289,11 @@ std::shared_ptr<::gs::texture> gfx::blur::dual_filtering::render()
 		{
 			auto op = _rts[n]->render(owidth, oheight);
 			gs_ortho(0., 1., 0., 1., 0., 1.);
+			begin_region(owidth, oheight, 1. / double_t(size_t(1) << n), margin);
 			while (gs_effect_loop(effect.get_object(), "Down")) {
 				streamfx::gs_draw_fullscreen_tri();
 			}
+			end_region();
 		}
 	}
 
@@ -315,9 +321,11 @@ std::shared_ptr<::gs::texture> gfx::blur::dual_filtering::render()
 		{
 			auto op = _rts[n - 1]->render(owidth, oheight);
 			gs_ortho(0., 1., 0., 1., 0., 1.);
+			begin_region(owidth, oheight, 1. / double_t(size_t(1) << (n - 1)), margin);
 			while (gs_effect_loop(effect.get_object(), "Up")) {
 				streamfx::gs_draw_fullscreen_tri();
 			}
+			end_region();
 		}
 	}
 
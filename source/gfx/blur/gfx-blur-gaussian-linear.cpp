@@ -16,7 +16,9 @@
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
 
 #include "gfx-blur-gaussian-linear.hpp"
+#include <algorithm>
 #include <stdexcept>
+#include "gfx-blur-gaussian.hpp"
 #include "obs/gs/gs-helper.hpp"
 
 #ifdef _MSC_VER
@@ -29,50 +31,17 @@
 #pragma warning(pop)
 #endif
 
-// FIXME: This breaks when MAX_KERNEL_SIZE is changed, due to the way the Gaussian
-//  function first goes up at the point, and then once we pass the critical point
-//  will go down again and it is not handled well. This is a pretty basic
-//  approximation anyway at the moment.
 #define MAX_KERNEL_SIZE 128
 #define MAX_BLUR_SIZE (MAX_KERNEL_SIZE - 1)
-#define SEARCH_DENSITY double_t(1. / 500.)
-#define SEARCH_THRESHOLD double_t(1. / (MAX_KERNEL_SIZE * 5))
-#define SEARCH_EXTENSION 1
-#define SEARCH_RANGE MAX_KERNEL_SIZE * 2
 
 gfx::blur::gaussian_linear_data::gaussian_linear_data()
 {
 	auto gctx = gs::context();
 	_effect   = gs::effect::create(streamfx::data_file_path("effects/blur/gaussian-linear.effect").u8string());
 
-	// Precalculate Kernels
+	// Precalculate Kernels, shared with the regular Gaussian Blur.
 	for (std::size_t kernel_size = 1; kernel_size <= MAX_BLUR_SIZE; kernel_size++) {
-		std::vector<double_t> kernel_math(MAX_KERNEL_SIZE);
-		std::vector<float_t>  kernel_data(MAX_KERNEL_SIZE);
-		double_t              actual_width = 1.;
-
-		// Find actual kernel width.
-		for (double_t h = SEARCH_DENSITY; h < SEARCH_RANGE; h += SEARCH_DENSITY) {
-			if (util::math::gaussian<double_t>(double_t(kernel_size + SEARCH_EXTENSION), h) > SEARCH_THRESHOLD) {
-				actual_width = h;
-				break;
-			}
-		}
-
-		// Calculate and normalize
-		double_t sum = 0;
-		for (std::size_t p = 0; p <= kernel_size; p++) {
-			kernel_math[p] = util::math::gaussian<double_t>(double_t(p), actual_width);
-			sum += kernel_math[p] * (p > 0 ? 2 : 1);
-		}
-
-		// Normalize to fill the entire 0..1 range over the width.
-		double_t inverse_sum = 1.0 / sum;
-		for (std::size_t p = 0; p <= kernel_size; p++) {
-			kernel_data.at(p) = float_t(kernel_math[p] * inverse_sum);
-		}
-
-		_kernels.push_back(std::move(kernel_data));
+		_kernels.push_back(::gfx::blur::gaussian_data::generate_kernel(kernel_size));
 	}
 }
 
@@ -301,6 +270,9 @@ std::shared_ptr<::gs::texture> gfx::blur::gaussian_linear::render()
 	float_t width  = float_t(_input_texture->get_width());
 	float_t height = float_t(_input_texture->get_height());
 
+	// The first pass must also cover what the second pass samples, so expand by the full reach of the kernel.
+	double_t margin = _size * std::max(_step_scale.first, _step_scale.second) + 1.;
+
 	// Setup
 	gs_set_cull_mode(GS_NEITHER);
 	gs_enable_color(true, true, true, true);
@@ -331,9 +303,11 @@ std::shared_ptr<::gs::texture> gfx::blur::gaussian_linear::render()
 
 			auto op = _rendertarget2->render(uint32_t(width), uint32_t(height));
 			gs_ortho(0, 1., 0, 1., 0, 1.);
+			begin_region(uint32_t(width), uint32_t(height), 1., margin);
 			while (gs_effect_loop(effect.get_object(), "Draw")) {
 				streamfx::gs_draw_fullscreen_tri();
 			}
+			end_region();
 		}
 
 		std::swap(_rendertarget, _rendertarget2);
@@ -351,9 +325,11 @@ std::shared_ptr<::gs::texture> gfx::blur::gaussian_linear::render()
 
 			auto op = _rendertarget2->render(uint32_t(width), uint32_t(height));
 			gs_ortho(0, 1., 0, 1., 0, 1.);
+			begin_region(uint32_t(width), uint32_t(height), 1., margin);
 			while (gs_effect_loop(effect.get_object(), "Draw")) {
 				streamfx::gs_draw_fullscreen_tri();
 			}
+			end_region();
 		}
 
 		std::swap(_rendertarget, _rendertarget2);
@@ -431,9 +407,11 @@ std::shared_ptr<::gs::texture> gfx::blur::gaussian_linear_directional::render()
 	{
 		auto op = _rendertarget->render(uint32_t(width), uint32_t(height));
 		gs_ortho(0, 1., 0, 1., 0, 1.);
+		begin_region(uint32_t(width), uint32_t(height), 1., 0.);
 		while (gs_effect_loop(effect.get_object(), "Draw")) {
 			streamfx::gs_draw_fullscreen_tri();
 		}
+		end_region();
 	}
 
 	gs_blend_state_pop();
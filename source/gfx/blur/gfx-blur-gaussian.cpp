@@ -16,6 +16,7 @@
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
 
 #include "gfx-blur-gaussian.hpp"
+#include <algorithm>
 #include <stdexcept>
 #include "obs/gs/gs-helper.hpp"
 #include "plugin.hpp"
@@ -48,32 +49,7 @@ gfx::blur::gaussian_data::gaussian_data()
 
 	// Precalculate Kernels
 	for (std::size_t kernel_size = 1; kernel_size <= MAX_BLUR_SIZE; kernel_size++) {
-		std::vector<double_t> kernel_math(MAX_KERNEL_SIZE);
-		std::vector<float_t>  kernel_data(MAX_KERNEL_SIZE);
-		double_t              actual_width = 1.;
-
-		// Find actual kernel width.
-		for (double_t h = SEARCH_DENSITY; h < SEARCH_RANGE; h += SEARCH_DENSITY) {
-			if (util::math::gaussian<double_t>(double_t(kernel_size + SEARCH_EXTENSION), h) > SEARCH_THRESHOLD) {
-				actual_width = h;
-				break;
-			}
-		}
-
-		// Calculate and normalize
-		double_t sum = 0;
-		for (std::size_t p = 0; p <= kernel_size; p++) {
-			kernel_math[p] = util::math::gaussian<double_t>(double_t(p), actual_width);
-			sum += kernel_math[p] * (p > 0 ? 2 : 1);
-		}
-
-		// Normalize to fill the entire 0..1 range over the width.
-		double_t inverse_sum = 1.0 / sum;
-		for (std::size_t p = 0; p <= kernel_size; p++) {
-			kernel_data.at(p) = float_t(kernel_math[p] * inverse_sum);
-		}
-
-		_kernels.push_back(std::move(kernel_data));
+		_kernels.push_back(generate_kernel(kernel_size));
 	}
 }
 
@@ -98,6 +74,38 @@ std::vector<float_t> const& gfx::blur::gaussian_data::get_kernel(std::size_t wid
 	return _kernels[width];
 }
 
+std::vector<float_t> gfx::blur::gaussian_data::generate_kernel(std::size_t width)
+{
+	width = std::clamp<std::size_t>(width, 1, MAX_BLUR_SIZE);
+
+	std::vector<double_t> kernel_math(MAX_KERNEL_SIZE);
+	std::vector<float_t>  kernel_data(MAX_KERNEL_SIZE);
+	double_t              actual_width = 1.;
+
+	// Find actual kernel width.
+	for (double_t h = SEARCH_DENSITY; h < SEARCH_RANGE; h += SEARCH_DENSITY) {
+		if (util::math::gaussian<double_t>(double_t(width + SEARCH_EXTENSION), h) > SEARCH_THRESHOLD) {
+			actual_width = h;
+			break;
+		}
+	}
+
+	// Calculate and normalize
+	double_t sum = 0;
+	for (std::size_t p = 0; p <= width; p++) {
+		kernel_math[p] = util::math::gaussian<double_t>(double_t(p), actual_width);
+		sum += kernel_math[p] * (p > 0 ? 2 : 1);
+	}
+
+	// Normalize to fill the entire 0..1 range over the width.
+	double_t inverse_sum = 1.0 / sum;
+	for (std::size_t p = 0; p <= width; p++) {
+		kernel_data.at(p) = float_t(kernel_math[p] * inverse_sum);
+	}
+
+	return kernel_data;
+}
+
 gfx::blur::gaussian_factory::gaussian_factory() {}
 
 gfx::blur::gaussian_factory::~gaussian_factory() {}
@@ -308,6 +316,9 @@ std::shared_ptr<::gs::texture> gfx::blur::gaussian::render()
 	float_t width  = float_t(_input_texture->get_width());
 	float_t height = float_t(_input_texture->get_height());
 
+	// The first pass must also cover what the second pass samples, so expand by the full reach of the kernel.
+	double_t margin = _size * std::max(_step_scale.first, _step_scale.second) + 1.;
+
 	// Setup
 	gs_set_cull_mode(GS_NEITHER);
 	gs_enable_color(true, true, true, true);
@@ -338,9 +349,11 @@ std::shared_ptr<::gs::texture> gfx::blur::gaussian::render()
 
 			auto op = _rendertarget2->render(uint32_t(width), uint32_t(height));
 			gs_ortho(0, 1., 0, 1., 0, 1.);
+			begin_region(uint32_t(width), uint32_t(height), 1., margin);
 			while (gs_effect_loop(effect.get_object(), "Draw")) {
 				streamfx::gs_draw_fullscreen_tri();
 			}
+			end_region();
 		}
 
 		std::swap(_rendertarget, _rendertarget2);
@@ -358,9 +371,11 @@ std::shared_ptr<::gs::texture> gfx::blur::gaussian::render()
 
 			auto op = _rendertarget2->render(uint32_t(width), uint32_t(height));
 			gs_ortho(0, 1., 0, 1., 0, 1.);
+			begin_region(uint32_t(width), uint32_t(height), 1., margin);
 			while (gs_effect_loop(effect.get_object(), "Draw")) {
 				streamfx::gs_draw_fullscreen_tri();
 			}
+			end_region();
 		}
 
 		std::swap(_rendertarget, _rendertarget2);
@@ -438,9 +453,11 @@ std::shared_ptr<::gs::texture> gfx::blur::gaussian_directional::render()
 	{
 		auto op = _rendertarget->render(uint32_t(width), uint32_t(height));
 		gs_ortho(0, 1., 0, 1., 0, 1.);
+		begin_region(uint32_t(width), uint32_t(height), 1., 0.);
 		while (gs_effect_loop(effect.get_object(), "Draw")) {
 			streamfx::gs_draw_fullscreen_tri();
 		}
+		end_region();
 	}
 
 	gs_blend_state_pop();
@@ -497,9 +514,11 @@ std::shared_ptr<::gs::texture> gfx::blur::gaussian_rotational::render()
 	{
 		auto op = _rendertarget->render(uint32_t(width), uint32_t(height));
 		gs_ortho(0, 1., 0, 1., 0, 1.);
+		begin_region(uint32_t(width), uint32_t(height), 1., 0.);
 		while (gs_effect_loop(effect.get_object(), "Rotate")) {
 			streamfx::gs_draw_fullscreen_tri();
 		}
+		end_region();
 	}
 
 	gs_blend_state_pop();
@@ -577,9 +596,11 @@ std::shared_ptr<::gs::texture> gfx::blur::gaussian_zoom::render()
 	{
 		auto op = _rendertarget->render(uint32_t(width), uint32_t(height));
 		gs_ortho(0, 1., 0, 1., 0, 1.);
+		begin_region(uint32_t(width), uint32_t(height), 1., 0.);
 		while (gs_effect_loop(effect.get_object(), "Zoom")) {
 			streamfx::gs_draw_fullscreen_tri();
 		}
+		end_region();
 	}
 
 	gs_blend_state_pop();
@@ -37,6 +37,9 @@ namespace gfx {
 			gs::effect get_effect();
 
 			std::vector<float_t> const& get_kernel(std::size_t width);
+
+			// Calculate the normalized kernel for a width, without requiring a graphics context.
+			static std::vector<float_t> generate_kernel(std::size_t width);
 		};
 
 		class gaussian_factory : public ::gfx::blur::ifactory {
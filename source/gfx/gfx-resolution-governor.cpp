@@ -0,0 +1,163 @@
+// Modern effects for a modern Streamer
+// Copyright (C) 2020 Michael Fabian Dirks
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+
+#include "gfx-resolution-governor.hpp"
+#include <algorithm>
+#include "configuration.hpp"
+#include "strings.hpp"
+
+#define KEY_BUDGET "DynamicResolution.Budget"
+
+// Scale changes happen in steps of this factor, at most once per this many frames.
+constexpr float_t  scale_step      = 0.875f;
+constexpr uint32_t cooldown_frames = 30;
+
+// Restore quality only once frames use less than this much of the budget.
+constexpr double_t restore_threshold = 0.75;
+
+gfx::resolution_governor::client::client(std::string name) : _name(name), _minimum(1.0f), _scale(1.0f), _time(0) {}
+
+gfx::resolution_governor::client::~client() {}
+
+void gfx::resolution_governor::client::update(obs_data_t* data)
+{
+	float_t minimum = std::clamp(static_cast<float_t>(obs_data_get_double(data, S_DYNAMICRESOLUTION) / 100.0), 0.1f,
+								 1.0f);
+	_minimum.store(minimum);
+	if (_scale.load() < minimum)
+		_scale.store(minimum);
+}
+
+float_t gfx::resolution_governor::client::scale()
+{
+	return _scale.load();
+}
+
+void gfx::resolution_governor::client::track(std::chrono::nanoseconds time)
+{
+	// Smooth over a few frames so single spikes don't decide anything.
+	_time = _time * 0.9 + static_cast<double_t>(time.count()) * 0.1;
+}
+
+gfx::resolution_governor::resolution_governor() : _lock(), _clients(), _budget(0.8), _frames(0)
+{
+	if (auto config = streamfx::configuration::instance(); config) {
+		auto data = config->get();
+		obs_data_set_default_int(data.get(), KEY_BUDGET, 80);
+		_budget = std::clamp(static_cast<double_t>(obs_data_get_int(data.get(), KEY_BUDGET)) / 100.0, 0.1, 1.0);
+	}
+
+	obs_add_tick_callback(tick_callback, this);
+}
+
+gfx::resolution_governor::~resolution_governor()
+{
+	obs_remove_tick_callback(tick_callback, this);
+}
+
+std::shared_ptr<gfx::resolution_governor::client> gfx::resolution_governor::register_client(std::string name)
+{
+	std::unique_lock<std::mutex> lock(_lock);
+	auto                         instance = std::make_shared<client>(name);
+	_clients.push_back(instance);
+	return instance;
+}
+
+void gfx::resolution_governor::defaults(obs_data_t* data)
+{
+	obs_data_set_default_double(data, S_DYNAMICRESOLUTION, 100.0);
+}
+
+void gfx::resolution_governor::properties(obs_properties_t* props)
+{
+	auto p = obs_properties_add_float_slider(props, S_DYNAMICRESOLUTION, D_TRANSLATE(S_DYNAMICRESOLUTION), 10.0,
+											 100.0, 0.01);
+	obs_property_set_long_description(p, D_TRANSLATE(D_DESC(S_DYNAMICRESOLUTION)));
+	obs_property_float_set_suffix(p, " %");
+}
+
+void gfx::resolution_governor::tick()
+{
+	std::unique_lock<std::mutex> lock(_lock);
+
+	// Forget about clients that no longer exist.
+	_clients.remove_if([](const std::weak_ptr<client>& v) { return v.expired(); });
+	if (_clients.empty() || (++_frames < cooldown_frames))
+		return;
+
+	obs_video_info ovi;
+	if (!obs_get_video_info(&ovi) || (ovi.fps_num == 0))
+		return;
+	double_t interval = 1000000000.0 * static_cast<double_t>(ovi.fps_den) / static_cast<double_t>(ovi.fps_num);
+	double_t load     = static_cast<double_t>(obs_get_average_frame_time_ns()) / (interval * _budget);
+
+	std::shared_ptr<client> target;
+	float_t                 scale = 1.0f;
+	if (load > 1.0) {
+		// Over budget, reduce the resolution of whatever costs the most and can still go lower.
+		for (auto& ptr : _clients) {
+			auto cl = ptr.lock();
+			if (cl && (cl->_scale.load() > cl->_minimum.load()) && (!target || (cl->_time > target->_time)))
+				target = cl;
+		}
+		if (target)
+			scale = std::max(target->_scale.load() * scale_step, target->_minimum.load());
+	} else if (load < restore_threshold) {
+		// Plenty of headroom, restore the client that lost the most first.
+		for (auto& ptr : _clients) {
+			auto cl = ptr.lock();
+			if (cl && (cl->_scale.load() < 1.0f) && (!target || (cl->_scale.load() < target->_scale.load())))
+				target = cl;
+		}
+		if (target)
+			scale = std::min(target->_scale.load() / scale_step, 1.0f);
+	}
+
+	if (target) {
+		DLOG_INFO("Frames take %.0f%% of the render budget, rendering '%s' at %.0f%% resolution.", load * 100.0,
+				  target->_name.c_str(), scale * 100.0f);
+		target->_scale.store(scale);
+		_frames = 0;
+	}
+}
+
+void gfx::resolution_governor::tick_callback(void* ptr, float_t) noexcept
+try {
+	reinterpret_cast<gfx::resolution_governor*>(ptr)->tick();
+} catch (const std::exception& ex) {
+	DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
+} catch (...) {
+	DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
+}
+
+static std::shared_ptr<gfx::resolution_governor> _instance = nullptr;
+
+void gfx::resolution_governor::initialize()
+{
+	if (!_instance)
+		_instance = std::make_shared<gfx::resolution_governor>();
+}
+
+void gfx::resolution_governor::finalize()
+{
+	_instance.reset();
+}
+
+std::shared_ptr<gfx::resolution_governor> gfx::resolution_governor::get()
+{
+	return _instance;
+}
@@ -0,0 +1,87 @@
+// Modern effects for a modern Streamer
+// Copyright (C) 2020 Michael Fabian Dirks
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+
+#pragma once
+#include "common.hpp"
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <string>
+
+namespace gfx {
+	/** Trades render resolution of expensive effects for frame time.
+	 *
+	 * Effects register a client and render at client::scale() times their normal resolution,
+	 * upscaling the result on output. The governor compares the average frame time of OBS against a
+	 * budget (a percentage of the frame interval, "DynamicResolution.Budget" in the configuration)
+	 * and lowers the scale of the most expensive client when the budget is exceeded. Once frames are
+	 * cheap enough again, the most degraded client is restored first.
+	 */
+	class resolution_governor {
+		public:
+		class client {
+			friend class resolution_governor;
+
+			std::string          _name;
+			std::atomic<float_t> _minimum;
+			std::atomic<float_t> _scale;
+			double_t             _time;
+
+			public:
+			client(std::string name);
+			~client();
+
+			// Reads the lowest allowed scale from the settings, 1.0 disables scaling.
+			void update(obs_data_t* data);
+
+			// Current resolution scale, always within [minimum, 1.0].
+			float_t scale();
+
+			// Records the time spent rendering, used to decide which client to scale first.
+			void track(std::chrono::nanoseconds time);
+		};
+
+		private:
+		std::mutex                       _lock;
+		std::list<std::weak_ptr<client>> _clients;
+		double_t                         _budget;
+		uint32_t                         _frames;
+
+		public:
+		resolution_governor();
+		~resolution_governor();
+
+		std::shared_ptr<client> register_client(std::string name);
+
+		static void defaults(obs_data_t* data);
+
+		static void properties(obs_properties_t* props);
+
+		private:
+		void tick();
+
+		static void tick_callback(void* ptr, float_t seconds) noexcept;
+
+		public: // Singleton
+		static void initialize();
+
+		static void finalize();
+
+		static std::shared_ptr<resolution_governor> get();
+	};
+} // namespace gfx
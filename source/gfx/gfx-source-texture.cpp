@@ -19,12 +19,71 @@
 #include <stdexcept>
 #include "obs/gs/gs-helper.hpp"
 
+gfx::source_capture::source_capture(uint32_t width, uint32_t height, gs_color_format format)
+	: _rt(std::make_shared<gs::rendertarget>(format, GS_ZS_NONE)), _texture(), _width(width), _height(height),
+	  _frame(0), _rendering(false)
+{}
+
+gfx::source_capture::~source_capture() {}
+
+std::shared_ptr<gs::texture> gfx::source_capture::render(obs_source_t* source)
+{
+	// Everyone asking during the same video frame gets the same result.
+	uint64_t frame = obs_get_video_frame_time();
+	if (_texture && (_frame == frame)) {
+		return _texture;
+	}
+
+	// A source that ends up capturing itself gets the previous frame instead of recursing.
+	if (_rendering) {
+		return _texture;
+	}
+
+	{
+#ifdef ENABLE_PROFILING
+		auto cctr = gs::debug_marker(gs::debug_color_capture, "gfx::source_capture '%s'", obs_source_get_name(source));
+#endif
+		_rendering = true;
+		try {
+			auto op = _rt->render(_width, _height);
+			vec4 black;
+			vec4_zero(&black);
+			// Render the source at its own size, scaled to the size of the capture.
+			uint32_t width  = obs_source_get_width(source);
+			uint32_t height = obs_source_get_height(source);
+			gs_ortho(0, static_cast<float>(width ? width : _width), 0, static_cast<float_t>(height ? height : _height),
+					 0, 1);
+			gs_clear(GS_CLEAR_COLOR, &black, 0, 0);
+			obs_source_video_render(source);
+		} catch (...) {
+			_rendering = false;
+			throw;
+		}
+		_rendering = false;
+	}
+
+	_rt->get_texture(_texture);
+	_frame = frame;
+	return _texture;
+}
+
+uint32_t gfx::source_capture::get_width()
+{
+	return _width;
+}
+
+uint32_t gfx::source_capture::get_height()
+{
+	return _height;
+}
+
 gfx::source_texture::~source_texture()
 {
 	if (_child && _parent) {
 		obs_source_remove_active_child(_parent->get(), _child->get());
 	}
 
+	_capture.reset();
 	_parent.reset();
 	_child.reset();
 }
@@ -35,7 +94,6 @@ gfx::source_texture::source_texture(obs_source_t* parent)
 		throw std::invalid_argument("_parent must not be null");
 	}
 	_parent = std::make_shared<obs::deprecated_source>(parent, false, false);
-	_rt     = std::make_shared<gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
 }
 
 gfx::source_texture::source_texture(obs_source_t* _source, obs_source_t* _parent) : source_texture(_parent)
@@ -77,7 +135,6 @@ gfx::source_texture::source_texture(std::shared_ptr<obs::deprecated_source> pchi
 	}
 	this->_child  = pchild;
 	this->_parent = pparent;
-	this->_rt     = std::make_shared<gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
 }
 
 gfx::source_texture::source_texture(std::shared_ptr<obs::deprecated_source> _child, obs_source_t* _parent)
@@ -104,6 +161,7 @@ void gfx::source_texture::clear()
 	}
 	_child->clear();
 	_child.reset();
+	_capture.reset();
 }
 
 std::shared_ptr<gs::texture> gfx::source_texture::render(std::size_t width, std::size_t height)
@@ -118,20 +176,68 @@ std::shared_ptr<gs::texture> gfx::source_texture::render(std::size_t width, std:
 		return nullptr;
 	}
 
-	if (_child) {
-#ifdef ENABLE_PROFILING
-		auto cctr =
-			gs::debug_marker(gs::debug_color_capture, "gfx::source_texture '%s'", obs_source_get_name(_child->get()));
-#endif
-		auto op = _rt->render(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
-		vec4 black;
-		vec4_zero(&black);
-		gs_ortho(0, static_cast<float>(width), 0, static_cast<float_t>(height), 0, 1);
-		gs_clear(GS_CLEAR_COLOR, &black, 0, 0);
-		obs_source_video_render(_child->get());
+	if (!_child) {
+		return nullptr;
+	}
+
+	// Switch to the shared capture for the new size, which releases the old one.
+	if (!_capture || (_capture->get_width() != width) || (_capture->get_height() != height)) {
+		if (auto cache = source_capture_cache::get(); cache) {
+			_capture = cache->acquire(_child->get(), static_cast<uint32_t>(width), static_cast<uint32_t>(height),
+									  GS_RGBA);
+		} else {
+			_capture =
+				std::make_shared<source_capture>(static_cast<uint32_t>(width), static_cast<uint32_t>(height), GS_RGBA);
+		}
+	}
+
+	return _capture->render(_child->get());
+}
+
+gfx::source_capture_cache::source_capture_cache() : _lock(), _captures() {}
+
+gfx::source_capture_cache::~source_capture_cache() {}
+
+std::shared_ptr<gfx::source_capture> gfx::source_capture_cache::acquire(obs_source_t* source, uint32_t width,
+																		 uint32_t height, gs_color_format format)
+{
+	std::unique_lock<std::mutex> lock(_lock);
+
+	// Forget about captures nobody uses anymore.
+	for (auto iter = _captures.begin(); iter != _captures.end();) {
+		if (iter->second.expired()) {
+			iter = _captures.erase(iter);
+		} else {
+			iter++;
+		}
 	}
 
-	std::shared_ptr<gs::texture> tex;
-	_rt->get_texture(tex);
-	return tex;
+	key_t key{source, width, height, format};
+	if (auto iter = _captures.find(key); iter != _captures.end()) {
+		if (auto capture = iter->second.lock(); capture) {
+			return capture;
+		}
+	}
+
+	auto capture   = std::make_shared<source_capture>(width, height, format);
+	_captures[key] = capture;
+	return capture;
+}
+
+static std::shared_ptr<gfx::source_capture_cache> _source_capture_cache_instance;
+
+void gfx::source_capture_cache::initialize()
+{
+	if (!_source_capture_cache_instance)
+		_source_capture_cache_instance = std::make_shared<gfx::source_capture_cache>();
+}
+
+void gfx::source_capture_cache::finalize()
+{
+	_source_capture_cache_instance.reset();
+}
+
+std::shared_ptr<gfx::source_capture_cache> gfx::source_capture_cache::get()
+{
+	return _source_capture_cache_instance;
 }
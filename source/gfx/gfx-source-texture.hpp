@@ -18,16 +18,41 @@
 #pragma once
 #include "common.hpp"
 #include <map>
+#include <mutex>
+#include <tuple>
 #include "obs/gs/gs-rendertarget.hpp"
 #include "obs/gs/gs-texture.hpp"
 #include "obs/obs-source.hpp"
 
 namespace gfx {
+	/** A capture of a source at a fixed size and format, rendered at most once per video frame.
+	 *
+	 * Captures are shared by everything that asks for the same source at the same size and format, the texture that
+	 * is handed out must be treated as read-only.
+	 */
+	class source_capture {
+		std::shared_ptr<gs::rendertarget> _rt;
+		std::shared_ptr<gs::texture>      _texture;
+		uint32_t                          _width;
+		uint32_t                          _height;
+		uint64_t                          _frame;
+		bool                              _rendering;
+
+		public:
+		source_capture(uint32_t width, uint32_t height, gs_color_format format);
+		~source_capture();
+
+		std::shared_ptr<gs::texture> render(obs_source_t* source);
+
+		uint32_t get_width();
+		uint32_t get_height();
+	};
+
 	class source_texture {
 		std::shared_ptr<obs::deprecated_source> _parent;
 		std::shared_ptr<obs::deprecated_source> _child;
 
-		std::shared_ptr<gs::rendertarget> _rt;
+		std::shared_ptr<source_capture> _capture;
 
 		source_texture(obs_source_t* parent);
 
@@ -58,37 +83,28 @@ namespace gfx {
 		obs_source_t* get_parent();
 	};
 
-	class source_texture_factory {
-		friend class source_texture;
+	/** Registry of shared source captures, keyed by source, size and format.
+	 *
+	 * Only weak references are kept, a capture is freed as soon as the last source_texture using it lets go of it.
+	 */
+	class source_capture_cache {
+		typedef std::tuple<obs_source_t*, uint32_t, uint32_t, gs_color_format> key_t;
 
-		std::map<std::shared_ptr<obs_weak_source_t>, std::weak_ptr<source_texture>> _cache;
+		std::mutex                                     _lock;
+		std::map<key_t, std::weak_ptr<source_capture>> _captures;
 
 		public:
-		source_texture_factory();
-		~source_texture_factory();
+		source_capture_cache();
+		~source_capture_cache();
 
-		std::shared_ptr<source_texture> get_source_texture(std::shared_ptr<obs_source_t> source);
+		std::shared_ptr<source_capture> acquire(obs_source_t* source, uint32_t width, uint32_t height,
+												gs_color_format format);
 
-		protected:
-		void free_source_texture(std::shared_ptr<obs_source_t> source);
+		public: // Singleton
+		static void initialize();
 
-		private: // Singleton
-		static std::shared_ptr<source_texture_factory> factory_instance;
+		static void finalize();
 
-		public: // Singleton
-		static void initialize()
-		{
-			factory_instance = std::make_shared<source_texture_factory>();
-		}
-
-		static void finalize()
-		{
-			factory_instance.reset();
-		}
-
-		static std::shared_ptr<source_texture_factory> get()
-		{
-			return factory_instance;
-		}
+		static std::shared_ptr<source_capture_cache> get();
 	};
 } // namespace gfx
@@ -0,0 +1,349 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "gfx-lut-baker.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <thread>
+
+#include "obs/gs/gs-helper.hpp"
+#include "plugin.hpp"
+
+#define LOCAL_PREFIX "<gfx::lut::baker> "
+
+// Workers a single bake is split across, including the thread that runs it. Enough to bake a LUT in a fraction of the
+// time, while leaving the rest of the thread pool to encoders and other filters.
+#define MAXIMUM_WORKERS 4
+
+static inline uint32_t encode_unorm(float value, uint32_t maximum)
+{
+	value = std::clamp(value, 0.f, 1.f);
+	return static_cast<uint32_t>(value * static_cast<float>(maximum) + .5f);
+}
+
+static size_t stride_from_format(gs_color_format format)
+{
+	switch (format) {
+	case GS_RGBA:
+	case GS_R10G10B10A2:
+		return 4;
+	case GS_RGBA16:
+		return 8;
+	default:
+		throw std::runtime_error("Unsupported LUT color depth.");
+	}
+}
+
+static void encode(gs_color_format format, const float* red, const float* green, const float* blue, size_t count,
+				   uint8_t* output)
+{
+	if (format == GS_RGBA) {
+		for (size_t idx = 0; idx < count; idx++) {
+			output[idx * 4 + 0] = static_cast<uint8_t>(encode_unorm(red[idx], 255));
+			output[idx * 4 + 1] = static_cast<uint8_t>(encode_unorm(green[idx], 255));
+			output[idx * 4 + 2] = static_cast<uint8_t>(encode_unorm(blue[idx], 255));
+			output[idx * 4 + 3] = 255;
+		}
+	} else if (format == GS_R10G10B10A2) {
+		uint32_t* output32 = reinterpret_cast<uint32_t*>(output);
+		for (size_t idx = 0; idx < count; idx++) {
+			output32[idx] = encode_unorm(red[idx], 1023) | (encode_unorm(green[idx], 1023) << 10)
+							| (encode_unorm(blue[idx], 1023) << 20) | (3u << 30);
+		}
+	} else {
+		uint16_t* output16 = reinterpret_cast<uint16_t*>(output);
+		for (size_t idx = 0; idx < count; idx++) {
+			output16[idx * 4 + 0] = static_cast<uint16_t>(encode_unorm(red[idx], 65535));
+			output16[idx * 4 + 1] = static_cast<uint16_t>(encode_unorm(green[idx], 65535));
+			output16[idx * 4 + 2] = static_cast<uint16_t>(encode_unorm(blue[idx], 65535));
+			output16[idx * 4 + 3] = 65535;
+		}
+	}
+}
+
+gfx::lut::baked::baked(gfx::lut::color_depth depth, gfx::lut::layout layout)
+	: _depth(depth), _layout(layout), _lock(), _ready(false), _failed(false), _buffer(), _texture()
+{}
+
+gfx::lut::baked::~baked() {}
+
+gfx::lut::color_depth gfx::lut::baked::depth()
+{
+	return _depth;
+}
+
+gfx::lut::layout gfx::lut::baked::layout()
+{
+	return _layout;
+}
+
+bool gfx::lut::baked::ready()
+{
+	return _ready.load(std::memory_order_acquire);
+}
+
+bool gfx::lut::baked::failed()
+{
+	return _failed.load(std::memory_order_acquire);
+}
+
+std::shared_ptr<gs::texture> gfx::lut::baked::texture()
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	if (!_texture && ready()) {
+		auto gctx = gs::context();
+
+		uint32_t       samples = static_cast<uint32_t>(samples_from_depth(_depth, _layout));
+		const uint8_t* data    = _buffer.data();
+
+		if (_layout == gfx::lut::layout::Volume) {
+			_texture = std::make_shared<gs::texture>(samples, samples, samples, format_from_depth(_depth), 1, &data,
+													 gs::texture::flags::None);
+		} else {
+			uint32_t container_size = samples << (static_cast<int32_t>(_depth) / 2);
+			_texture = std::make_shared<gs::texture>(container_size, container_size, format_from_depth(_depth), 1,
+													 &data, gs::texture::flags::None);
+		}
+
+		// The CPU copy is no longer needed once the GPU has it.
+		_buffer.clear();
+		_buffer.shrink_to_fit();
+	}
+
+	return _texture;
+}
+
+std::shared_ptr<gfx::lut::baker> gfx::lut::baker::instance()
+{
+	static std::weak_ptr<gfx::lut::baker> _instance;
+	static std::mutex                     _mutex;
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	auto reference = _instance.lock();
+	if (!reference) {
+		reference = std::shared_ptr<gfx::lut::baker>(new gfx::lut::baker());
+		_instance = reference;
+	}
+	return reference;
+}
+
+gfx::lut::baker::baker() : _lock(), _cache(), _queue(), _busy(false) {}
+
+gfx::lut::baker::~baker() {}
+
+std::shared_ptr<gfx::lut::baked> gfx::lut::baker::acquire(uint64_t key, gfx::lut::color_depth depth,
+														  gfx::lut::layout layout, transform_t transform)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	// Forget about LUTs nobody uses anymore.
+	for (auto iter = _cache.begin(); iter != _cache.end();) {
+		if (iter->second.expired()) {
+			iter = _cache.erase(iter);
+		} else {
+			++iter;
+		}
+	}
+
+	if (auto iter = _cache.find({key, depth, layout}); iter != _cache.end()) {
+		if (auto reference = iter->second.lock(); reference) {
+			return reference;
+		}
+	}
+
+	// Requests that were replaced before their turn came are never baked.
+	_queue.remove_if([](job const& queued) { return queued.target.expired(); });
+
+	auto reference               = std::make_shared<gfx::lut::baked>(depth, layout);
+	_cache[{key, depth, layout}] = reference;
+	_queue.push_back({reference, transform});
+
+	if (!_busy) {
+		_busy = true;
+		streamfx::threadpool()->push([self = instance()](std::shared_ptr<void>) { self->run(); }, nullptr);
+	}
+
+	return reference;
+}
+
+void gfx::lut::baker::run()
+{
+	while (true) {
+		std::weak_ptr<gfx::lut::baked> target;
+		transform_t                    transform;
+		gfx::lut::color_depth          depth;
+		gfx::lut::layout               layout;
+		{
+			std::lock_guard<std::mutex>      lock(_lock);
+			std::shared_ptr<gfx::lut::baked> reference;
+			while (!reference && !_queue.empty()) {
+				reference = _queue.front().target.lock();
+				transform = _queue.front().transform;
+				_queue.pop_front();
+			}
+			if (!reference) {
+				_busy = false;
+				return;
+			}
+
+			target = reference;
+			depth  = reference->_depth;
+			layout = reference->_layout;
+		}
+
+		// Only the weak reference is held while baking, so that replacing the LUT also abandons the bake.
+		try {
+			std::vector<uint8_t> buffer;
+			if (!bake(depth, layout, transform, buffer, [&target]() { return target.expired(); }))
+				continue;
+
+			if (auto reference = target.lock(); reference) {
+				{
+					std::lock_guard<std::mutex> lock(reference->_lock);
+					reference->_buffer.swap(buffer);
+				}
+				reference->_ready.store(true, std::memory_order_release);
+			}
+		} catch (std::exception const& ex) {
+			if (auto reference = target.lock(); reference) {
+				reference->_failed.store(true, std::memory_order_release);
+			}
+			DLOG_ERROR(LOCAL_PREFIX "Failed to bake LUT: %s", ex.what());
+		}
+	}
+}
+
+bool gfx::lut::baker::bake(gfx::lut::color_depth depth, gfx::lut::layout layout, transform_t transform,
+						   std::vector<uint8_t>& buffer, std::function<bool()> abort)
+{
+	gs_color_format format  = format_from_depth(depth);
+	size_t          stride  = stride_from_format(format);
+	size_t          samples = samples_from_depth(depth, layout);
+	float           inverse = 1.f / static_cast<float>(samples - 1);
+
+	if (layout == gfx::lut::layout::Volume) {
+		buffer.resize(samples * samples * samples * stride);
+
+		// Each blue slice is one batch.
+		return parallel(
+			samples,
+			[&](size_t b) {
+				std::vector<float> red(samples * samples), green(samples * samples), blue(samples * samples);
+				for (size_t g = 0; g < samples; g++) {
+					for (size_t r = 0; r < samples; r++) {
+						red[g * samples + r]   = static_cast<float>(r) * inverse;
+						green[g * samples + r] = static_cast<float>(g) * inverse;
+						blue[g * samples + r]  = static_cast<float>(b) * inverse;
+					}
+				}
+
+				transform(red.data(), green.data(), blue.data(), samples * samples);
+				encode(format, red.data(), green.data(), blue.data(), samples * samples,
+					   buffer.data() + b * samples * samples * stride);
+			},
+			abort);
+	} else {
+		size_t grid_size      = size_t(1) << (static_cast<int32_t>(depth) / 2);
+		size_t container_size = samples * grid_size;
+		buffer.resize(container_size * container_size * stride);
+
+		// Each row of the texture is one batch, which keeps the transform busy with long runs of independent colors.
+		return parallel(
+			container_size,
+			[&](size_t y) {
+				std::vector<float> red(container_size), green(container_size), blue(container_size);
+				for (size_t x = 0; x < container_size; x++) {
+					red[x]   = static_cast<float>(x % samples) * inverse;
+					green[x] = static_cast<float>(y % samples) * inverse;
+					blue[x]  = static_cast<float>((y / samples) * grid_size + (x / samples)) * inverse;
+				}
+
+				transform(red.data(), green.data(), blue.data(), container_size);
+				encode(format, red.data(), green.data(), blue.data(), container_size,
+					   buffer.data() + y * container_size * stride);
+			},
+			abort);
+	}
+}
+
+bool gfx::lut::baker::parallel(size_t batches, std::function<void(size_t)> batch, std::function<bool()> abort)
+{
+	// Shared with the workers, as a worker may only start once all batches have been taken by the others.
+	struct state_t {
+		std::function<void(size_t)> batch;
+		std::function<bool()>       abort;
+		size_t                      batches;
+		std::atomic<size_t>         next;
+		std::atomic<bool>           aborted;
+		std::mutex                  lock;
+		std::condition_variable     signal;
+		size_t                      finished;
+		std::exception_ptr          error;
+	};
+	auto state      = std::make_shared<state_t>();
+	state->batch    = batch;
+	state->abort    = abort;
+	state->batches  = batches;
+	state->next     = 0;
+	state->aborted  = false;
+	state->finished = 0;
+
+	// Take batches until none are left. Skipped batches count as finished too, so that only the batches that are
+	// still running have to be waited for.
+	auto work = [](state_t& state) {
+		for (size_t idx = state.next.fetch_add(1); idx < state.batches; idx = state.next.fetch_add(1)) {
+			if (!state.aborted && state.abort && state.abort())
+				state.aborted = true;
+
+			if (!state.aborted) {
+				try {
+					state.batch(idx);
+				} catch (...) {
+					std::lock_guard<std::mutex> lock(state.lock);
+					if (!state.error)
+						state.error = std::current_exception();
+					state.aborted = true;
+				}
+			}
+
+			std::lock_guard<std::mutex> lock(state.lock);
+			if (++state.finished == state.batches)
+				state.signal.notify_all();
+		}
+	};
+
+	// The calling thread works as well, so a busy thread pool only makes the bake slower, never stalls it.
+	size_t workers = std::clamp<size_t>(std::thread::hardware_concurrency() / 2, 1, MAXIMUM_WORKERS);
+	if (auto pool = streamfx::threadpool(); pool) {
+		for (size_t idx = 1; idx < std::min(workers, batches); idx++) {
+			pool->push([state, work](std::shared_ptr<void>) { work(*state); }, nullptr);
+		}
+	}
+	work(*state);
+
+	std::unique_lock<std::mutex> lock(state->lock);
+	state->signal.wait(lock, [&state]() { return state->finished == state->batches; });
+	if (state->error)
+		std::rethrow_exception(state->error);
+	return !state->aborted;
+}
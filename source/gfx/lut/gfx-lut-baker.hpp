@@ -0,0 +1,127 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+#include <atomic>
+#include <cinttypes>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#include "gfx-lut-cube.hpp"
+#include "gfx-lut.hpp"
+#include "obs/gs/gs-texture.hpp"
+
+namespace gfx::lut {
+	class baker;
+
+	/** A LUT texture that is baked on the CPU and uploaded once it is complete.
+	 *
+	 * Instances are shared between all users that requested the same key, depth and layout.
+	 */
+	class baked {
+		gfx::lut::color_depth        _depth;
+		gfx::lut::layout             _layout;
+		std::mutex                   _lock;
+		std::atomic<bool>            _ready;
+		std::atomic<bool>            _failed;
+		std::vector<uint8_t>         _buffer;
+		std::shared_ptr<gs::texture> _texture;
+
+		public:
+		baked(gfx::lut::color_depth depth, gfx::lut::layout layout);
+		~baked();
+
+		gfx::lut::color_depth depth();
+
+		gfx::lut::layout layout();
+
+		bool ready();
+
+		bool failed();
+
+		/** Retrieve the texture, uploading it on first use. Must be called from the graphics thread. */
+		std::shared_ptr<gs::texture> texture();
+
+		friend class gfx::lut::baker;
+	};
+
+	/** Bakes LUTs one after another, each split into batches that a few thread pool workers work through together.
+	 *
+	 * A bake is outdated as soon as nobody holds its result anymore, for example because a filter requested a newer
+	 * grade. Outdated bakes are dropped from the queue, or aborted between two batches if they are already running.
+	 */
+	class baker {
+		typedef std::tuple<uint64_t, gfx::lut::color_depth, gfx::lut::layout> key_t;
+
+		struct job {
+			std::weak_ptr<gfx::lut::baked> target;
+			transform_t                    transform;
+		};
+
+		std::mutex                                       _lock;
+		std::map<key_t, std::weak_ptr<gfx::lut::baked>> _cache;
+		std::list<job>                                   _queue;
+		bool                                             _busy;
+
+		public:
+		static std::shared_ptr<gfx::lut::baker> instance();
+
+		private:
+		baker();
+
+		public:
+		~baker();
+
+		/** Retrieve the LUT for a key, queueing a bake with the given transform if nobody holds it yet.
+		 *
+		 * The key must uniquely identify the transform, e.g. a hash of all settings that feed into it.
+		 */
+		std::shared_ptr<gfx::lut::baked> acquire(uint64_t key, gfx::lut::color_depth depth, gfx::lut::layout layout,
+												 transform_t transform);
+
+		/** Bake a transform into the texture layout expected by gfx::lut::consumer.
+		 *
+		 * \param abort Checked between batches, the bake is abandoned once it returns true.
+		 * \return false if the bake was abandoned.
+		 */
+		static bool bake(gfx::lut::color_depth depth, gfx::lut::layout layout, transform_t transform,
+						 std::vector<uint8_t>& buffer, std::function<bool()> abort = nullptr);
+
+		/** Call a function once for every batch, on the calling thread and on up to a few thread pool workers.
+		 *
+		 * Batches must be independent of each other. Returns once every batch has finished, rethrowing the first
+		 * exception a batch threw.
+		 *
+		 * \param abort Checked before every batch and possibly from several threads at once, the remaining batches
+		 *              are skipped once it returns true.
+		 * \return false if batches were skipped.
+		 */
+		static bool parallel(size_t batches, std::function<void(size_t)> batch, std::function<bool()> abort = nullptr);
+
+		private:
+		// Work through the queue until it is empty. Only one call runs at a time.
+		void run();
+	};
+} // namespace gfx::lut
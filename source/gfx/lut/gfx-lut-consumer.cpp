@@ -22,7 +22,7 @@
 
 #include "obs/gs/gs-helper.hpp"
 
-gfx::lut::consumer::consumer()
+gfx::lut::consumer::consumer() : _technique("Draw")
 {
 	_data = gfx::lut::data::instance();
 	if (!_data->consumer_effect())
@@ -31,12 +31,28 @@ gfx::lut::consumer::consumer()
 
 gfx::lut::consumer::~consumer() {}
 
-std::shared_ptr<gs::effect> gfx::lut::consumer::prepare(gfx::lut::color_depth depth, std::shared_ptr<gs::texture> lut)
+std::shared_ptr<gs::effect> gfx::lut::consumer::prepare(gfx::lut::color_depth depth, std::shared_ptr<gs::texture> lut,
+														gfx::lut::interpolation mode)
 {
 	auto gctx = gs::context();
 
 	auto effect = _data->consumer_effect();
 
+	if (lut->get_type() == gs::texture::type::Volume) {
+		float samples = static_cast<float>(lut->get_width());
+
+		if (gs::effect_parameter efp = effect->get_parameter("lut_params_1"); efp) {
+			efp.set_float4(samples - 1.f, 1.f / samples, .5f / samples, 0.f);
+		}
+
+		if (gs::effect_parameter efp = effect->get_parameter("lut_volume"); efp) {
+			efp.set_texture(lut);
+		}
+
+		_technique = (mode == gfx::lut::interpolation::Tetrahedral) ? "DrawVolumeTetrahedral" : "DrawVolume";
+		return effect;
+	}
+
 	int32_t idepth         = static_cast<int32_t>(depth);
 	int32_t size           = static_cast<int32_t>(pow(2l, idepth));
 	int32_t grid_size      = static_cast<int32_t>(pow(2l, (idepth / 2)));
@@ -58,22 +74,28 @@ std::shared_ptr<gs::effect> gfx::lut::consumer::prepare(gfx::lut::color_depth de
 		efp.set_texture(lut);
 	}
 
+	_technique = "Draw";
 	return effect;
 }
 
+const char* gfx::lut::consumer::technique()
+{
+	return _technique;
+}
+
 void gfx::lut::consumer::consume(gfx::lut::color_depth depth, std::shared_ptr<gs::texture> lut,
-								 std::shared_ptr<gs::texture> texture)
+								 std::shared_ptr<gs::texture> texture, gfx::lut::interpolation mode)
 {
 	auto gctx = gs::context();
 
-	auto effect = prepare(depth, lut);
+	auto effect = prepare(depth, lut, mode);
 
 	if (gs::effect_parameter efp = effect->get_parameter("image"); efp) {
 		efp.set_texture(texture->get_object());
 	}
 
 	// Draw a simple quad.
-	while (gs_effect_loop(effect->get_object(), "Draw")) {
+	while (gs_effect_loop(effect->get_object(), _technique)) {
 		gs_draw_sprite(nullptr, 0, 1, 1);
 	}
 }
@@ -28,14 +28,24 @@
 namespace gfx::lut {
 	class consumer {
 		std::shared_ptr<gfx::lut::data> _data;
+		const char*                     _technique;
 
 		public:
 		consumer();
 		~consumer();
 
-		std::shared_ptr<gs::effect> prepare(gfx::lut::color_depth depth, std::shared_ptr<gs::texture> lut);
+		/** Set up the consumer effect for a LUT, which may be either a tiled 2D texture or a 3D texture.
+		 *
+		 * Tetrahedral interpolation is only available for 3D textures, tiled LUTs always use trilinear.
+		 */
+		std::shared_ptr<gs::effect> prepare(gfx::lut::color_depth depth, std::shared_ptr<gs::texture> lut,
+											gfx::lut::interpolation mode = gfx::lut::interpolation::Trilinear);
+
+		/** Technique to draw with after the last call to prepare(). */
+		const char* technique();
 
 		void consume(gfx::lut::color_depth depth, std::shared_ptr<gs::texture> lut,
-					 std::shared_ptr<gs::texture> texture);
+					 std::shared_ptr<gs::texture> texture,
+					 gfx::lut::interpolation mode = gfx::lut::interpolation::Trilinear);
 	};
 } // namespace gfx::lut
@@ -0,0 +1,252 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "gfx-lut-cube.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <locale>
+#include <sstream>
+#include <stdexcept>
+
+#include "gfx-lut-baker.hpp"
+
+static inline float mix(float a, float b, float t)
+{
+	return a + (b - a) * t;
+}
+
+gfx::lut::cube::cube(size_t size)
+	: _title(), _size(size), _domain_min{0., 0., 0.}, _domain_max{1., 1., 1.}, _data(size * size * size * 3)
+{
+	if (size < 2) {
+		throw std::invalid_argument("LUT size must be at least 2.");
+	}
+}
+
+gfx::lut::cube::~cube() {}
+
+size_t gfx::lut::cube::size()
+{
+	return _size;
+}
+
+std::string gfx::lut::cube::title()
+{
+	return _title;
+}
+
+void gfx::lut::cube::set_title(std::string title)
+{
+	_title = title;
+}
+
+float* gfx::lut::cube::data()
+{
+	return _data.data();
+}
+
+float* gfx::lut::cube::at(size_t red, size_t green, size_t blue)
+{
+	return _data.data() + ((blue * _size + green) * _size + red) * 3;
+}
+
+void gfx::lut::cube::sample(float* red, float* green, float* blue, size_t count, gfx::lut::interpolation mode)
+{
+	float* channels[3] = {red, green, blue};
+	float  scale       = static_cast<float>(_size - 1);
+
+	for (size_t idx = 0; idx < count; idx++) {
+		size_t lo[3];
+		size_t hi[3];
+		float  frac[3];
+		for (size_t ch = 0; ch < 3; ch++) {
+			float range = _domain_max[ch] - _domain_min[ch];
+			float v     = (channels[ch][idx] - _domain_min[ch]) / (range != 0. ? range : 1.f);
+			v           = std::clamp(v, 0.f, 1.f) * scale;
+			lo[ch]      = std::min(static_cast<size_t>(v), _size - 1);
+			hi[ch]      = std::min(lo[ch] + 1, _size - 1);
+			frac[ch]    = v - static_cast<float>(lo[ch]);
+		}
+
+		if (mode == gfx::lut::interpolation::Tetrahedral) {
+			// Walk from the lowest to the highest corner along the axes in order of their fraction.
+			size_t order[3] = {0, 1, 2};
+			std::sort(order, order + 3, [&frac](size_t a, size_t b) { return frac[a] > frac[b]; });
+
+			size_t corner[3] = {lo[0], lo[1], lo[2]};
+			float* c0        = at(corner[0], corner[1], corner[2]);
+			corner[order[0]] = hi[order[0]];
+			float* c1        = at(corner[0], corner[1], corner[2]);
+			corner[order[1]] = hi[order[1]];
+			float* c2        = at(corner[0], corner[1], corner[2]);
+			float* c3        = at(hi[0], hi[1], hi[2]);
+
+			float w0 = 1.f - frac[order[0]];
+			float w1 = frac[order[0]] - frac[order[1]];
+			float w2 = frac[order[1]] - frac[order[2]];
+			float w3 = frac[order[2]];
+			for (size_t ch = 0; ch < 3; ch++) {
+				channels[ch][idx] = c0[ch] * w0 + c1[ch] * w1 + c2[ch] * w2 + c3[ch] * w3;
+			}
+			continue;
+		}
+
+		for (size_t ch = 0; ch < 3; ch++) {
+			float c00 = mix(at(lo[0], lo[1], lo[2])[ch], at(hi[0], lo[1], lo[2])[ch], frac[0]);
+			float c10 = mix(at(lo[0], hi[1], lo[2])[ch], at(hi[0], hi[1], lo[2])[ch], frac[0]);
+			float c01 = mix(at(lo[0], lo[1], hi[2])[ch], at(hi[0], lo[1], hi[2])[ch], frac[0]);
+			float c11 = mix(at(lo[0], hi[1], hi[2])[ch], at(hi[0], hi[1], hi[2])[ch], frac[0]);
+			float c0  = mix(c00, c10, frac[1]);
+			float c1  = mix(c01, c11, frac[1]);
+
+			channels[ch][idx] = mix(c0, c1, frac[2]);
+		}
+	}
+}
+
+std::shared_ptr<gfx::lut::cube> gfx::lut::cube::bake(size_t size, transform_t transform)
+{
+	auto  lut     = std::make_shared<gfx::lut::cube>(size);
+	float inverse = 1.f / static_cast<float>(size - 1);
+
+	// Each blue slice is one batch.
+	gfx::lut::baker::parallel(size, [&](size_t b) {
+		std::vector<float> red(size * size), green(size * size), blue(size * size);
+		for (size_t g = 0; g < size; g++) {
+			for (size_t r = 0; r < size; r++) {
+				red[g * size + r]   = static_cast<float>(r) * inverse;
+				green[g * size + r] = static_cast<float>(g) * inverse;
+				blue[g * size + r]  = static_cast<float>(b) * inverse;
+			}
+		}
+
+		transform(red.data(), green.data(), blue.data(), size * size);
+
+		float* slice = lut->at(0, 0, b);
+		for (size_t idx = 0; idx < size * size; idx++) {
+			slice[idx * 3 + 0] = red[idx];
+			slice[idx * 3 + 1] = green[idx];
+			slice[idx * 3 + 2] = blue[idx];
+		}
+	});
+
+	return lut;
+}
+
+std::shared_ptr<gfx::lut::cube> gfx::lut::cube::load(std::filesystem::path file)
+{
+	std::ifstream stream(file);
+	if (!stream.is_open()) {
+		throw std::runtime_error("Failed to open LUT file.");
+	}
+	stream.imbue(std::locale::classic());
+
+	std::shared_ptr<gfx::lut::cube> lut;
+	std::string                     title;
+	float                           domain_min[3] = {0., 0., 0.};
+	float                           domain_max[3] = {1., 1., 1.};
+	size_t                          entries       = 0;
+
+	for (std::string line; std::getline(stream, line);) {
+		// Skip empty lines and comments.
+		if (auto pos = line.find_first_not_of(" \t\r"); (pos == std::string::npos) || (line[pos] == '#')) {
+			continue;
+		}
+
+		std::istringstream tokens(line);
+		tokens.imbue(std::locale::classic());
+
+		std::string keyword;
+		tokens >> keyword;
+		if (keyword == "TITLE") {
+			auto first = line.find('"');
+			auto last  = line.rfind('"');
+			if ((first != std::string::npos) && (last > first)) {
+				title = line.substr(first + 1, last - first - 1);
+			}
+		} else if (keyword == "LUT_3D_SIZE") {
+			size_t size = 0;
+			if (!(tokens >> size) || (size < 2) || (size > 256)) {
+				throw std::runtime_error("LUT file has an invalid size.");
+			}
+			lut = std::make_shared<gfx::lut::cube>(size);
+		} else if (keyword == "LUT_1D_SIZE") {
+			throw std::runtime_error("1D LUT files are not supported.");
+		} else if (keyword == "DOMAIN_MIN") {
+			tokens >> domain_min[0] >> domain_min[1] >> domain_min[2];
+		} else if (keyword == "DOMAIN_MAX") {
+			tokens >> domain_max[0] >> domain_max[1] >> domain_max[2];
+		} else if (keyword == "LUT_3D_INPUT_RANGE") {
+			float lo = 0., hi = 1.;
+			tokens >> lo >> hi;
+			domain_min[0] = domain_min[1] = domain_min[2] = lo;
+			domain_max[0] = domain_max[1] = domain_max[2] = hi;
+		} else if (lut) {
+			if (entries >= lut->_data.size()) {
+				throw std::runtime_error("LUT file has too many entries.");
+			}
+
+			tokens.clear();
+			tokens.seekg(0);
+			float* entry = lut->_data.data() + entries;
+			if (!(tokens >> entry[0] >> entry[1] >> entry[2])) {
+				throw std::runtime_error("LUT file contains an invalid entry.");
+			}
+			entries += 3;
+		} else {
+			throw std::runtime_error("LUT file has entries before its size.");
+		}
+	}
+
+	if (!lut || (entries != lut->_data.size())) {
+		throw std::runtime_error("LUT file is incomplete.");
+	}
+
+	lut->_title = title;
+	std::copy(domain_min, domain_min + 3, lut->_domain_min);
+	std::copy(domain_max, domain_max + 3, lut->_domain_max);
+	return lut;
+}
+
+void gfx::lut::cube::save(std::filesystem::path file)
+{
+	std::ofstream stream(file, std::ios::out | std::ios::trunc);
+	if (!stream.is_open()) {
+		throw std::runtime_error("Failed to create LUT file.");
+	}
+	stream.imbue(std::locale::classic());
+	stream.setf(std::ios::fixed);
+	stream.precision(6);
+
+	if (!_title.empty()) {
+		stream << "TITLE \"" << _title << "\"\n";
+	}
+	stream << "LUT_3D_SIZE " << _size << "\n";
+	stream << "DOMAIN_MIN " << _domain_min[0] << " " << _domain_min[1] << " " << _domain_min[2] << "\n";
+	stream << "DOMAIN_MAX " << _domain_max[0] << " " << _domain_max[1] << " " << _domain_max[2] << "\n";
+	for (size_t idx = 0; idx < _data.size(); idx += 3) {
+		stream << _data[idx + 0] << " " << _data[idx + 1] << " " << _data[idx + 2] << "\n";
+	}
+
+	if (!stream.good()) {
+		throw std::runtime_error("Failed to write LUT file.");
+	}
+}
@@ -0,0 +1,74 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+#include <cinttypes>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gfx-lut.hpp"
+
+namespace gfx::lut {
+	/** Color transform applied in place to a batch of colors stored as separate red, green and blue arrays.
+	 *
+	 * Batches are laid out as structure-of-arrays so that simple per-channel math can be vectorized by the compiler.
+	 */
+	typedef std::function<void(float* red, float* green, float* blue, size_t count)> transform_t;
+
+	/** CPU side 3D look-up table as used by the '.cube' format.
+	 *
+	 * Entries are stored as RGB triplets with red changing fastest, then green, then blue.
+	 */
+	class cube {
+		std::string        _title;
+		size_t             _size;
+		float              _domain_min[3];
+		float              _domain_max[3];
+		std::vector<float> _data;
+
+		public:
+		cube(size_t size);
+		~cube();
+
+		size_t size();
+
+		std::string title();
+
+		void set_title(std::string title);
+
+		float* data();
+
+		float* at(size_t red, size_t green, size_t blue);
+
+		/** Transform a batch of colors through the table. */
+		void sample(float* red, float* green, float* blue, size_t count,
+					gfx::lut::interpolation mode = gfx::lut::interpolation::Trilinear);
+
+		/** Evaluate a transform at every grid point of a new table, spread over worker threads. */
+		static std::shared_ptr<gfx::lut::cube> bake(size_t size, transform_t transform);
+
+		static std::shared_ptr<gfx::lut::cube> load(std::filesystem::path file);
+
+		void save(std::filesystem::path file);
+	};
+} // namespace gfx::lut
@@ -22,24 +22,6 @@
 
 #include "obs/gs/gs-helper.hpp"
 
-gs_color_format format_from_depth(gfx::lut::color_depth depth)
-{
-	switch (depth) {
-	case gfx::lut::color_depth::_2:
-	case gfx::lut::color_depth::_4:
-	case gfx::lut::color_depth::_6:
-	case gfx::lut::color_depth::_8:
-		return gs_color_format::GS_RGBA;
-	case gfx::lut::color_depth::_10:
-		return gs_color_format::GS_R10G10B10A2;
-	case gfx::lut::color_depth::_12:
-	case gfx::lut::color_depth::_14:
-	case gfx::lut::color_depth::_16:
-		return gs_color_format::GS_RGBA16;
-	}
-	return GS_RGBA32F;
-}
-
 gfx::lut::producer::producer()
 {
 	_data = gfx::lut::data::instance();
@@ -20,6 +20,7 @@
 
 #include "gfx-lut.hpp"
 
+#include <algorithm>
 #include <mutex>
 
 #include "obs/gs/gs-helper.hpp"
@@ -73,3 +74,30 @@ gfx::lut::data::~data()
 	_producer_effect.reset();
 	_consumer_effect.reset();
 }
+
+gs_color_format gfx::lut::format_from_depth(gfx::lut::color_depth depth)
+{
+	switch (depth) {
+	case gfx::lut::color_depth::_2:
+	case gfx::lut::color_depth::_4:
+	case gfx::lut::color_depth::_6:
+	case gfx::lut::color_depth::_8:
+		return gs_color_format::GS_RGBA;
+	case gfx::lut::color_depth::_10:
+		return gs_color_format::GS_R10G10B10A2;
+	case gfx::lut::color_depth::_12:
+	case gfx::lut::color_depth::_14:
+	case gfx::lut::color_depth::_16:
+		return gs_color_format::GS_RGBA16;
+	}
+	return GS_RGBA32F;
+}
+
+size_t gfx::lut::samples_from_depth(gfx::lut::color_depth depth, gfx::lut::layout layout)
+{
+	size_t samples = size_t(1) << static_cast<int32_t>(depth);
+	if (layout == gfx::lut::layout::Volume) {
+		return std::min<size_t>(samples, 64);
+	}
+	return samples;
+}
@@ -59,4 +59,23 @@ namespace gfx::lut {
 		_14     = 14,
 		_16     = 16,
 	};
+
+	enum class layout {
+		Tiled,  // 2D texture with blue slices placed in a grid, see lut.effect.
+		Volume, // 3D texture.
+	};
+
+	enum class interpolation {
+		Trilinear,
+		Tetrahedral, // Volume layout only.
+	};
+
+	gs_color_format format_from_depth(gfx::lut::color_depth depth);
+
+	/** Number of samples along each axis of a LUT.
+	 *
+	 * Volume LUTs are filtered on all three axes, so they cap out at 64 samples and use the depth for precision only.
+	 * Above 6 bit they are therefore coarser than the tiled layout, which is why tiled stays the default.
+	 */
+	size_t samples_from_depth(gfx::lut::color_depth depth, gfx::lut::layout layout);
 } // namespace gfx::lut
@@ -17,6 +17,7 @@
 
 #include "gfx-shader.hpp"
 #include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <cstring>
 #include "obs/obs-tools.hpp"
@@ -38,12 +39,20 @@ gfx::shader::shader::shader(obs_source_t* self, shader_mode mode)
 
 	  _shader(), _shader_file(), _shader_tech("Draw"), _shader_file_mt(), _shader_file_sz(), _shader_file_tick(0),
 
+	  _uses_time(false), _uses_random(false),
+
 	  _width_type(size_type::Percent), _width_value(1.0), _height_type(size_type::Percent), _height_value(1.0),
 
 	  _have_current_params(false), _time(0), _time_loop(0), _loops(0), _random(), _random_seed(0),
 
-	  _rt_up_to_date(false), _rt(std::make_shared<gs::rendertarget>(GS_RGBA, GS_ZS_NONE))
+	  _rt_up_to_date(false), _rt(std::make_shared<gs::rendertarget>(GS_RGBA, GS_ZS_NONE)),
+
+	  _resolution(), _rt_scale(1.0f)
 {
+	// Transitions have to match their inputs exactly, so only sources and filters scale.
+	if (auto governor = gfx::resolution_governor::get(); governor && (_mode != shader_mode::Transition))
+		_resolution = governor->register_client(obs_source_get_name(_self));
+
 	// Intialize random values.
 	_random.seed(static_cast<unsigned long long>(_random_seed));
 	for (size_t idx = 0; idx < 16; idx++) {
@@ -103,6 +112,10 @@ try {
 		_shader_file_sz   = std::filesystem::file_size(file);
 		_shader_file      = file;
 		_shader_file_tick = 0;
+
+		// Detect which of the time-varying built-in parameters the shader actually declares.
+		_uses_time   = _shader.has_parameter("Time", gs::effect_parameter::type::Float4);
+		_uses_random = _shader.has_parameter("Random", gs::effect_parameter::type::Matrix);
 	}
 
 	// Update Params
@@ -172,6 +185,9 @@ try {
 		}
 	}
 
+	if (shader_dirty || param_dirty)
+		_rt_up_to_date = false;
+
 	return true;
 } catch (const std::exception& ex) {
 	DLOG_ERROR("Loading shader '%s' failed with error: %s", file.c_str(), ex.what());
@@ -187,6 +203,7 @@ void gfx::shader::shader::defaults(obs_data_t* data)
 	obs_data_set_default_string(data, ST_SHADER_SIZE_WIDTH, "100.0 %");
 	obs_data_set_default_string(data, ST_SHADER_SIZE_HEIGHT, "100.0 %");
 	obs_data_set_default_int(data, ST_SHADER_SEED, static_cast<long long>(time(NULL)));
+	gfx::resolution_governor::defaults(data);
 }
 
 void gfx::shader::shader::properties(obs_properties_t* pr)
@@ -237,6 +254,8 @@ void gfx::shader::shader::properties(obs_properties_t* pr)
 												 OBS_TEXT_DEFAULT);
 				obs_property_set_long_description(p, D_TRANSLATE(D_DESC(ST_SHADER_SIZE)));
 			}
+
+			gfx::resolution_governor::properties(grp2);
 		}
 
 		{
@@ -371,6 +390,12 @@ void gfx::shader::shader::update(obs_data_t* data)
 	for (auto kv : _shader_params) {
 		kv.second->update(data);
 	}
+
+	if (_resolution)
+		_resolution->update(data);
+
+	// Any change to the settings may change the output.
+	_rt_up_to_date = false;
 }
 
 uint32_t gfx::shader::shader::width()
@@ -452,18 +477,32 @@ bool gfx::shader::shader::tick(float_t time)
 			_loops = -_loops;
 	}
 
-	// Recreate Per-Activation-Random values.
-	for (size_t idx = 0; idx < 8; idx++) {
-		_random_values[8 + idx] =
-			static_cast<float_t>(static_cast<double_t>(_random()) / static_cast<double_t>(_random.max()));
+	// Recreate Per-Frame-Random values, but only if something reads them.
+	if (_uses_random) {
+		for (size_t idx = 0; idx < 8; idx++) {
+			_random_values[8 + idx] =
+				static_cast<float_t>(static_cast<double_t>(_random()) / static_cast<double_t>(_random.max()));
+		}
 	}
 
-	// Flag Render Target as outdated.
-	_rt_up_to_date = false;
+	// Flag Render Target as outdated if the output depends on time.
+	if (is_time_dependent())
+		_rt_up_to_date = false;
+
+	// Pick up the resolution for this frame, which also requires rendering again.
+	if (float_t scale = _resolution ? _resolution->scale() : 1.0f; scale != _rt_scale) {
+		_rt_scale      = scale;
+		_rt_up_to_date = false;
+	}
 
 	return false;
 }
 
+bool gfx::shader::shader::is_time_dependent()
+{
+	return _uses_time || _uses_random;
+}
+
 void gfx::shader::shader::prepare_render()
 {
 	if (!_shader)
@@ -486,8 +525,9 @@ void gfx::shader::shader::prepare_render()
 	// float4 ViewSize: (Width), (Height), (1.0 / Width), (1.0 / Height)
 	if (auto el = _shader.get_parameter("ViewSize"); el != nullptr) {
 		if (el.get_type() == gs::effect_parameter::type::Float4) {
-			el.set_float4(static_cast<float_t>(width()), static_cast<float_t>(height()),
-						  1.0f / static_cast<float_t>(width()), 1.0f / static_cast<float_t>(height()));
+			float_t w = static_cast<float_t>(std::max<uint32_t>(static_cast<uint32_t>(width() * _rt_scale), 1));
+			float_t h = static_cast<float_t>(std::max<uint32_t>(static_cast<uint32_t>(height() * _rt_scale), 1));
+			el.set_float4(w, h, 1.0f / w, 1.0f / h);
 		}
 	}
 
@@ -514,7 +554,11 @@ void gfx::shader::shader::render()
 		return;
 
 	if (!_rt_up_to_date) {
-		auto op   = _rt->render(width(), height());
+		auto begin = std::chrono::high_resolution_clock::now();
+
+		// Render at the reduced resolution, the draw below scales it back up.
+		auto op   = _rt->render(std::max<uint32_t>(static_cast<uint32_t>(width() * _rt_scale), 1),
+								std::max<uint32_t>(static_cast<uint32_t>(height() * _rt_scale), 1));
 		vec4 zero = {0, 0, 0, 0};
 		gs_ortho(0, 1, 0, 1, 0, 1);
 		gs_clear(GS_CLEAR_COLOR, &zero, 0, 0);
@@ -531,6 +575,9 @@ void gfx::shader::shader::render()
 
 		gs_blend_state_pop();
 
+		if (_resolution)
+			_resolution->track(std::chrono::high_resolution_clock::now() - begin);
+
 		_rt_up_to_date = true;
 	}
 
@@ -543,6 +590,9 @@ void gfx::shader::shader::render()
 
 void gfx::shader::shader::set_size(uint32_t w, uint32_t h)
 {
+	if ((_base_width != w) || (_base_height != h))
+		_rt_up_to_date = false;
+
 	_base_width  = w;
 	_base_height = h;
 }
@@ -561,6 +611,7 @@ void gfx::shader::shader::set_input_a(std::shared_ptr<gs::texture> tex)
 		if (gs::effect_parameter el = _shader.get_parameter(name.data()); el != nullptr) {
 			if (el.get_type() == gs::effect_parameter::type::Texture) {
 				el.set_texture(tex);
+				_rt_up_to_date = false;
 				break;
 			}
 		}
@@ -581,6 +632,7 @@ void gfx::shader::shader::set_input_b(std::shared_ptr<gs::texture> tex)
 		if (gs::effect_parameter el = _shader.get_parameter(name.data()); el != nullptr) {
 			if (el.get_type() == gs::effect_parameter::type::Texture) {
 				el.set_texture(tex);
+				_rt_up_to_date = false;
 				break;
 			}
 		}
@@ -595,6 +647,7 @@ void gfx::shader::shader::set_transition_time(float_t t)
 	if (gs::effect_parameter el = _shader.get_parameter("TransitionTime"); el != nullptr) {
 		if (el.get_type() == gs::effect_parameter::type::Float) {
 			el.set_float(t);
+			_rt_up_to_date = false;
 		}
 	}
 }
@@ -606,6 +659,7 @@ void gfx::shader::shader::set_transition_size(uint32_t w, uint32_t h)
 	if (gs::effect_parameter el = _shader.get_parameter("TransitionSize"); el != nullptr) {
 		if (el.get_type() == gs::effect_parameter::type::Integer2) {
 			el.set_int2(static_cast<int32_t>(w), static_cast<int32_t>(h));
+			_rt_up_to_date = false;
 		}
 	}
 }
@@ -619,4 +673,6 @@ void gfx::shader::shader::set_active(bool active)
 		_random_values[4 + idx] =
 			static_cast<float_t>(static_cast<double_t>(_random()) / static_cast<double_t>(_random.max()));
 	}
+	if (_uses_random)
+		_rt_up_to_date = false;
 }
@@ -21,6 +21,7 @@
 #include <list>
 #include <map>
 #include <random>
+#include "gfx/gfx-resolution-governor.hpp"
 #include "gfx/shader/gfx-shader-param.hpp"
 #include "obs/gs/gs-effect.hpp"
 #include "obs/gs/gs-rendertarget.hpp"
@@ -58,6 +59,10 @@ namespace gfx {
 			float_t                         _shader_file_tick;
 			shader_param_map_t              _shader_params;
 
+			// Built-in parameters used by the shader, detected at load time.
+			bool _uses_time;
+			bool _uses_random;
+
 			// Options
 			size_type _width_type;
 			double_t  _width_value;
@@ -77,6 +82,10 @@ namespace gfx {
 			bool                              _rt_up_to_date;
 			std::shared_ptr<gs::rendertarget> _rt;
 
+			// Dynamic Resolution
+			std::shared_ptr<gfx::resolution_governor::client> _resolution;
+			float_t                                           _rt_scale;
+
 			public:
 			shader(obs_source_t* self, shader_mode mode);
 			~shader();
@@ -114,6 +123,8 @@ namespace gfx {
 
 			void render();
 
+			bool is_time_dependent();
+
 			public:
 			void set_size(uint32_t w, uint32_t h);
 
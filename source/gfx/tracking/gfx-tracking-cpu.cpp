@@ -0,0 +1,298 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "gfx-tracking-cpu.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include "obs/gs/gs-helper.hpp"
+
+// Frames are only mapped once the graphics thread moved on, which update() takes care of instead of the ring.
+#define RING_SIZE 3
+#define RING_LATENCY 0
+
+gfx::tracking::cpu::cpu(uint32_t size)
+	: _size(std::max<uint32_t>(size, 16)), _rt(), _ring(), _lock(), _stages(), _tag(0)
+{
+	auto gctx = gs::context();
+	_rt       = std::make_shared<gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+	_ring     = std::make_shared<gs::readback_ring>(RING_SIZE, RING_LATENCY);
+}
+
+gfx::tracking::cpu::~cpu()
+{
+	auto gctx = gs::context();
+	_ring.reset();
+	_stages.clear();
+	_rt.reset();
+}
+
+void gfx::tracking::cpu::capture(std::shared_ptr<gs::texture> frame)
+{
+	if (!frame || !frame->get_width() || !frame->get_height())
+		return;
+
+	std::shared_ptr<struct stage> stage;
+	{
+		std::unique_lock<std::mutex> lock(_lock);
+
+		// Forget about frames that no longer exist.
+		for (auto iter = _stages.begin(); iter != _stages.end();) {
+			if (iter->second->frame.expired()) {
+				iter = _stages.erase(iter);
+			} else {
+				iter++;
+			}
+		}
+
+		auto& entry = _stages[frame.get()];
+		if (!entry) {
+			entry        = std::make_shared<struct stage>();
+			entry->frame = frame;
+		}
+		stage = entry;
+	}
+
+	// Downscale the frame so that its longest edge fits into the configured size.
+	double_t scale  = std::min(1.0, static_cast<double_t>(_size) / std::max(frame->get_width(), frame->get_height()));
+	uint32_t width  = std::max<uint32_t>(1, static_cast<uint32_t>(std::lround(frame->get_width() * scale)));
+	uint32_t height = std::max<uint32_t>(1, static_cast<uint32_t>(std::lround(frame->get_height() * scale)));
+
+	bool     staged;
+	uint64_t tag;
+	{
+#ifdef ENABLE_PROFILING
+		gs::debug_marker gdm{gs::debug_color_convert, "Downscale & Stage"};
+#endif
+		gs_effect_t* effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+
+		gs_blend_state_push();
+		gs_reset_blend_state();
+		gs_enable_blending(false);
+		gs_enable_depth_test(false);
+		gs_enable_color(true, true, true, true);
+		gs_set_cull_mode(GS_NEITHER);
+		{
+			auto op = _rt->render(width, height);
+			gs_ortho(0, 1, 0, 1, -1, 1);
+
+			gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), frame->get_object());
+			while (gs_effect_loop(effect, "Draw")) {
+				gs_draw_sprite(nullptr, 0, 1, 1);
+			}
+		}
+		gs_blend_state_pop();
+
+		{
+			std::unique_lock<std::mutex> lock(_lock);
+			tag = ++_tag;
+		}
+		staged = _ring->stage(_rt->get_object(), tag);
+	}
+
+	// A frame the ring had no room for is treated like one that failed to map, there is nothing to look at.
+	std::unique_lock<std::mutex> lock(_lock);
+	stage->tag       = tag;
+	stage->timestamp = obs_get_video_frame_time();
+	stage->staged    = staged;
+	stage->width     = width;
+	stage->height    = height;
+	stage->pixels.clear();
+}
+
+void gfx::tracking::cpu::update()
+{
+	auto                         gctx = gs::context();
+	std::unique_lock<std::mutex> lock(_lock);
+
+	auto find = [this](uint64_t tag) -> std::shared_ptr<struct stage> {
+		for (auto& kv : _stages) {
+			if (kv.second->tag == tag)
+				return kv.second;
+		}
+		return nullptr;
+	};
+
+	// Only frames from before the current one are read back, by now the GPU has long finished copying them.
+	uint64_t now = obs_get_video_frame_time();
+	for (uint64_t tag; _ring->peek(tag);) {
+		auto stage = find(tag);
+		if (!stage || !stage->staged) { // The frame was captured again or destroyed since.
+			_ring->discard();
+			continue;
+		} else if (stage->timestamp == now) {
+			break;
+		}
+
+		gs::readback_ring::frame mapped;
+		if (!_ring->try_map(mapped))
+			break;
+
+		stage = find(mapped.tag);
+		if (stage && stage->staged) {
+			std::size_t row_size = static_cast<std::size_t>(mapped.width) * 4;
+			stage->pixels.resize(row_size * mapped.height);
+			for (uint32_t y = 0; y < mapped.height; y++) {
+				std::memcpy(stage->pixels.data() + row_size * y,
+							mapped.data + static_cast<std::size_t>(mapped.linesize) * y, row_size);
+			}
+			stage->width  = mapped.width;
+			stage->height = mapped.height;
+			stage->staged = false;
+		}
+		_ring->unmap(mapped);
+	}
+
+	// Anything older that is still waiting was dropped by the ring or failed to map, and never will be read.
+	for (auto& kv : _stages) {
+		if (kv.second->staged && (kv.second->timestamp != now))
+			kv.second->staged = false;
+	}
+}
+
+bool gfx::tracking::cpu::track(std::shared_ptr<gs::texture> frame, std::vector<gfx::tracking::region>& regions)
+{
+	std::vector<uint8_t> pixels;
+	uint32_t             width;
+	uint32_t             height;
+	{
+		std::unique_lock<std::mutex> lock(_lock);
+		auto                         iter = _stages.find(frame.get());
+		if (iter == _stages.end()) {
+			regions.clear();
+			return true;
+		}
+
+		auto& stage = iter->second;
+		if (stage->staged)
+			return false;
+
+		pixels.swap(stage->pixels);
+		width  = stage->width;
+		height = stage->height;
+	}
+
+	// Mapping failed in update(), there is nothing to look at.
+	if (pixels.empty()) {
+		regions.clear();
+		return true;
+	}
+
+	detect(pixels.data(), width, height, regions);
+	return true;
+}
+
+void gfx::tracking::cpu::detect(const uint8_t* pixels, uint32_t width, uint32_t height,
+								std::vector<gfx::tracking::region>& regions)
+{
+	constexpr uint8_t background = 0;
+	constexpr uint8_t skin       = 1;
+	constexpr uint8_t visited    = 2;
+
+	regions.clear();
+
+	std::size_t count = static_cast<std::size_t>(width) * height;
+	if (count == 0)
+		return;
+
+	// Classify skin tones by their chroma (BT.601, full range), ignoring pixels that are too dark to tell.
+	std::vector<uint8_t> mask(count, background);
+	for (std::size_t idx = 0; idx < count; idx++) {
+		const uint8_t* px = pixels + idx * 4;
+		float_t        r  = px[0];
+		float_t        g  = px[1];
+		float_t        b  = px[2];
+		float_t        y  = 0.299f * r + 0.587f * g + 0.114f * b;
+		float_t        cb = 128.f - 0.168736f * r - 0.331264f * g + 0.5f * b;
+		float_t        cr = 128.f + 0.5f * r - 0.418688f * g - 0.081312f * b;
+		if ((y > 40.f) && (cb >= 77.f) && (cb <= 127.f) && (cr >= 133.f) && (cr <= 173.f)) {
+			mask[idx] = skin;
+		}
+	}
+
+	// Grow 4-connected components and score each one by how face-like it is.
+	std::vector<std::size_t> stack;
+	std::size_t              min_area = std::max<std::size_t>(4, count / 1000);
+	for (std::size_t seed = 0; seed < count; seed++) {
+		if (mask[seed] != skin)
+			continue;
+
+		uint32_t    x0   = width;
+		uint32_t    y0   = height;
+		uint32_t    x1   = 0;
+		uint32_t    y1   = 0;
+		std::size_t area = 0;
+
+		mask[seed] = visited;
+		stack.push_back(seed);
+		while (!stack.empty()) {
+			std::size_t idx = stack.back();
+			uint32_t    x   = static_cast<uint32_t>(idx % width);
+			uint32_t    y   = static_cast<uint32_t>(idx / width);
+			stack.pop_back();
+
+			area++;
+			x0 = std::min(x0, x);
+			x1 = std::max(x1, x);
+			y0 = std::min(y0, y);
+			y1 = std::max(y1, y);
+
+			auto visit = [&mask, &stack](std::size_t next) {
+				if (mask[next] == skin) {
+					mask[next] = visited;
+					stack.push_back(next);
+				}
+			};
+			if (x > 0)
+				visit(idx - 1);
+			if (x + 1 < width)
+				visit(idx + 1);
+			if (y > 0)
+				visit(idx - width);
+			if (y + 1 < height)
+				visit(idx + width);
+		}
+
+		if (area < min_area)
+			continue;
+
+		// Faces fill about an ellipse (pi/4 of their bounding box), are a bit taller than wide, and are rarely tiny.
+		float_t bw           = static_cast<float_t>(x1 - x0 + 1);
+		float_t bh           = static_cast<float_t>(y1 - y0 + 1);
+		float_t fill         = static_cast<float_t>(area) / (bw * bh);
+		float_t fill_score   = std::clamp(1.f - std::abs(fill - 0.785f) / 0.785f, 0.f, 1.f);
+		float_t aspect_score = std::exp(-std::pow((bh / bw - 1.3f) / 0.5f, 2.f));
+		float_t size_score   = std::min(1.f, static_cast<float_t>(area) / (static_cast<float_t>(count) * 0.01f));
+
+		gfx::tracking::region region;
+		region.x          = static_cast<float_t>(x0) / static_cast<float_t>(width);
+		region.y          = static_cast<float_t>(y0) / static_cast<float_t>(height);
+		region.width      = bw / static_cast<float_t>(width);
+		region.height     = bh / static_cast<float_t>(height);
+		region.confidence = fill_score * aspect_score * size_score;
+		regions.push_back(region);
+	}
+
+	std::stable_sort(regions.begin(), regions.end(),
+					 [](const gfx::tracking::region& a, const gfx::tracking::region& b) {
+						 return a.confidence > b.confidence;
+					 });
+}
@@ -0,0 +1,74 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+#include "common.hpp"
+#include <map>
+#include <mutex>
+#include <vector>
+#include "gfx-tracking.hpp"
+#include "obs/gs/gs-readback-ring.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
+
+namespace gfx::tracking {
+	/** Reference backend that runs entirely on the CPU.
+	 *
+	 * Every captured frame is downscaled on the GPU and staged in a readback ring. update() only maps a frame once the
+	 * graphics thread has moved on to a later frame, so that the copy is complete and mapping never stalls rendering,
+	 * and track() never waits for it but asks to be called again instead. Regions are
+	 * found by segmenting skin tones in YCbCr and picking out the connected components that have a face-like shape.
+	 * This is nowhere near as robust as a trained model, but it is deterministic and cheap enough to run on any
+	 * machine.
+	 */
+	class cpu : public gfx::tracking::backend {
+		struct stage {
+			std::weak_ptr<gs::texture> frame;
+			uint64_t                   tag;
+			uint64_t                   timestamp;
+			bool                       staged; // Copied on the GPU, but not read back yet.
+			uint32_t                   width;
+			uint32_t                   height;
+			std::vector<uint8_t>       pixels; // Read back, but not tracked yet.
+		};
+
+		uint32_t                           _size;
+		std::shared_ptr<gs::rendertarget>  _rt;
+		std::shared_ptr<gs::readback_ring> _ring;
+
+		std::mutex                                            _lock;
+		std::map<gs::texture*, std::shared_ptr<struct stage>> _stages;
+		uint64_t                                              _tag;
+
+		public:
+		/** @param size Length of the longest edge of the downscaled frame. */
+		cpu(uint32_t size = 160);
+		virtual ~cpu();
+
+		virtual void update() override;
+
+		virtual void capture(std::shared_ptr<gs::texture> frame) override;
+
+		virtual bool track(std::shared_ptr<gs::texture> frame, std::vector<gfx::tracking::region>& regions) override;
+
+		/** Find regions in a tightly packed RGBA8 image. */
+		static void detect(const uint8_t* pixels, uint32_t width, uint32_t height,
+						   std::vector<gfx::tracking::region>& regions);
+	};
+} // namespace gfx::tracking
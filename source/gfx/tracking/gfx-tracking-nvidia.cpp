@@ -0,0 +1,239 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "gfx-tracking-nvidia.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include "nvidia/cuda/nvidia-cuda-context-stack.hpp"
+#include "obs/gs/gs-helper.hpp"
+
+#define LOCAL_PREFIX "<gfx::tracking::nvidia> "
+
+gfx::tracking::nvidia::nvidia(std::shared_ptr<::nvidia::cuda::cuda>    cuda,
+							  std::shared_ptr<::nvidia::cuda::context> cuda_context,
+							  std::shared_ptr<::nvidia::ar::ar>        ar)
+	: _cuda(cuda), _cuda_ctx(cuda_context), _cuda_stream(), _ar(ar), _lock(), _feature(), _bboxes_confidence(),
+	  _bboxes_data(), _bboxes(), _texture_cuda_mem(), _image(), _image_bgr(), _image_temp(),
+	  _textures()
+{
+	if (!_cuda || !_cuda_ctx || !_ar)
+		throw std::runtime_error("NVIDIA CUDA and AR SDK are required.");
+
+	// Update the current CUDA context for working.
+	gs::context gctx;
+	auto        cctx = std::make_shared<::nvidia::cuda::context_stack>(_cuda, _cuda_ctx);
+	_cuda_stream     = std::make_shared<::nvidia::cuda::stream>(_cuda, ::nvidia::cuda::stream_flags::NON_BLOCKING, 0);
+
+	// Create Face Detection feature.
+	{
+		NvAR_FeatureHandle fd_inst;
+		if (NvCV_Status res = _ar->create(NvAR_Feature_FaceDetection, &fd_inst); res != NVCV_SUCCESS) {
+			throw std::runtime_error("Failed to create Face Detection feature.");
+		}
+		_feature = std::shared_ptr<nvAR_Feature>{fd_inst, [ar = _ar](NvAR_FeatureHandle v) { ar->destroy(v); }};
+	}
+
+	// Set the correct CUDA stream for processing.
+	if (NvCV_Status res = _ar->set_cuda_stream(_feature.get(), NvAR_Parameter_Config(CUDAStream),
+											   reinterpret_cast<CUstream>(_cuda_stream->get()));
+		res != NVCV_SUCCESS) {
+		throw std::runtime_error("Failed to set CUDA stream.");
+	}
+
+	// Set the correct models path.
+	{
+		std::filesystem::path models_path = _ar->get_ar_sdk_path();
+		models_path                       = models_path.append("models");
+		models_path                       = std::filesystem::absolute(models_path);
+		models_path.concat("\\");
+		if (NvCV_Status res =
+				_ar->set_string(_feature.get(), NvAR_Parameter_Config(ModelDir), models_path.string().c_str());
+			res != NVCV_SUCCESS) {
+			throw std::runtime_error("Unable to set model path.");
+		}
+	}
+
+	// Finally enable Temporal tracking if possible.
+	if (NvCV_Status res = _ar->set_uint32(_feature.get(), NvAR_Parameter_Config(Temporal), 1); res != NVCV_SUCCESS) {
+		DLOG_WARNING(LOCAL_PREFIX "Unable to enable Temporal tracking mode.");
+	}
+
+	// Create Bounding Boxes Data
+	_bboxes_data.assign(1, {0., 0., 0., 0.});
+	_bboxes.boxes     = _bboxes_data.data();
+	_bboxes.max_boxes = std::clamp<uint8_t>(static_cast<uint8_t>(_bboxes_data.size()), 0, 255);
+	_bboxes.num_boxes = 0;
+	_bboxes_confidence.resize(_bboxes_data.size());
+	if (NvCV_Status res =
+			_ar->set_object(_feature.get(), NvAR_Parameter_Output(BoundingBoxes), &_bboxes, sizeof(NvAR_BBoxes));
+		res != NVCV_SUCCESS) {
+		throw std::runtime_error("Failed to set BoundingBoxes for Face Tracking feature.");
+	}
+	if (NvCV_Status res = _ar->set_float32_array(_feature.get(), NvAR_Parameter_Output(BoundingBoxesConfidence),
+												 _bboxes_confidence.data(),
+												 static_cast<int>(_bboxes_confidence.size()));
+		res != NVCV_SUCCESS) {
+		throw std::runtime_error("Failed to set BoundingBoxesConfidence for Face Tracking feature.");
+	}
+
+	// And finally, load the feature (takes long).
+	if (NvCV_Status res = _ar->load(_feature.get()); res != NVCV_SUCCESS) {
+		throw std::runtime_error("Failed to load Face Tracking feature.");
+	}
+}
+
+gfx::tracking::nvidia::~nvidia()
+{
+	std::unique_lock<std::mutex> lock{_lock};
+	{
+		gs::context gctx{};
+		_textures.clear();
+	}
+	_ar->image_dealloc(&_image_temp);
+	_ar->image_dealloc(&_image_bgr);
+}
+
+void gfx::tracking::nvidia::capture(std::shared_ptr<gs::texture> frame)
+{
+	// Nothing to prepare, the frame is read directly by track().
+}
+
+bool gfx::tracking::nvidia::track(std::shared_ptr<gs::texture> frame, std::vector<gfx::tracking::region>& regions)
+{
+	std::unique_lock<std::mutex> lock{_lock};
+
+	regions.clear();
+	if (!frame || !frame->get_width() || !frame->get_height())
+		return true;
+
+	// Acquire GS context.
+	gs::context gctx{};
+
+	// Update the current CUDA context for working.
+	auto cctx = std::make_shared<::nvidia::cuda::context_stack>(_cuda, _cuda_ctx);
+
+	// Refresh any now broken buffers.
+	if ((_image.width != frame->get_width()) || (_image.height != frame->get_height())) {
+#ifdef ENABLE_PROFILING
+		gs::debug_marker marker{gs::debug_color_allocate, "Reallocate CUDA Buffers"};
+#endif
+		// Allocate new memory.
+		std::size_t pitch = frame->get_width() * 4ul;
+		_texture_cuda_mem = std::make_shared<::nvidia::cuda::memory>(_cuda, pitch * frame->get_height());
+		_ar->image_init(&_image, static_cast<unsigned int>(frame->get_width()),
+						static_cast<unsigned int>(frame->get_height()), static_cast<int>(pitch),
+						reinterpret_cast<void*>(_texture_cuda_mem->get()), NVCV_RGBA, NVCV_U8, NVCV_INTERLEAVED,
+						NVCV_CUDA);
+
+		// Reallocate transposed buffer.
+		_ar->image_dealloc(&_image_temp);
+		_ar->image_dealloc(&_image_bgr);
+		_ar->image_alloc(&_image_bgr, _image.width, _image.height, NVCV_BGR, NVCV_U8, NVCV_INTERLEAVED, NVCV_CUDA, 0);
+
+		// Synchronize Streams.
+		_cuda->cuStreamSynchronize(_cuda_stream->get());
+
+		// Finally set the input object.
+		if (NvCV_Status res =
+				_ar->set_object(_feature.get(), NvAR_Parameter_Input(Image), &_image_bgr, sizeof(NvCVImage));
+			res != NVCV_SUCCESS) {
+			throw std::runtime_error("Failed to update input image for tracking.");
+		}
+	}
+
+	// Find or register the CUDA view of this frame, and forget about frames that no longer exist.
+	std::shared_ptr<::nvidia::cuda::gstexture> texture_cuda;
+	for (auto iter = _textures.begin(); iter != _textures.end();) {
+		if (iter->second.first.expired()) {
+			iter = _textures.erase(iter);
+		} else {
+			iter++;
+		}
+	}
+	if (auto iter = _textures.find(frame.get()); iter != _textures.end()) {
+		texture_cuda = iter->second.second;
+	} else {
+#ifdef ENABLE_PROFILING
+		gs::debug_marker marker{gs::debug_color_allocate, "Register CUDA Texture"};
+#endif
+		texture_cuda           = std::make_shared<::nvidia::cuda::gstexture>(_cuda, frame);
+		_textures[frame.get()] = {frame, texture_cuda};
+	}
+
+	{ // Copy from CUDA array to CUDA device memory.
+		::nvidia::cuda::memcpy2d_t mc;
+		mc.src_x_in_bytes  = 0;
+		mc.src_y           = 0;
+		mc.src_memory_type = ::nvidia::cuda::memory_type::ARRAY;
+		mc.src_host        = nullptr;
+		mc.src_device      = 0;
+		mc.src_array       = texture_cuda->map(_cuda_stream);
+		mc.src_pitch       = static_cast<size_t>(_image.pitch);
+		mc.dst_x_in_bytes  = 0;
+		mc.dst_y           = 0;
+		mc.dst_memory_type = ::nvidia::cuda::memory_type::DEVICE;
+		mc.dst_host        = 0;
+		mc.dst_device      = reinterpret_cast<::nvidia::cuda::device_ptr_t>(_image.pixels);
+		mc.dst_array       = 0;
+		mc.dst_pitch       = static_cast<size_t>(_image.pitch);
+		mc.width_in_bytes  = static_cast<size_t>(_image.pitch);
+		mc.height          = _image.height;
+
+		if (::nvidia::cuda::result res = _cuda->cuMemcpy2DAsync(&mc, _cuda_stream->get());
+			res != ::nvidia::cuda::result::SUCCESS) {
+			throw std::runtime_error("Failed to prepare buffers for tracking.");
+		}
+	}
+
+	{ // Convert from RGBA 32-bit to BGR 24-bit.
+		if (NvCV_Status res = _ar->image_transfer(&_image, &_image_bgr, 1.0,
+												  reinterpret_cast<CUstream_st*>(_cuda_stream->get()), &_image_temp);
+			res != NVCV_SUCCESS) {
+			throw std::runtime_error("Failed to convert from RGBX 32-bit to BGR 24-bit.");
+		}
+
+		// Synchronize Streams.
+		_cuda->cuStreamSynchronize(_cuda_stream->get());
+		_cuda->cuCtxSynchronize();
+	}
+
+	// Track any faces.
+	if (NvCV_Status res = _ar->run(_feature.get()); res != NVCV_SUCCESS) {
+		throw std::runtime_error("Failed to run tracking.");
+	}
+
+	float_t sx = static_cast<float_t>(_image_bgr.width);
+	float_t sy = static_cast<float_t>(_image_bgr.height);
+	for (std::size_t idx = 0; idx < _bboxes.num_boxes; idx++) {
+		gfx::tracking::region region;
+		region.x          = _bboxes.boxes[idx].x / sx;
+		region.y          = _bboxes.boxes[idx].y / sy;
+		region.width      = _bboxes.boxes[idx].width / sx;
+		region.height     = _bboxes.boxes[idx].height / sy;
+		region.confidence = _bboxes_confidence.at(idx);
+		regions.push_back(region);
+	}
+	std::stable_sort(regions.begin(), regions.end(),
+					 [](const gfx::tracking::region& a, const gfx::tracking::region& b) {
+						 return a.confidence > b.confidence;
+					 });
+	return true;
+}
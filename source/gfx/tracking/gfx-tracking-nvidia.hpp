@@ -0,0 +1,71 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+#include "common.hpp"
+#include <map>
+#include <mutex>
+#include <vector>
+#include "gfx-tracking.hpp"
+
+#include "nvidia/ar/nvidia-ar.hpp"
+#include "nvidia/cuda/nvidia-cuda-context.hpp"
+#include "nvidia/cuda/nvidia-cuda-gs-texture.hpp"
+#include "nvidia/cuda/nvidia-cuda-memory.hpp"
+#include "nvidia/cuda/nvidia-cuda-stream.hpp"
+#include "nvidia/cuda/nvidia-cuda.hpp"
+
+namespace gfx::tracking {
+	/** Face detection through the NVIDIA Augmented Reality SDK.
+	 *
+	 * Loading the models takes a long time, so this should be constructed on the thread pool. The feature itself can
+	 * only work on one frame at a time, so concurrent calls to track() are serialized.
+	 */
+	class nvidia : public gfx::tracking::backend {
+		std::shared_ptr<::nvidia::cuda::cuda>    _cuda;
+		std::shared_ptr<::nvidia::cuda::context> _cuda_ctx;
+		std::shared_ptr<::nvidia::cuda::stream>  _cuda_stream;
+		std::shared_ptr<::nvidia::ar::ar>        _ar;
+
+		std::mutex                              _lock;
+		std::shared_ptr<nvAR_Feature>           _feature;
+		std::vector<float_t>                    _bboxes_confidence;
+		std::vector<NvAR_Rect>                  _bboxes_data;
+		NvAR_BBoxes                             _bboxes;
+		std::shared_ptr<::nvidia::cuda::memory> _texture_cuda_mem;
+		NvCVImage                               _image;
+		NvCVImage                               _image_bgr;
+		NvCVImage                               _image_temp;
+
+		// Frames are registered with CUDA once and then reused for as long as they exist.
+		std::map<gs::texture*,
+				 std::pair<std::weak_ptr<gs::texture>, std::shared_ptr<::nvidia::cuda::gstexture>>>
+			_textures;
+
+		public:
+		nvidia(std::shared_ptr<::nvidia::cuda::cuda> cuda, std::shared_ptr<::nvidia::cuda::context> cuda_context,
+			   std::shared_ptr<::nvidia::ar::ar> ar);
+		virtual ~nvidia();
+
+		virtual void capture(std::shared_ptr<gs::texture> frame) override;
+
+		virtual bool track(std::shared_ptr<gs::texture> frame, std::vector<gfx::tracking::region>& regions) override;
+	};
+} // namespace gfx::tracking
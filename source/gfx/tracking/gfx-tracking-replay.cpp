@@ -0,0 +1,103 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "gfx-tracking-replay.hpp"
+#include <algorithm>
+#include <fstream>
+#include <locale>
+#include <sstream>
+#include <stdexcept>
+
+gfx::tracking::replay::replay(std::filesystem::path file) : _frames(), _frame(0), _lock(), _indices()
+{
+	std::ifstream stream(file);
+	if (!stream.is_open() || stream.bad())
+		throw std::runtime_error("Failed to open replay file.");
+
+	std::string line;
+	std::size_t line_number = 0;
+	while (std::getline(stream, line)) {
+		line_number++;
+
+		std::istringstream parser(line);
+		parser.imbue(std::locale::classic());
+
+		std::string first;
+		if (!(parser >> first) || (first[0] == '#'))
+			continue;
+
+		uint64_t              frame;
+		gfx::tracking::region region;
+		parser.str(line);
+		parser.clear();
+		if (!(parser >> frame >> region.x >> region.y >> region.width >> region.height >> region.confidence)) {
+			std::stringstream msg;
+			msg << "Malformed region on line " << line_number << ".";
+			throw std::runtime_error(msg.str());
+		}
+
+		if (frame >= _frames.size())
+			_frames.resize(static_cast<std::size_t>(frame) + 1);
+		_frames[static_cast<std::size_t>(frame)].push_back(region);
+	}
+
+	for (auto& regions : _frames) {
+		std::stable_sort(regions.begin(), regions.end(),
+						 [](const gfx::tracking::region& a, const gfx::tracking::region& b) {
+							 return a.confidence > b.confidence;
+						 });
+	}
+}
+
+gfx::tracking::replay::~replay() {}
+
+void gfx::tracking::replay::capture(std::shared_ptr<gs::texture> frame)
+{
+	std::unique_lock<std::mutex> lock(_lock);
+
+	for (auto iter = _indices.begin(); iter != _indices.end();) {
+		if (iter->second.first.expired()) {
+			iter = _indices.erase(iter);
+		} else {
+			iter++;
+		}
+	}
+
+	_indices[frame.get()] = {frame, _frame++};
+}
+
+bool gfx::tracking::replay::track(std::shared_ptr<gs::texture> frame, std::vector<gfx::tracking::region>& regions)
+{
+	regions.clear();
+	if (_frames.empty())
+		return true;
+
+	uint64_t index;
+	{
+		std::unique_lock<std::mutex> lock(_lock);
+		auto                         iter = _indices.find(frame.get());
+		if (iter == _indices.end())
+			return true;
+		index = iter->second.second;
+	}
+
+	regions = _frames[static_cast<std::size_t>(index % _frames.size())];
+	return true;
+}
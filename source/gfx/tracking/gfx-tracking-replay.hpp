@@ -0,0 +1,52 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+#include "common.hpp"
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <vector>
+#include "gfx-tracking.hpp"
+
+namespace gfx::tracking {
+	/** Deterministic backend that replays regions from a text file instead of looking at the frame.
+	 *
+	 * Each non-empty line that does not start with '#' describes one region as "<frame> <x> <y> <width> <height>
+	 * <confidence>", with coordinates normalized to the frame. Frames are counted per capture, even if they are tracked
+	 * out of order, and the recording loops once it runs out, so the same file always produces the same sequence of
+	 * regions.
+	 */
+	class replay : public gfx::tracking::backend {
+		std::vector<std::vector<gfx::tracking::region>> _frames;
+		uint64_t                                        _frame;
+
+		std::mutex                                                               _lock;
+		std::map<gs::texture*, std::pair<std::weak_ptr<gs::texture>, uint64_t>> _indices;
+
+		public:
+		replay(std::filesystem::path file);
+		virtual ~replay();
+
+		virtual void capture(std::shared_ptr<gs::texture> frame) override;
+
+		virtual bool track(std::shared_ptr<gs::texture> frame, std::vector<gfx::tracking::region>& regions) override;
+	};
+} // namespace gfx::tracking
@@ -0,0 +1,63 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+#include "common.hpp"
+#include <memory>
+#include <vector>
+#include "obs/gs/gs-texture.hpp"
+
+namespace gfx::tracking {
+	/** A tracked region, in coordinates normalized to the captured frame with the origin at the top left. */
+	struct region {
+		float_t x;
+		float_t y;
+		float_t width;
+		float_t height;
+		float_t confidence;
+	};
+
+	/** Interface for anything that can find regions of interest in a frame.
+	 *
+	 * Backends are driven in two steps: capture() is called on the graphics thread right after a frame was copied
+	 * into a texture, while track() is called later on the thread pool to find regions in that texture. Several
+	 * frames may be in flight at once, each in its own texture, which is left untouched until track() succeeded.
+	 * Backends that need the frame on the CPU read it back in update() once the GPU is done with it, and until then
+	 * track() asks to be called again instead of waiting.
+	 */
+	class backend {
+		public:
+		virtual ~backend(){};
+
+		/** Finish work on earlier captures. Called once per frame from the graphics thread, before capture(). */
+		virtual void update(){};
+
+		/** Prepare a frame for tracking. Called from the graphics thread. */
+		virtual void capture(std::shared_ptr<gs::texture> frame) = 0;
+
+		/** Find all regions in a previously captured frame, ordered by descending confidence.
+		 *
+		 * Called from the thread pool, possibly for several frames at the same time.
+		 *
+		 * \return false if the frame is not available yet, in which case track() is called again on a later frame.
+		 */
+		virtual bool track(std::shared_ptr<gs::texture> frame, std::vector<gfx::tracking::region>& regions) = 0;
+	};
+} // namespace gfx::tracking
@@ -0,0 +1,268 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "gs-readback-ring.hpp"
+#include <exception>
+#include <stdexcept>
+#include "obs/gs/gs-helper.hpp"
+
+// Maps taking longer than this waited for the GPU, instead of only copying the pointer.
+#define STALL_THRESHOLD std::chrono::milliseconds(1)
+
+gs::readback_ring::readback_ring(std::size_t size, std::size_t latency)
+	: _latency(latency), _slots(size), _sequence(0), _consumer(), _threadpool(), _lock(), _released(), _statistics(),
+	  _latency_total(0), _latency_count(0)
+{
+	if ((size < 1) || (latency >= size))
+		throw std::invalid_argument("Latency must be less than the number of surfaces.");
+
+	for (std::size_t idx = 0; idx < _slots.size(); idx++) {
+		_slots[idx].surface    = nullptr;
+		_slots[idx].status     = state::Free;
+		_slots[idx].sequence   = 0;
+		_slots[idx].info       = {};
+		_slots[idx].info.index = idx;
+	}
+}
+
+gs::readback_ring::~readback_ring()
+{
+	{ // Consumers still hold pointers into mapped surfaces, so wait for them before anything is unmapped.
+		std::unique_lock<std::mutex> ul(_lock);
+		auto is_consuming = [](slot const& s) { return s.status == state::Consuming; };
+		_released.wait(ul, [this, &is_consuming]() {
+			return std::none_of(_slots.begin(), _slots.end(), is_consuming);
+		});
+	}
+
+	auto gctx = gs::context();
+	for (auto& s : _slots) {
+		if ((s.status == state::Mapped) || (s.status == state::Consumed))
+			gs_stagesurface_unmap(s.surface);
+		if (s.surface)
+			gs_stagesurface_destroy(s.surface);
+	}
+}
+
+bool gs::readback_ring::stage(gs_texture_t* texture, uint64_t tag)
+{
+	if (!texture)
+		return false;
+
+	// The graphics context is always entered before the lock, as callers may already be holding it.
+	auto                         gctx = gs::context();
+	std::unique_lock<std::mutex> ul(_lock);
+	collect();
+
+	// Prefer a free surface, otherwise overwrite the oldest frame that nobody has mapped yet.
+	slot* target = nullptr;
+	for (auto& s : _slots) {
+		if (s.status == state::Free) {
+			target = &s;
+			break;
+		} else if ((s.status == state::Staged) && (!target || (s.sequence < target->sequence))) {
+			target = &s;
+		}
+	}
+	if (!target) {
+		_statistics.dropped++;
+		return false;
+	} else if (target->status == state::Staged) {
+		_statistics.dropped++;
+	}
+
+	uint32_t        width  = gs_texture_get_width(texture);
+	uint32_t        height = gs_texture_get_height(texture);
+	gs_color_format format = gs_texture_get_color_format(texture);
+	if (!target->surface || (target->info.width != width) || (target->info.height != height)
+		|| (target->info.format != format)) {
+		if (target->surface)
+			gs_stagesurface_destroy(target->surface);
+		target->surface = gs_stagesurface_create(width, height, format);
+		if (!target->surface) {
+			target->status = state::Free;
+			throw std::runtime_error("Failed to create staging surface.");
+		}
+		target->info.width  = width;
+		target->info.height = height;
+		target->info.format = format;
+	}
+
+	gs_stage_texture(target->surface, texture);
+	target->status    = state::Staged;
+	target->sequence  = ++_sequence;
+	target->info.tag  = tag;
+	target->staged_at = std::chrono::high_resolution_clock::now();
+	_statistics.staged++;
+
+	// Hand everything that is ready to the consumer.
+	if (_consumer && _threadpool) {
+		for (slot* s = find_ready(); s; s = find_ready()) {
+			if (!map(*s))
+				continue;
+
+			s->status = state::Consuming;
+			_threadpool->push(
+				[this, s, consumer = _consumer](util::threadpool_data_t) {
+					std::exception_ptr error;
+					try {
+						consumer(s->info);
+					} catch (...) {
+						error = std::current_exception();
+					}
+
+					{ // The graphics thread unmaps it on the next call.
+						std::unique_lock<std::mutex> ul(_lock);
+						s->status = state::Consumed;
+						_released.notify_all();
+					}
+
+					if (error)
+						std::rethrow_exception(error);
+				},
+				nullptr);
+		}
+	}
+
+	return true;
+}
+
+bool gs::readback_ring::try_map(frame& out)
+{
+	auto                         gctx = gs::context();
+	std::unique_lock<std::mutex> ul(_lock);
+	collect();
+
+	for (slot* s = find_ready(); s; s = find_ready()) {
+		if (map(*s)) {
+			s->status = state::Mapped;
+			out       = s->info;
+			return true;
+		}
+	}
+	return false;
+}
+
+void gs::readback_ring::unmap(frame const& mapped)
+{
+	auto                         gctx = gs::context();
+	std::unique_lock<std::mutex> ul(_lock);
+	if ((mapped.index >= _slots.size()) || (_slots[mapped.index].status != state::Mapped))
+		throw std::invalid_argument("Frame is not mapped.");
+
+	release(_slots[mapped.index]);
+}
+
+bool gs::readback_ring::peek(uint64_t& tag)
+{
+	std::unique_lock<std::mutex> ul(_lock);
+	if (slot* s = find_ready(); s) {
+		tag = s->info.tag;
+		return true;
+	}
+	return false;
+}
+
+bool gs::readback_ring::discard()
+{
+	std::unique_lock<std::mutex> ul(_lock);
+	if (slot* s = find_ready(); s) {
+		s->status = state::Free;
+		_statistics.dropped++;
+		return true;
+	}
+	return false;
+}
+
+void gs::readback_ring::set_consumer(consumer_t consumer, std::shared_ptr<util::threadpool> threadpool)
+{
+	std::unique_lock<std::mutex> ul(_lock);
+	_consumer   = consumer;
+	_threadpool = threadpool;
+}
+
+gs::readback_ring::statistics gs::readback_ring::get_statistics()
+{
+	std::unique_lock<std::mutex> ul(_lock);
+	statistics                   stats = _statistics;
+	if (_latency_count > 0)
+		stats.latency_average = _latency_total / _latency_count;
+	return stats;
+}
+
+void gs::readback_ring::collect()
+{
+	for (auto& s : _slots) {
+		if (s.status == state::Consumed)
+			release(s);
+	}
+}
+
+gs::readback_ring::slot* gs::readback_ring::find_ready()
+{
+	slot* oldest = nullptr;
+	for (auto& s : _slots) {
+		if ((s.status == state::Staged) && ((_sequence - s.sequence) >= _latency)
+			&& (!oldest || (s.sequence < oldest->sequence))) {
+			oldest = &s;
+		}
+	}
+	return oldest;
+}
+
+bool gs::readback_ring::map(slot& s)
+{
+	uint8_t* data     = nullptr;
+	uint32_t linesize = 0;
+
+	auto start  = std::chrono::high_resolution_clock::now();
+	bool mapped = gs_stagesurface_map(s.surface, &data, &linesize);
+	auto end    = std::chrono::high_resolution_clock::now();
+	auto time   = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+
+	_statistics.map_maximum = std::max(_statistics.map_maximum, time);
+	if (time > STALL_THRESHOLD)
+		_statistics.stalls++;
+
+	if (!mapped) {
+		s.status = state::Free;
+		_statistics.dropped++;
+		return false;
+	}
+
+	s.info.data     = data;
+	s.info.linesize = linesize;
+	_statistics.mapped++;
+	return true;
+}
+
+void gs::readback_ring::release(slot& s)
+{
+	gs_stagesurface_unmap(s.surface);
+	s.status        = state::Free;
+	s.info.data     = nullptr;
+	s.info.linesize = 0;
+
+	auto now     = std::chrono::high_resolution_clock::now();
+	auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(now - s.staged_at);
+	_latency_total += latency;
+	_latency_count++;
+	_statistics.latency_maximum = std::max(_statistics.latency_maximum, latency);
+}
@@ -0,0 +1,156 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+#include "common.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace gs {
+	/** Ring of staging surfaces for reading textures back to the CPU without stalling the GPU.
+	 *
+	 * stage() copies a texture into a free surface and tags it. A surface is only mapped once 'latency' newer frames
+	 * have been staged after it, at which point the GPU has long finished the copy and mapping does not block. Mapped
+	 * frames are handed out either by try_map(), or to a consumer on a worker thread, which reads the mapped rows in
+	 * place. A surface stays in use until its frame is released, so a slow reader makes stage() drop new frames
+	 * instead of waiting.
+	 *
+	 * stage(), try_map(), unmap() and the destructor enter the graphics context themselves, always before taking the
+	 * internal lock, so they may be called with or without it held.
+	 */
+	class readback_ring {
+		public:
+		struct frame {
+			const uint8_t*  data;
+			uint32_t        linesize;
+			uint32_t        width;
+			uint32_t        height;
+			gs_color_format format;
+			uint64_t        tag;
+			std::size_t     index;
+		};
+
+		struct statistics {
+			uint64_t staged;  // Frames copied into a staging surface.
+			uint64_t mapped;  // Frames mapped for try_map() or the consumer.
+			uint64_t dropped; // Frames lost, either overwritten before being mapped or not staged at all.
+			uint64_t stalls;  // Maps that blocked the graphics thread anyway.
+
+			// Time from stage() until the frame was released.
+			std::chrono::nanoseconds latency_average;
+			std::chrono::nanoseconds latency_maximum;
+
+			// Time spent inside of gs_stagesurface_map.
+			std::chrono::nanoseconds map_maximum;
+		};
+
+		typedef std::function<void(frame const&)> consumer_t;
+
+		private:
+		enum class state {
+			Free,
+			Staged,
+			Mapped,
+			Consuming,
+			Consumed,
+		};
+
+		struct slot {
+			gs_stagesurf_t*                                surface;
+			state                                          status;
+			uint64_t                                       sequence;
+			frame                                          info;
+			std::chrono::high_resolution_clock::time_point staged_at;
+		};
+
+		std::size_t       _latency;
+		std::vector<slot> _slots;
+		uint64_t          _sequence;
+
+		consumer_t                        _consumer;
+		std::shared_ptr<util::threadpool> _threadpool;
+
+		std::mutex               _lock;
+		std::condition_variable  _released;
+		statistics               _statistics;
+		std::chrono::nanoseconds _latency_total;
+		uint64_t                 _latency_count;
+
+		public:
+		/** Create a ring with 'size' staging surfaces.
+		 *
+		 * \param latency Frames to stage after a frame before it is mapped, must be less than 'size'.
+		 */
+		readback_ring(std::size_t size = 3, std::size_t latency = 1);
+		~readback_ring();
+
+		/** Copy a texture into the ring.
+		 *
+		 * Reuses the oldest unmapped frame if no surface is free, and dispatches ready frames to the consumer.
+		 *
+		 * \return false if every surface is still mapped and the texture was dropped.
+		 */
+		bool stage(gs_texture_t* texture, uint64_t tag);
+
+		/** Map the oldest frame that is ready, without waiting for newer ones.
+		 *
+		 * \return true if a frame was mapped, which must then be released with unmap().
+		 */
+		bool try_map(frame& out);
+
+		void unmap(frame const& mapped);
+
+		/** Get the tag of the frame try_map() would map next, without mapping it.
+		 *
+		 * \return false if no frame is ready.
+		 */
+		bool peek(uint64_t& tag);
+
+		/** Drop the frame try_map() would map next, without mapping it.
+		 *
+		 * \return false if no frame is ready.
+		 */
+		bool discard();
+
+		/** Hand every frame that becomes ready to a consumer on the thread pool, instead of try_map().
+		 *
+		 * The mapped rows are only valid until the consumer returns.
+		 */
+		void set_consumer(consumer_t consumer, std::shared_ptr<util::threadpool> threadpool);
+
+		statistics get_statistics();
+
+		private:
+		// Unmap frames that consumers are done with. Requires the lock.
+		void collect();
+
+		// Find the oldest staged frame that has had enough frames after it. Requires the lock.
+		slot* find_ready();
+
+		// Map a staged frame and update the statistics. Requires the lock.
+		bool map(slot& s);
+
+		// Release a mapped frame and update the statistics. Requires the lock.
+		void release(slot& s);
+	};
+} // namespace gs
@@ -0,0 +1,199 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "obs-roi-channel.hpp"
+#include <algorithm>
+#include "obs/obs-tools.hpp"
+
+// Enough history to cover the frames that are in flight between rendering and encoding.
+#define HISTORY_SIZE 16
+
+obs::roi_channel::roi_channel() : _lock(), _entries() {}
+
+obs::roi_channel::~roi_channel() {}
+
+void obs::roi_channel::publish(obs_source_t* source, uint64_t timestamp,
+							   const std::vector<obs::roi_channel::region>& regions)
+{
+	if (!source)
+		return;
+
+	std::unique_lock<std::mutex> lock(_lock);
+
+	// Replace entries left behind by a source that used to live at the same address.
+	auto& e = _entries[source];
+	if (!e.source || !obs_weak_source_references_source(e.source.get(), source)) {
+		e.source = std::shared_ptr<obs_weak_source_t>(obs_source_get_weak_source(source), obs::obs_weak_source_deleter);
+		e.frames.clear();
+	}
+
+	// Frames are published in order, so updating the same frame only ever touches the newest one.
+	if (!e.frames.empty() && (e.frames.back().timestamp == timestamp)) {
+		e.frames.back().regions = regions;
+		return;
+	}
+
+	e.frames.push_back({timestamp, regions});
+	while (e.frames.size() > HISTORY_SIZE) {
+		e.frames.pop_front();
+	}
+}
+
+void obs::roi_channel::withdraw(obs_source_t* source)
+{
+	std::unique_lock<std::mutex> lock(_lock);
+	_entries.erase(source);
+}
+
+void obs::roi_channel::gather(uint64_t timestamp, uint64_t max_age, std::vector<obs::roi_channel::region>& regions)
+{
+	struct gather_data {
+		std::map<obs_source_t*, std::vector<obs::roi_channel::region>> sources;
+		std::vector<obs::roi_channel::region>*                         regions;
+		float_t                                                        width;
+		float_t                                                        height;
+	} data;
+	data.regions = &regions;
+
+	regions.clear();
+
+	{ // Pick the matching frame of every live source, without holding the lock while walking the scene.
+		std::unique_lock<std::mutex> lock(_lock);
+		for (auto it = _entries.begin(); it != _entries.end();) {
+			std::shared_ptr<obs_source_t> source{obs_weak_source_get_source(it->second.source.get()),
+												 obs::obs_source_deleter};
+			if (!source) {
+				it = _entries.erase(it);
+				continue;
+			}
+
+			for (auto frame = it->second.frames.rbegin(); frame != it->second.frames.rend(); frame++) {
+				if (frame->timestamp > timestamp)
+					continue;
+				if ((timestamp - frame->timestamp) <= max_age)
+					data.sources.emplace(it->first, frame->regions);
+				break;
+			}
+			it++;
+		}
+	}
+	if (data.sources.empty())
+		return;
+
+	obs_video_info ovi;
+	if (!obs_get_video_info(&ovi) || !ovi.base_width || !ovi.base_height)
+		return;
+	data.width  = static_cast<float_t>(ovi.base_width);
+	data.height = static_cast<float_t>(ovi.base_height);
+
+	// Find the scene that is currently on the program output.
+	std::shared_ptr<obs_source_t> program{obs_get_output_source(0), obs::obs_source_deleter};
+	if (program && (obs_source_get_type(program.get()) == OBS_SOURCE_TYPE_TRANSITION)) {
+		program = std::shared_ptr<obs_source_t>{obs_transition_get_active_source(program.get()),
+												obs::obs_source_deleter};
+	}
+	obs_scene_t* scene = program ? obs_scene_from_source(program.get()) : nullptr;
+	if (!scene)
+		return;
+
+	obs_scene_enum_items(
+		scene,
+		[](obs_scene_t*, obs_sceneitem_t* item, void* param) {
+			gather_data* data = reinterpret_cast<gather_data*>(param);
+			if (!obs_sceneitem_visible(item))
+				return true;
+
+			obs_source_t* source = obs_sceneitem_get_source(item);
+			auto          found  = data->sources.find(source);
+			if (found == data->sources.end())
+				return true;
+
+			float_t width  = static_cast<float_t>(obs_source_get_width(source));
+			float_t height = static_cast<float_t>(obs_source_get_height(source));
+			if ((width <= 0) || (height <= 0))
+				return true;
+
+			obs_sceneitem_crop crop;
+			obs_sceneitem_get_crop(item, &crop);
+			float_t crop_width  = std::max(width - static_cast<float_t>(crop.left + crop.right), 1.f);
+			float_t crop_height = std::max(height - static_cast<float_t>(crop.top + crop.bottom), 1.f);
+
+			// The box transform maps the unit square of the cropped source onto the canvas.
+			matrix4 box;
+			obs_sceneitem_get_box_transform(item, &box);
+
+			for (auto& region : found->second) {
+				float_t u[2] = {(region.x * width - static_cast<float_t>(crop.left)) / crop_width,
+								((region.x + region.width) * width - static_cast<float_t>(crop.left)) / crop_width};
+				float_t v[2] = {(region.y * height - static_cast<float_t>(crop.top)) / crop_height,
+								((region.y + region.height) * height - static_cast<float_t>(crop.top)) / crop_height};
+
+				// Rotated items are covered by the bounding box of the transformed region.
+				float_t x0 = data->width;
+				float_t y0 = data->height;
+				float_t x1 = 0;
+				float_t y1 = 0;
+				for (std::size_t idx = 0; idx < 4; idx++) {
+					vec3 pos;
+					vec3_set(&pos, std::clamp(u[idx & 1], 0.f, 1.f), std::clamp(v[idx >> 1], 0.f, 1.f), 0.f);
+					vec3_transform(&pos, &pos, &box);
+					x0 = std::min(x0, pos.x);
+					y0 = std::min(y0, pos.y);
+					x1 = std::max(x1, pos.x);
+					y1 = std::max(y1, pos.y);
+				}
+				x0 = std::clamp(x0, 0.f, data->width);
+				y0 = std::clamp(y0, 0.f, data->height);
+				x1 = std::clamp(x1, 0.f, data->width);
+				y1 = std::clamp(y1, 0.f, data->height);
+				if ((x1 <= x0) || (y1 <= y0))
+					continue;
+
+				obs::roi_channel::region mapped;
+				mapped.x      = x0 / data->width;
+				mapped.y      = y0 / data->height;
+				mapped.width  = (x1 - x0) / data->width;
+				mapped.height = (y1 - y0) / data->height;
+				mapped.weight = region.weight;
+				data->regions->push_back(mapped);
+			}
+
+			return true;
+		},
+		&data);
+}
+
+static std::shared_ptr<obs::roi_channel> _instance = nullptr;
+
+void obs::roi_channel::initialize()
+{
+	if (!_instance)
+		_instance = std::make_shared<obs::roi_channel>();
+}
+
+void obs::roi_channel::finalize()
+{
+	_instance.reset();
+}
+
+std::shared_ptr<obs::roi_channel> obs::roi_channel::get()
+{
+	return _instance;
+}
@@ -0,0 +1,88 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+#include "common.hpp"
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace obs {
+	/** Shares regions of interest between the filters that find them and the encoders that can use them.
+	 *
+	 * Filters publish regions relative to the source they are applied to, tagged with the time of the frame they
+	 * belong to. Encoders then gather all regions that are visible in the program output, mapped to the canvas.
+	 */
+	class roi_channel {
+		public:
+		struct region {
+			// Normalized to the publishing source, or to the canvas when gathered. Origin is at the top left.
+			float_t x;
+			float_t y;
+			float_t width;
+			float_t height;
+			// How much of the encoder's quality offset to apply to this region, from 0 to 1.
+			float_t weight;
+		};
+
+		private:
+		struct frame {
+			uint64_t                              timestamp;
+			std::vector<obs::roi_channel::region> regions;
+		};
+
+		struct entry {
+			std::shared_ptr<obs_weak_source_t> source;
+			std::deque<frame>                  frames;
+		};
+
+		std::mutex                     _lock;
+		std::map<obs_source_t*, entry> _entries;
+
+		public:
+		roi_channel();
+		~roi_channel();
+
+		/** Publish the regions of a source for the frame rendered at the given time.
+		 *
+		 * @param timestamp Frame time as given by obs_get_video_frame_time().
+		 */
+		void publish(obs_source_t* source, uint64_t timestamp, const std::vector<obs::roi_channel::region>& regions);
+
+		/** Forget everything a source has published. */
+		void withdraw(obs_source_t* source);
+
+		/** Gather the regions of all sources that are visible in the program scene, normalized to the canvas.
+		 *
+		 * For each source the newest frame that isn't newer than the timestamp is used, unless it is older than max_age
+		 * nanoseconds. Only sources placed directly in the program scene are considered.
+		 */
+		void gather(uint64_t timestamp, uint64_t max_age, std::vector<obs::roi_channel::region>& regions);
+
+		public: // Singleton
+		static void initialize();
+
+		static void finalize();
+
+		static std::shared_ptr<obs::roi_channel> get();
+	};
+} // namespace obs
@@ -24,6 +24,58 @@
 
 static std::shared_ptr<obs::source_tracker> source_tracker_instance;
 
+// Decide once which indices a source belongs to, so that enumeration never has to ask libobs again.
+static uint32_t classify(obs_source_t* source)
+{
+	uint32_t types = 0;
+	uint32_t flags = obs_source_get_output_flags(source);
+	switch (obs_source_get_type(source)) {
+	case OBS_SOURCE_TYPE_INPUT:
+		types |= 1u << uint32_t(obs::source_tracker::type::Source);
+		if (flags & OBS_SOURCE_AUDIO)
+			types |= 1u << uint32_t(obs::source_tracker::type::AudioSource);
+		if (flags & OBS_SOURCE_VIDEO)
+			types |= 1u << uint32_t(obs::source_tracker::type::VideoSource);
+		break;
+	case OBS_SOURCE_TYPE_TRANSITION:
+		types |= 1u << uint32_t(obs::source_tracker::type::Transition);
+		break;
+	case OBS_SOURCE_TYPE_SCENE:
+		types |= 1u << uint32_t(obs::source_tracker::type::Scene);
+		break;
+	default:
+		break;
+	}
+	return types;
+}
+
+void obs::source_tracker::insert(const std::string& name, obs_source_t* source, std::shared_ptr<obs_weak_source_t> weak)
+{
+	entry ent{weak, classify(source)};
+	for (size_t idx = 0; idx < _indices.size(); idx++) {
+		if (ent.types & (1u << idx)) {
+			_indices[idx].insert({name, weak});
+		}
+	}
+	_sources.insert({name, ent});
+}
+
+bool obs::source_tracker::erase(const std::string& name)
+{
+	auto found = _sources.find(name);
+	if (found == _sources.end()) {
+		return false;
+	}
+
+	for (size_t idx = 0; idx < _indices.size(); idx++) {
+		if (found->second.types & (1u << idx)) {
+			_indices[idx].erase(name);
+		}
+	}
+	_sources.erase(found);
+	return true;
+}
+
 void obs::source_tracker::source_create_handler(void* ptr, calldata_t* data) noexcept
 try {
 	obs::source_tracker* self = reinterpret_cast<obs::source_tracker*>(ptr);
@@ -45,10 +97,13 @@ try {
 		return;
 	}
 
-	{
+	uint64_t generation;
+	{ // The generation changes together with the sources, so that nobody caches an outdated list as current.
 		std::unique_lock<std::mutex> ul(self->_lock);
-		self->_sources.insert({std::string(name), {weak, obs::obs_weak_source_deleter}});
+		self->insert(std::string(name), target, {weak, obs::obs_weak_source_deleter});
+		generation = ++self->_generation;
 	}
+	self->changed(generation);
 } catch (...) {
 	DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
 }
@@ -69,14 +124,15 @@ try {
 		return;
 	}
 
+	uint64_t generation;
 	{
 		std::unique_lock<std::mutex> ul(self->_lock);
-		auto                         found = self->_sources.find(std::string(name));
-		if (found == self->_sources.end()) {
+		if (!self->erase(std::string(name))) {
 			return;
 		}
-		self->_sources.erase(found);
+		generation = ++self->_generation;
 	}
+	self->changed(generation);
 } catch (...) {
 	DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
 }
@@ -97,23 +153,26 @@ try {
 		return;
 	}
 
+	uint64_t generation;
 	{
 		std::unique_lock<std::mutex> ul(self->_lock);
-		auto                         found = self->_sources.find(std::string(prev_name));
-		if (found == self->_sources.end()) {
+
+		std::shared_ptr<obs_weak_source_t> weak;
+		if (auto found = self->_sources.find(std::string(prev_name)); found != self->_sources.end()) {
+			weak = found->second.weak;
+			self->erase(std::string(prev_name));
+		} else {
 			// Untracked source, insert.
-			obs_weak_source_t* weak = obs_source_get_weak_source(target);
-			if (!weak) {
+			obs_weak_source_t* ref = obs_source_get_weak_source(target);
+			if (!ref) {
 				return;
 			}
-			self->_sources.insert({new_name, {weak, obs::obs_weak_source_deleter}});
-			return;
+			weak = {ref, obs::obs_weak_source_deleter};
 		}
-
-		// Insert at new key, remove old pair.
-		self->_sources.insert({new_name, found->second});
-		self->_sources.erase(found);
+		self->insert(std::string(new_name), target, weak);
+		generation = ++self->_generation;
 	}
+	self->changed(generation);
 } catch (...) {
 	DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
 }
@@ -133,7 +192,7 @@ std::shared_ptr<obs::source_tracker> obs::source_tracker::get()
 	return source_tracker_instance;
 }
 
-obs::source_tracker::source_tracker()
+obs::source_tracker::source_tracker() : _sources(), _indices(), _lock(), _generation(0), _names()
 {
 	auto osi = obs_get_signal_handler();
 	signal_handler_connect(osi, "source_create", &source_create_handler, this);
@@ -150,6 +209,10 @@ obs::source_tracker::~source_tracker()
 		signal_handler_disconnect(osi, "source_rename", &source_rename_handler, this);
 	}
 
+	this->_names = {};
+	for (auto& index : this->_indices) {
+		index.clear();
+	}
 	this->_sources.clear();
 }
 
@@ -162,9 +225,9 @@ void obs::source_tracker::enumerate(enumerate_cb_t ecb, filter_cb_t fcb)
 		_clone = _sources;
 	}
 
-	for (auto kv : _clone) {
+	for (auto& kv : _clone) {
 		auto source =
-			std::shared_ptr<obs_source_t>(obs_weak_source_get_source(kv.second.get()), obs::obs_source_deleter);
+			std::shared_ptr<obs_source_t>(obs_weak_source_get_source(kv.second.weak.get()), obs::obs_source_deleter);
 		if (!source) {
 			continue;
 		}
@@ -183,29 +246,76 @@ void obs::source_tracker::enumerate(enumerate_cb_t ecb, filter_cb_t fcb)
 	}
 }
 
-bool obs::source_tracker::filter_sources(std::string, obs_source_t* source)
+void obs::source_tracker::enumerate(type type, enumerate_cb_t ecb)
+{
+	// Need func-local copy, otherwise we risk corruption if a new source is created or destroyed.
+	index_t _clone;
+	{
+		std::unique_lock<std::mutex> ul(_lock);
+		_clone = _indices.at(size_t(type));
+	}
+
+	for (auto& kv : _clone) {
+		auto source =
+			std::shared_ptr<obs_source_t>(obs_weak_source_get_source(kv.second.get()), obs::obs_source_deleter);
+		if (!source) {
+			continue;
+		}
+
+		if (ecb && ecb(kv.first, source.get())) {
+			break;
+		}
+	}
+}
+
+std::shared_ptr<const std::vector<std::string>> obs::source_tracker::get_names(type type)
+{
+	std::unique_lock<std::mutex> ul(_lock);
+
+	auto& names = _names.at(size_t(type));
+	if (!names.list || (names.generation != _generation.load())) {
+		auto& index = _indices.at(size_t(type));
+		auto  list  = std::make_shared<std::vector<std::string>>();
+		list->reserve(index.size());
+		for (auto& kv : index) {
+			// Sources that are being destroyed only leave the index once their destroy signal arrives.
+			if (!obs_weak_source_expired(kv.second.get()))
+				list->push_back(kv.first);
+		}
+		names.list       = list;
+		names.generation = _generation.load();
+	}
+	return names.list;
+}
+
+uint64_t obs::source_tracker::get_generation()
+{
+	return _generation.load();
+}
+
+bool obs::source_tracker::filter_sources(const std::string&, obs_source_t* source)
 {
 	return (obs_source_get_type(source) != OBS_SOURCE_TYPE_INPUT);
 }
 
-bool obs::source_tracker::filter_audio_sources(std::string, obs_source_t* source)
+bool obs::source_tracker::filter_audio_sources(const std::string&, obs_source_t* source)
 {
 	uint32_t flags = obs_source_get_output_flags(source);
 	return !(flags & OBS_SOURCE_AUDIO) || (obs_source_get_type(source) != OBS_SOURCE_TYPE_INPUT);
 }
 
-bool obs::source_tracker::filter_video_sources(std::string, obs_source_t* source)
+bool obs::source_tracker::filter_video_sources(const std::string&, obs_source_t* source)
 {
 	uint32_t flags = obs_source_get_output_flags(source);
 	return !(flags & OBS_SOURCE_VIDEO) || (obs_source_get_type(source) != OBS_SOURCE_TYPE_INPUT);
 }
 
-bool obs::source_tracker::filter_transitions(std::string, obs_source_t* source)
+bool obs::source_tracker::filter_transitions(const std::string&, obs_source_t* source)
 {
 	return (obs_source_get_type(source) != OBS_SOURCE_TYPE_TRANSITION);
 }
 
-bool obs::source_tracker::filter_scenes(std::string, obs_source_t* source)
+bool obs::source_tracker::filter_scenes(const std::string&, obs_source_t* source)
 {
 	return (obs_source_get_type(source) != OBS_SOURCE_TYPE_SCENE);
 }
@@ -19,19 +19,52 @@
 
 #pragma once
 #include "common.hpp"
+#include <array>
+#include <atomic>
 #include <functional>
 #include <map>
 #include <mutex>
+#include "util/util-event.hpp"
 
 namespace obs {
 	class source_tracker {
-		std::map<std::string, std::shared_ptr<obs_weak_source_t>> _sources;
-		std::mutex                                                _lock;
+		public:
+		// Indices kept by the tracker, a source may be part of several of them.
+		enum class type : uint8_t {
+			Source,      // Inputs
+			AudioSource, // Inputs with audio
+			VideoSource, // Inputs with video
+			Transition,
+			Scene,
+			_Count,
+		};
+
+		private:
+		typedef std::map<std::string, std::shared_ptr<obs_weak_source_t>> index_t;
+
+		struct entry {
+			std::shared_ptr<obs_weak_source_t> weak;
+			uint32_t                           types; // Bitmask of (1 << type).
+		};
+
+		std::map<std::string, entry>              _sources;
+		std::array<index_t, size_t(type::_Count)> _indices;
+		std::mutex                                _lock;
+		std::atomic<uint64_t>                     _generation;
+
+		struct names {
+			uint64_t                                        generation = 0;
+			std::shared_ptr<const std::vector<std::string>> list;
+		};
+		std::array<names, size_t(type::_Count)> _names;
 
 		static void source_create_handler(void* ptr, calldata_t* data) noexcept;
 		static void source_destroy_handler(void* ptr, calldata_t* data) noexcept;
 		static void source_rename_handler(void* ptr, calldata_t* data) noexcept;
 
+		void insert(const std::string& name, obs_source_t* source, std::shared_ptr<obs_weak_source_t> weak);
+		bool erase(const std::string& name);
+
 		public: // Singleton
 		static void                                 initialize();
 		static void                                 finalize();
@@ -47,14 +80,14 @@ namespace obs {
 		// @param std::string Name of the Source
 		// @param obs_source_t* Source
 		// @return true to abort enumeration, false to keep going.
-		typedef std::function<bool(std::string, obs_source_t*)> enumerate_cb_t;
+		typedef std::function<bool(const std::string&, obs_source_t*)> enumerate_cb_t;
 
 		// Filter function for enumerating sources.
 		//
 		// @param std::string Name of the Source
 		// @param obs_source_t* Source
 		// @return true to skip, false to pass along.
-		typedef std::function<bool(std::string, obs_source_t*)> filter_cb_t;
+		typedef std::function<bool(const std::string&, obs_source_t*)> filter_cb_t;
 
 		//! Enumerate all tracked sources
 		//
@@ -62,11 +95,29 @@ namespace obs {
 		// @param filter_cb Filter function to narrow down results.
 		void enumerate(enumerate_cb_t enumerate_cb, filter_cb_t filter_cb = nullptr);
 
+		//! Enumerate all tracked sources of a type, without walking any other source.
+		//
+		// @param type The index to enumerate.
+		// @param enumerate_cb The function called for each tracked source.
+		void enumerate(type type, enumerate_cb_t enumerate_cb);
+
+		//! Sorted names of all tracked sources of a type.
+		//
+		// The list is shared and only rebuilt after the tracked sources changed, so property dialogs can call this
+		// as often as they like.
+		std::shared_ptr<const std::vector<std::string>> get_names(type type);
+
+		//! Incremented every time a source is added, removed or renamed.
+		uint64_t get_generation();
+
+		//! Signalled with the new generation after every change, from whichever thread caused the change.
+		util::event<uint64_t> changed;
+
 		public:
-		static bool filter_sources(std::string name, obs_source_t* source);
-		static bool filter_audio_sources(std::string name, obs_source_t* source);
-		static bool filter_video_sources(std::string name, obs_source_t* source);
-		static bool filter_transitions(std::string name, obs_source_t* source);
-		static bool filter_scenes(std::string name, obs_source_t* source);
+		static bool filter_sources(const std::string& name, obs_source_t* source);
+		static bool filter_audio_sources(const std::string& name, obs_source_t* source);
+		static bool filter_video_sources(const std::string& name, obs_source_t* source);
+		static bool filter_transitions(const std::string& name, obs_source_t* source);
+		static bool filter_scenes(const std::string& name, obs_source_t* source);
 	};
 } // namespace obs
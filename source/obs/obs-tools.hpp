@@ -96,4 +96,9 @@ namespace obs {
 	{
 		obs_data_release(v);
 	}
+
+	inline void obs_data_array_deleter(obs_data_array_t* v)
+	{
+		obs_data_array_release(v);
+	}
 } // namespace obs
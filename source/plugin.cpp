@@ -21,8 +21,12 @@
 #include <fstream>
 #include <stdexcept>
 #include "configuration.hpp"
+#include "gfx/gfx-resolution-governor.hpp"
+#include "gfx/gfx-source-texture.hpp"
 #include "obs/gs/gs-vertexbuffer.hpp"
+#include "obs/obs-roi-channel.hpp"
 #include "obs/obs-source-tracker.hpp"
+#include "util/util-startup.hpp"
 
 #ifdef ENABLE_ENCODER_FFMPEG
 #include "encoders/encoder-ffmpeg.hpp"
@@ -86,11 +90,16 @@ try {
 	// Initialize global Thread Pool.
 	_threadpool = std::make_shared<util::threadpool>();
 
-	// Initialize Source Tracker
-	obs::source_tracker::initialize();
+	// Everything else declares what it depends on, so that a failure only takes down what needs it. Slow work that
+	// touches neither libOBS nor the graphics subsystem is prepared on the thread pool in the meantime.
+	util::startup startup;
 
-	// GS Stuff
-	{
+	// Core
+	startup.add("Source Tracker", {}, obs::source_tracker::initialize);
+	startup.add("Region of Interest Channel", {}, obs::roi_channel::initialize);
+	startup.add("Resolution Governor", {}, gfx::resolution_governor::initialize);
+	startup.add("Source Capture Cache", {}, gfx::source_capture_cache::initialize);
+	startup.add("Graphics", {}, []() {
 		_gs_fstri_vb = std::make_shared<gs::vertex_buffer>(uint32_t(3), uint8_t(1));
 		{
 			auto vtx = _gs_fstri_vb->at(0);
@@ -108,66 +117,78 @@ try {
 			vec4_set(vtx.uv[0], 0, 2, 0, 0);
 		}
 		_gs_fstri_vb->update();
-	}
+	});
 
 	// Encoders
 	{
 #ifdef ENABLE_ENCODER_FFMPEG
 		using namespace streamfx::encoder::ffmpeg;
-		ffmpeg_manager::initialize();
+		startup.add("FFmpeg Encoders", {"Region of Interest Channel", "Graphics"}, ffmpeg_manager::initialize,
+					ffmpeg_manager::prepare);
 #endif
 	}
 
 	// Filters
 	{
 #ifdef ENABLE_FILTER_BLUR
-		streamfx::filter::blur::blur_factory::initialize();
+		startup.add("Blur Filter", {"Source Tracker", "Resolution Governor", "Source Capture Cache", "Graphics"},
+					streamfx::filter::blur::blur_factory::initialize);
 #endif
 #ifdef ENABLE_FILTER_COLOR_GRADE
-		streamfx::filter::color_grade::color_grade_factory::initialize();
+		startup.add("Color Grade Filter", {"Graphics"}, streamfx::filter::color_grade::color_grade_factory::initialize);
 #endif
 #ifdef ENABLE_FILTER_DISPLACEMENT
-		streamfx::filter::displacement::displacement_factory::initialize();
+		startup.add("Displacement Filter", {}, streamfx::filter::displacement::displacement_factory::initialize);
 #endif
 #ifdef ENABLE_FILTER_DYNAMIC_MASK
-		streamfx::filter::dynamic_mask::dynamic_mask_factory::initialize();
+		startup.add("Dynamic Mask Filter", {"Source Tracker", "Source Capture Cache", "Graphics"},
+					streamfx::filter::dynamic_mask::dynamic_mask_factory::initialize);
 #endif
 #ifdef ENABLE_FILTER_NVIDIA_FACE_TRACKING
-		streamfx::filter::nvidia::face_tracking_factory::initialize();
+		startup.add("Face Tracking Filter", {"Region of Interest Channel"},
+					streamfx::filter::nvidia::face_tracking_factory::initialize);
 #endif
 #ifdef ENABLE_FILTER_SDF_EFFECTS
-		streamfx::filter::sdf_effects::sdf_effects_factory::initialize();
+		startup.add("SDF Effects Filter", {"Resolution Governor", "Graphics"},
+					streamfx::filter::sdf_effects::sdf_effects_factory::initialize);
 #endif
 #ifdef ENABLE_FILTER_SHADER
-		streamfx::filter::shader::shader_factory::initialize();
+		startup.add("Shader Filter", {"Resolution Governor", "Source Capture Cache", "Graphics"},
+					streamfx::filter::shader::shader_factory::initialize);
 #endif
 #ifdef ENABLE_FILTER_TRANSFORM
-		streamfx::filter::transform::transform_factory::initialize();
+		startup.add("Transform Filter", {}, streamfx::filter::transform::transform_factory::initialize);
 #endif
 	}
 
 	// Sources
 	{
 #ifdef ENABLE_SOURCE_MIRROR
-		streamfx::source::mirror::mirror_factory::initialize();
+		startup.add("Mirror Source", {"Source Tracker", "Source Capture Cache"},
+					streamfx::source::mirror::mirror_factory::initialize);
 #endif
 #ifdef ENABLE_SOURCE_SHADER
-		streamfx::source::shader::shader_factory::initialize();
+		startup.add("Shader Source", {"Resolution Governor", "Source Capture Cache", "Graphics"},
+					streamfx::source::shader::shader_factory::initialize);
 #endif
 	}
 
 	// Transitions
 	{
 #ifdef ENABLE_TRANSITION_SHADER
-		streamfx::transition::shader::shader_factory::initialize();
+		startup.add("Shader Transition", {"Resolution Governor", "Source Capture Cache", "Graphics"},
+					streamfx::transition::shader::shader_factory::initialize);
 #endif
 	}
 
 // Frontend
 #ifdef ENABLE_FRONTEND
-	streamfx::ui::handler::initialize();
+	startup.add("Frontend", {}, streamfx::ui::handler::initialize);
 #endif
 
+	// A failed step has already been logged and only takes down what depends on it.
+	startup.run(_threadpool);
+
 	DLOG_INFO("Loaded Version %s", STREAMFX_VERSION_STRING);
 	return true;
 } catch (...) {
@@ -241,6 +262,15 @@ try {
 		_gs_fstri_vb.reset();
 	}
 
+	// Finalize Source Capture Cache
+	gfx::source_capture_cache::finalize();
+
+	// Finalize Resolution Governor
+	gfx::resolution_governor::finalize();
+
+	// Finalize Region of Interest Channel
+	obs::roi_channel::finalize();
+
 	// Finalize Source Tracker
 	obs::source_tracker::finalize();
 
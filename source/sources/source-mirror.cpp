@@ -19,7 +19,10 @@
 
 #include "source-mirror.hpp"
 #include "strings.hpp"
+#include <algorithm>
 #include <bitset>
+#include <cinttypes>
+#include <cstdlib>
 #include <cstring>
 #include <functional>
 #include <memory>
@@ -48,32 +51,14 @@
 
 using namespace streamfx::source::mirror;
 
-mirror_audio_data::mirror_audio_data(const audio_data* audio, speaker_layout layout)
-{
-	// Build a clone of a packet.
-	audio_t*                 oad = obs_get_audio();
-	const audio_output_info* aoi = audio_output_get_info(oad);
-	osa.frames                   = audio->frames;
-	osa.timestamp                = audio->timestamp;
-	osa.speakers                 = layout;
-	osa.format                   = aoi->format;
-	osa.samples_per_sec          = aoi->samples_per_sec;
-	data.resize(MAX_AV_PLANES);
-	for (std::size_t idx = 0; idx < MAX_AV_PLANES; idx++) {
-		if (!audio->data[idx]) {
-			osa.data[idx] = nullptr;
-			continue;
-		}
-
-		data[idx].resize(audio->frames * get_audio_bytes_per_channel(osa.format));
-		memcpy(data[idx].data(), audio->data[idx], data[idx].size());
-		osa.data[idx] = data[idx].data();
-	}
-}
+// Blocks in the audio ring, at 1024 frames per block this is about half a second of audio at 48kHz.
+#define AUDIO_RING_BLOCKS 32
 
 mirror_instance::mirror_instance(obs_data_t* settings, obs_source_t* self)
 	: obs::source_instance(settings, self), _source(), _source_child(), _signal_rename(), _audio_enabled(false),
-	  _audio_layout(SPEAKERS_UNKNOWN)
+	  _audio_layout(SPEAKERS_UNKNOWN), _audio_format(AUDIO_FORMAT_UNKNOWN), _audio_samples_per_sec(0),
+	  _audio_frame_size(0), _audio_ring(), _audio_thread(), _audio_lock(), _audio_cv(), _audio_stop(false),
+	  _audio_stats()
 {
 	update(settings);
 }
@@ -187,6 +172,7 @@ try {
 
 	// Listen to any audio the source spews out.
 	if (_audio_enabled) {
+		audio_start();
 		_signal_audio = std::make_shared<obs::audio_signal_handler>(_source);
 		_signal_audio->event.add(std::bind(&mirror_instance::on_audio, this, std::placeholders::_1,
 										   std::placeholders::_2, std::placeholders::_3));
@@ -197,7 +183,9 @@ try {
 
 void mirror_instance::release()
 {
+	// Removing the capture callback waits for any callback in progress, so the ring has no producer afterwards.
 	_signal_audio.reset();
+	audio_stop();
 	_signal_rename.reset();
 	_source_child.reset();
 	_source.reset();
@@ -252,21 +240,134 @@ void mirror_instance::on_audio(std::shared_ptr<obs_source_t>, const audio_data*
 		}
 	}
 
+	// Split the packet into blocks that fit into the preallocated ring, so that nothing is allocated here.
+	const std::size_t block_frames = AUDIO_OUTPUT_FRAMES;
+	for (std::size_t offset = 0; offset < audio->frames; offset += block_frames) {
+		auto block = _audio_ring->write_slot();
+		if (!block) {
+			// The forwarder is not keeping up, dropping is the only option that doesn't block the audio thread.
+			_audio_stats.dropped.fetch_add(1, std::memory_order_relaxed);
+			continue;
+		}
+
+		std::size_t frames = std::min<std::size_t>(audio->frames - offset, block_frames);
+		std::size_t size   = frames * _audio_frame_size;
+
+		block->osa.frames          = static_cast<uint32_t>(frames);
+		block->osa.timestamp       = audio->timestamp + audio_frames_to_ns(_audio_samples_per_sec, offset);
+		block->osa.speakers        = detected_layout;
+		block->osa.format          = _audio_format;
+		block->osa.samples_per_sec = _audio_samples_per_sec;
+		for (std::size_t idx = 0, plane = 0; idx < MAX_AV_PLANES; idx++) {
+			if (!audio->data[idx]) {
+				block->osa.data[idx] = nullptr;
+				continue;
+			}
+
+			uint8_t* ptr = block->buffer.data() + (block_frames * _audio_frame_size * plane++);
+			if (ptr >= (block->buffer.data() + block->buffer.size())) {
+				// More planes than the output has, which can't be represented anyway.
+				block->osa.data[idx] = nullptr;
+				continue;
+			}
+			memcpy(ptr, audio->data[idx] + (offset * _audio_frame_size), size);
+			block->osa.data[idx] = ptr;
+		}
+		block->queued = os_gettime_ns();
+		_audio_ring->commit_write();
+		_audio_stats.blocks.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// Taking the lock here is uncontended unless the forwarder is about to sleep, in which case it prevents a lost
+	// wake-up. The lock is not held while notifying.
 	{
-		std::unique_lock<std::mutex> ul(_audio_queue_lock);
-		_audio_queue.emplace(audio, detected_layout);
+		std::unique_lock<std::mutex> ul(_audio_lock);
+	}
+	_audio_cv.notify_one();
+}
+
+void mirror_instance::audio_start()
+{
+	// Size the ring from the audio output, so that no block ever has to grow.
+	audio_t*                 oad = obs_get_audio();
+	const audio_output_info* aoi = audio_output_get_info(oad);
+	_audio_format                = aoi->format;
+	_audio_samples_per_sec       = aoi->samples_per_sec;
+	_audio_frame_size            = get_audio_size(aoi->format, aoi->speakers, 1);
+
+	std::size_t block_size = AUDIO_OUTPUT_FRAMES * _audio_frame_size * get_audio_planes(aoi->format, aoi->speakers);
+
+	_audio_ring = std::make_unique<util::spsc_ring<mirror_audio_data>>(AUDIO_RING_BLOCKS);
+	for (auto& block : _audio_ring->slots()) {
+		block.buffer.resize(block_size);
 	}
 
-	// Create a clone of the audio data and push it to the thread pool.
-	streamfx::threadpool()->push(std::bind(&mirror_instance::audio_output, this, std::placeholders::_1), nullptr);
+	_audio_stats.allocated = block_size * _audio_ring->capacity();
+	_audio_stats.blocks.store(0);
+	_audio_stats.dropped.store(0);
+	_audio_stats.forwarded      = 0;
+	_audio_stats.latency_total  = 0;
+	_audio_stats.latency_max    = 0;
+	_audio_stats.jitter_total   = 0;
+	_audio_stats.jitter_max     = 0;
+	_audio_stats.last_output    = 0;
+	_audio_stats.last_timestamp = 0;
+
+	_audio_stop   = false;
+	_audio_thread = std::thread(&mirror_instance::audio_forwarder, this);
+}
+
+void mirror_instance::audio_stop()
+{
+	if (!_audio_thread.joinable())
+		return;
+
+	{
+		std::unique_lock<std::mutex> ul(_audio_lock);
+		_audio_stop = true;
+	}
+	_audio_cv.notify_all();
+	_audio_thread.join();
+
+	uint64_t forwarded = std::max<uint64_t>(_audio_stats.forwarded, 1);
+	DLOG_INFO("<Source Mirror> '%s' forwarded %" PRIu64 " of %" PRIu64 " audio blocks (%" PRIu64 " dropped) "
+			  "with %zu KiB preallocated. Latency avg %.3f ms, max %.3f ms. Jitter avg %.3f ms, max %.3f ms.",
+			  obs_source_get_name(_self), _audio_stats.forwarded, _audio_stats.blocks.load(),
+			  _audio_stats.dropped.load(), _audio_stats.allocated / 1024,
+			  double_t(_audio_stats.latency_total) / forwarded / 1000000.0, _audio_stats.latency_max / 1000000.0,
+			  double_t(_audio_stats.jitter_total) / forwarded / 1000000.0, _audio_stats.jitter_max / 1000000.0);
+
+	_audio_ring.reset();
 }
 
-void mirror_instance::audio_output(std::shared_ptr<void> data)
+void mirror_instance::audio_forwarder()
 {
-	std::unique_lock<std::mutex> ul(_audio_queue_lock);
-	while (_audio_queue.size() > 0) {
-		obs_source_output_audio(_self, &((_audio_queue.front()).osa));
-		_audio_queue.pop();
+	std::unique_lock<std::mutex> ul(_audio_lock);
+	while (!_audio_stop) {
+		ul.unlock();
+		while (auto block = _audio_ring->read_slot()) {
+			uint64_t now     = os_gettime_ns();
+			uint64_t latency = now - block->queued;
+			_audio_stats.latency_total += latency;
+			_audio_stats.latency_max = std::max(_audio_stats.latency_max, latency);
+
+			// Jitter is the difference between how far apart blocks were output, and how far apart they should be.
+			if (_audio_stats.last_output != 0) {
+				int64_t  expected = int64_t(block->osa.timestamp - _audio_stats.last_timestamp);
+				int64_t  actual   = int64_t(now - _audio_stats.last_output);
+				uint64_t jitter   = uint64_t(std::abs(actual - expected));
+				_audio_stats.jitter_total += jitter;
+				_audio_stats.jitter_max = std::max(_audio_stats.jitter_max, jitter);
+			}
+			_audio_stats.last_output    = now;
+			_audio_stats.last_timestamp = block->osa.timestamp;
+
+			obs_source_output_audio(_self, &block->osa);
+			_audio_ring->commit_read();
+			_audio_stats.forwarded++;
+		}
+		ul.lock();
+		_audio_cv.wait(ul, [this]() { return _audio_stop || !_audio_ring->empty(); });
 	}
 }
 
@@ -320,22 +421,17 @@ obs_properties_t* mirror_factory::get_properties2(mirror_instance* data)
 		obs_property_set_modified_callback(p, modified_properties);
 
 		obs_property_list_add_string(p, "", "");
-		obs::source_tracker::get()->enumerate(
-			[&p](std::string name, obs_source_t*) {
-				std::stringstream sstr;
-				sstr << name << " (" << D_TRANSLATE(S_SOURCETYPE_SOURCE) << ")";
-				obs_property_list_add_string(p, sstr.str().c_str(), name.c_str());
-				return false;
-			},
-			obs::source_tracker::filter_sources);
-		obs::source_tracker::get()->enumerate(
-			[&p](std::string name, obs_source_t*) {
-				std::stringstream sstr;
-				sstr << name << " (" << D_TRANSLATE(S_SOURCETYPE_SCENE) << ")";
-				obs_property_list_add_string(p, sstr.str().c_str(), name.c_str());
-				return false;
-			},
-			obs::source_tracker::filter_scenes);
+		auto tracker = obs::source_tracker::get();
+		for (auto& name : *tracker->get_names(obs::source_tracker::type::Source)) {
+			std::stringstream sstr;
+			sstr << name << " (" << D_TRANSLATE(S_SOURCETYPE_SOURCE) << ")";
+			obs_property_list_add_string(p, sstr.str().c_str(), name.c_str());
+		}
+		for (auto& name : *tracker->get_names(obs::source_tracker::type::Scene)) {
+			std::stringstream sstr;
+			sstr << name << " (" << D_TRANSLATE(S_SOURCETYPE_SCENE) << ")";
+			obs_property_list_add_string(p, sstr.str().c_str(), name.c_str());
+		}
 	}
 
 	{
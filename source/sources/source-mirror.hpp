@@ -19,9 +19,9 @@
 
 #pragma once
 #include "common.hpp"
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
-#include <queue>
 #include <thread>
 #include <vector>
 #include "gfx/gfx-source-texture.hpp"
@@ -31,13 +31,13 @@
 #include "obs/obs-source-factory.hpp"
 #include "obs/obs-source.hpp"
 #include "obs/obs-tools.hpp"
+#include "util/util-spsc-ring.hpp"
 
 namespace streamfx::source::mirror {
 	struct mirror_audio_data {
-		mirror_audio_data(const audio_data*, speaker_layout);
-
-		obs_source_audio                  osa;
-		std::vector<std::vector<uint8_t>> data;
+		obs_source_audio     osa;
+		std::vector<uint8_t> buffer; // All planes, preallocated for the largest possible block.
+		uint64_t             queued; // Time at which the block was queued, for statistics.
 	};
 
 	class mirror_instance : public obs::source_instance {
@@ -49,10 +49,29 @@ namespace streamfx::source::mirror {
 		std::pair<uint32_t, uint32_t>               _source_size;
 
 		// Audio
-		bool                          _audio_enabled;
-		speaker_layout                _audio_layout;
-		std::mutex                    _audio_queue_lock;
-		std::queue<mirror_audio_data> _audio_queue;
+		bool                                                _audio_enabled;
+		speaker_layout                                      _audio_layout;
+		audio_format                                        _audio_format;
+		uint32_t                                            _audio_samples_per_sec;
+		std::size_t                                         _audio_frame_size;
+		std::unique_ptr<util::spsc_ring<mirror_audio_data>> _audio_ring;
+		std::thread                                         _audio_thread;
+		std::mutex                                          _audio_lock;
+		std::condition_variable                             _audio_cv;
+		bool                                                _audio_stop;
+
+		struct {
+			std::size_t           allocated; // Bytes preallocated for the ring.
+			std::atomic<uint64_t> blocks;    // Blocks queued by the producer.
+			std::atomic<uint64_t> dropped;   // Blocks dropped because the ring was full.
+			uint64_t              forwarded;
+			uint64_t              latency_total;
+			uint64_t              latency_max;
+			uint64_t              jitter_total;
+			uint64_t              jitter_max;
+			uint64_t              last_output;
+			uint64_t              last_timestamp;
+		} _audio_stats;
 
 		public:
 		mirror_instance(obs_data_t* settings, obs_source_t* self);
@@ -79,7 +98,9 @@ namespace streamfx::source::mirror {
 		void on_rename(std::shared_ptr<obs_source_t>, calldata*);
 		void on_audio(std::shared_ptr<obs_source_t>, const struct audio_data*, bool);
 
-		void audio_output(std::shared_ptr<void> data);
+		void audio_start();
+		void audio_stop();
+		void audio_forwarder();
 	};
 
 	class mirror_factory : public obs::source_factory<source::mirror::mirror_factory, source::mirror::mirror_instance> {
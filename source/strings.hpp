@@ -31,6 +31,8 @@
 #define S_FILEFILTERS_VIDEO "*.mkv *.webm *.mp4 *.mov *.flv"
 #define S_FILEFILTERS_SOUND "*.ogg *.flac *.mp3 *.wav"
 #define S_FILEFILTERS_EFFECT "*.effect *.txt"
+#define S_FILEFILTERS_LUT "*.cube"
+#define S_FILEFILTERS_TEXT "*.txt"
 #define S_FILEFILTERS_ANY "*.*"
 
 #define S_VERSION "Version"
@@ -38,6 +40,8 @@
 
 #define S_ADVANCED "Advanced"
 
+#define S_DYNAMICRESOLUTION "DynamicResolution"
+
 #define S_STATE_DEFAULT "State.Default"
 #define S_STATE_DISABLED "State.Disabled"
 #define S_STATE_ENABLED "State.Enabled"
@@ -19,21 +19,79 @@
 
 #pragma once
 #include "common.hpp"
+#include <atomic>
 #include <functional>
-#include <list>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 namespace util {
+	/** Event with copy-on-write listeners.
+	 *
+	 * Calling the event works on an immutable snapshot of the listeners and never takes the event's lock, so a slow
+	 * listener or a thread changing the listeners can't delay any other thread calling the same event. Changes copy
+	 * the snapshot and publish the new one with a compare-and-swap, retrying only if another change won the race.
+	 * Only changes that make the event empty or non-empty take the lock, to run the listen and silence callbacks in
+	 * order. Loading and swapping the snapshot relies on the std::shared_ptr atomics, which the standard library may
+	 * implement with a short internal spinlock, so neither side is strictly wait-free.
+	 *
+	 * As with any read-copy-update scheme, a call already in progress may still reach a listener that was just
+	 * removed. Owners must keep whatever a listener touches alive until the source of the calls is gone.
+	 */
 	template<typename... _args>
 	class event {
-		std::list<std::function<void(_args...)>> _listeners;
-		std::recursive_mutex                     _lock;
+		typedef std::vector<std::function<void(_args...)>> listeners_t;
+
+		std::shared_ptr<const listeners_t> _listeners;
+		std::recursive_mutex               _lock; // Orders the callbacks only, never held while calling.
+		bool                               _filled;
 
 		std::function<void()> _cb_fill;
 		std::function<void()> _cb_clear;
 
+		std::shared_ptr<const listeners_t> snapshot()
+		{
+			return std::atomic_load_explicit(&_listeners, std::memory_order_acquire);
+		}
+
+		void publish(std::shared_ptr<const listeners_t> listeners)
+		{
+			std::atomic_store_explicit(&_listeners, listeners, std::memory_order_release);
+		}
+
+		// Apply a change to a copy of the snapshot and publish it, unless another change was published in between.
+		template<typename _modify>
+		bool update(_modify modify)
+		{
+			auto                               current = snapshot();
+			std::shared_ptr<const listeners_t> next;
+			do {
+				auto listeners = std::make_shared<listeners_t>(*current);
+				modify(*listeners);
+				next = listeners;
+			} while (!std::atomic_compare_exchange_weak_explicit(&_listeners, &current, next, std::memory_order_acq_rel,
+																 std::memory_order_acquire));
+			return current->empty() != next->empty();
+		}
+
+		// Run the listen or silence callback if the latest snapshot differs from what they were last told.
+		void reconcile()
+		{
+			std::lock_guard<std::recursive_mutex> lg(_lock);
+			bool                                  filled = !snapshot()->empty();
+			if (filled == _filled)
+				return;
+
+			_filled = filled;
+			if (filled && _cb_fill) {
+				_cb_fill();
+			} else if (!filled && _cb_clear) {
+				_cb_clear();
+			}
+		}
+
 		public /* constructor */:
-		event() : _listeners(), _lock(), _cb_fill(), _cb_clear() {}
+		event() : _listeners(std::make_shared<const listeners_t>()), _lock(), _filled(false), _cb_fill(), _cb_clear() {}
 		virtual ~event()
 		{
 			std::lock_guard<std::recursive_mutex> lg(_lock);
@@ -49,7 +107,10 @@ namespace util {
 			std::lock_guard<std::recursive_mutex> lg(_lock);
 			std::lock_guard<std::recursive_mutex> lgo(other._lock);
 
-			_listeners.swap(other._listeners);
+			auto listeners = snapshot();
+			publish(other.snapshot());
+			other.publish(listeners);
+			std::swap(_filled, other._filled);
 			_cb_fill.swap(other._cb_fill);
 			_cb_clear.swap(other._cb_clear);
 		}
@@ -65,7 +126,10 @@ namespace util {
 			std::lock_guard<std::recursive_mutex> lg(_lock);
 			std::lock_guard<std::recursive_mutex> lgo(other._lock);
 
-			_listeners.swap(other._listeners);
+			auto listeners = snapshot();
+			publish(other.snapshot());
+			other.publish(listeners);
+			std::swap(_filled, other._filled);
 			_cb_fill.swap(other._cb_fill);
 			_cb_clear.swap(other._cb_clear);
 
@@ -82,8 +146,9 @@ namespace util {
 		template<typename... _largs>
 		inline void call(_args... args)
 		{
-			std::lock_guard<std::recursive_mutex> lg(_lock);
-			for (auto& l : _listeners) {
+			// The snapshot keeps the listeners alive for the duration of the call, even if they are replaced.
+			auto listeners = snapshot();
+			for (auto& l : *listeners) {
 				l(args...);
 			}
 		}
@@ -95,13 +160,8 @@ namespace util {
 		 */
 		inline void add(std::function<void(_args...)> listener)
 		{
-			std::lock_guard<std::recursive_mutex> lg(_lock);
-			if (_listeners.size() == 0) {
-				if (_cb_fill) {
-					_cb_fill();
-				}
-			}
-			_listeners.push_back(listener);
+			if (update([&listener](listeners_t& listeners) { listeners.push_back(listener); }))
+				reconcile();
 		}
 		inline event<_args...>& operator+=(std::function<void(_args...)> listener)
 		{
@@ -114,13 +174,10 @@ namespace util {
 		 */
 		inline void remove(std::function<void(_args...)> listener)
 		{
-			std::lock_guard<std::recursive_mutex> lg(_lock);
-			_listeners.remove(listener);
-			if (_listeners.size() == 0) {
-				if (_cb_clear) {
-					_cb_clear();
-				}
-			}
+			if (update([&listener](listeners_t& listeners) {
+					listeners.erase(std::remove(listeners.begin(), listeners.end(), listener), listeners.end());
+				}))
+				reconcile();
 		}
 		inline event<_args...>& operator-=(std::function<void(_args...)> listener)
 		{
@@ -133,8 +190,7 @@ namespace util {
 		 */
 		inline bool empty()
 		{
-			std::lock_guard<std::recursive_mutex> lg(_lock);
-			return _listeners.empty();
+			return snapshot()->empty();
 		}
 		inline operator bool()
 		{
@@ -145,11 +201,8 @@ namespace util {
 		 */
 		inline void clear()
 		{
-			std::lock_guard<std::recursive_mutex> lg(_lock);
-			_listeners.clear();
-			if (_cb_clear) {
-				_cb_clear();
-			}
+			publish(std::make_shared<const listeners_t>());
+			reconcile();
 		}
 		inline event<_args...>& operator=(std::nullptr_t)
 		{
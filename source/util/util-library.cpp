@@ -19,6 +19,7 @@
 // SOFTWARE.
 
 #include "util-library.hpp"
+#include <mutex>
 #include <unordered_map>
 
 #if defined(_WIN32) || defined(_WIN64) || defined(__CYGWIN__) // Windows
@@ -83,9 +84,12 @@ void* util::library::load_symbol(std::string_view name)
 }
 
 static std::unordered_map<std::string, std::weak_ptr<::util::library>> libraries;
+static std::mutex                                                       libraries_lock;
 
 std::shared_ptr<::util::library> util::library::load(std::filesystem::path file)
 {
+	std::unique_lock<std::mutex> lock(libraries_lock);
+
 	auto kv = libraries.find(file.u8string());
 	if (kv != libraries.end()) {
 		if (auto ptr = kv->second.lock(); ptr)
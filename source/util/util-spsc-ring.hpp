@@ -0,0 +1,103 @@
+// Modern effects for a modern Streamer
+// Copyright (C) 2020 Michael Fabian Dirks
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+
+#pragma once
+#include "common.hpp"
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+namespace util {
+	/** Lock-free single-producer single-consumer ring of preallocated elements.
+	 *
+	 * Elements are never constructed or destroyed while in use, the producer fills a slot in place with
+	 * write_slot()/commit_write() and the consumer drains it with read_slot()/commit_read(). Exactly one thread may
+	 * produce and exactly one thread may consume at any given time.
+	 */
+	template<typename T>
+	class spsc_ring {
+		std::vector<T> _slots;
+		std::size_t    _mask;
+
+		// Separate cache lines, so that producer and consumer do not fight over them.
+		alignas(64) std::atomic<std::size_t> _head; // Next slot to write, owned by the producer.
+		alignas(64) std::atomic<std::size_t> _tail; // Next slot to read, owned by the consumer.
+
+		public:
+		spsc_ring(std::size_t capacity) : _slots(), _mask(0), _head(0), _tail(0)
+		{
+			if ((capacity == 0) || ((capacity & (capacity - 1)) != 0))
+				throw std::invalid_argument("capacity must be a power of two");
+
+			_slots.resize(capacity);
+			_mask = capacity - 1;
+		}
+
+		std::size_t capacity() const
+		{
+			return _slots.size();
+		}
+
+		std::size_t size() const
+		{
+			return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+		}
+
+		bool empty() const
+		{
+			return size() == 0;
+		}
+
+		// Direct access to all slots, only safe while neither side is active.
+		std::vector<T>& slots()
+		{
+			return _slots;
+		}
+
+		public /* Producer */:
+		// Returns the next free slot, or nullptr if the ring is full.
+		T* write_slot()
+		{
+			std::size_t head = _head.load(std::memory_order_relaxed);
+			if ((head - _tail.load(std::memory_order_acquire)) > _mask)
+				return nullptr;
+			return &_slots[head & _mask];
+		}
+
+		// Publishes the slot returned by write_slot() to the consumer.
+		void commit_write()
+		{
+			_head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+		public /* Consumer */:
+		// Returns the oldest published slot, or nullptr if the ring is empty.
+		T* read_slot()
+		{
+			std::size_t tail = _tail.load(std::memory_order_relaxed);
+			if (tail == _head.load(std::memory_order_acquire))
+				return nullptr;
+			return &_slots[tail & _mask];
+		}
+
+		// Returns the slot returned by read_slot() to the producer.
+		void commit_read()
+		{
+			_tail.store(_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+	};
+} // namespace util
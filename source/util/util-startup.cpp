@@ -0,0 +1,176 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "util-startup.hpp"
+#include <algorithm>
+#include <cinttypes>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+#define LOCAL_PREFIX "<util::startup> "
+
+util::startup::startup() : _steps() {}
+
+util::startup::~startup() {}
+
+void util::startup::add(std::string name, std::vector<std::string> dependencies, function_t initialize,
+						function_t prepare)
+{
+	auto entry             = std::make_shared<step>();
+	entry->name            = name;
+	entry->dependencies    = dependencies;
+	entry->prepare         = prepare;
+	entry->initialize      = initialize;
+	entry->prepared        = !prepare;
+	entry->initialized     = false;
+	entry->time_prepare    = std::chrono::nanoseconds(0);
+	entry->time_wait       = std::chrono::nanoseconds(0);
+	entry->time_initialize = std::chrono::nanoseconds(0);
+	_steps.push_back(entry);
+}
+
+std::vector<std::shared_ptr<util::startup::step>> util::startup::sort()
+{
+	std::map<std::string, std::shared_ptr<step>> by_name;
+	for (auto& entry : _steps) {
+		if (!by_name.emplace(entry->name, entry).second)
+			throw std::runtime_error("Start-up step '" + entry->name + "' was added twice.");
+	}
+	for (auto& entry : _steps) {
+		for (auto& dependency : entry->dependencies) {
+			if (by_name.find(dependency) == by_name.end())
+				throw std::runtime_error("Start-up step '" + entry->name + "' depends on unknown step '" + dependency
+										 + "'.");
+		}
+	}
+
+	// Keep the order steps were added in wherever the dependencies allow it.
+	std::vector<std::shared_ptr<step>> order;
+	std::set<std::string>              done;
+	while (order.size() < _steps.size()) {
+		bool progress = false;
+		for (auto& entry : _steps) {
+			if (done.count(entry->name))
+				continue;
+
+			bool ready = std::all_of(entry->dependencies.begin(), entry->dependencies.end(),
+									 [&done](const std::string& dependency) { return done.count(dependency) > 0; });
+			if (ready) {
+				order.push_back(entry);
+				done.insert(entry->name);
+				progress = true;
+			}
+		}
+		if (!progress)
+			throw std::runtime_error("Start-up steps have circular dependencies.");
+	}
+	return order;
+}
+
+bool util::startup::run(std::shared_ptr<util::threadpool> threadpool)
+{
+	auto order   = sort();
+	bool success = true;
+	auto begin   = std::chrono::high_resolution_clock::now();
+
+	// Kick off all the preparation work at once.
+	for (auto& entry : order) {
+		if (!entry->prepare)
+			continue;
+
+		auto task = [](std::shared_ptr<void> data) {
+			auto entry = std::static_pointer_cast<step>(data);
+			auto start = std::chrono::high_resolution_clock::now();
+			try {
+				entry->prepare();
+			} catch (...) {
+				entry->error = std::current_exception();
+			}
+
+			std::unique_lock<std::mutex> lock(entry->lock);
+			entry->time_prepare = std::chrono::high_resolution_clock::now() - start;
+			entry->prepared     = true;
+			entry->cv.notify_all();
+		};
+		if (threadpool) {
+			threadpool->push(task, entry);
+		} else {
+			task(entry);
+		}
+	}
+
+	// Then initialize everything in order on this thread.
+	for (auto& entry : order) {
+		{
+			auto                         start = std::chrono::high_resolution_clock::now();
+			std::unique_lock<std::mutex> lock(entry->lock);
+			entry->cv.wait(lock, [&entry]() { return entry->prepared; });
+			entry->time_wait = std::chrono::high_resolution_clock::now() - start;
+		}
+
+		for (auto& dependency : entry->dependencies) {
+			auto iter = std::find_if(order.begin(), order.end(),
+									 [&dependency](const std::shared_ptr<step>& v) { return v->name == dependency; });
+			if (!(*iter)->initialized) {
+				entry->error = std::make_exception_ptr(std::runtime_error("Depends on '" + dependency + "'."));
+				break;
+			}
+		}
+
+		if (!entry->error) {
+			auto start = std::chrono::high_resolution_clock::now();
+			try {
+				entry->initialize();
+				entry->initialized = true;
+			} catch (...) {
+				entry->error = std::current_exception();
+			}
+			entry->time_initialize = std::chrono::high_resolution_clock::now() - start;
+		}
+
+		if (entry->error) {
+			success = false;
+			try {
+				std::rethrow_exception(entry->error);
+			} catch (const std::exception& ex) {
+				DLOG_ERROR(LOCAL_PREFIX "'%s' failed: %s", entry->name.c_str(), ex.what());
+			} catch (...) {
+				DLOG_ERROR(LOCAL_PREFIX "'%s' failed.", entry->name.c_str());
+			}
+		}
+	}
+
+	// Report where the time went. 'Prepare' ran in parallel, 'Waited' and 'Initialize' blocked the caller.
+	auto us = [](std::chrono::nanoseconds v) {
+		return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(v).count());
+	};
+	DLOG_INFO(LOCAL_PREFIX "%-30s %10s %10s %10s", "Step", "Prepare", "Waited", "Initialize");
+	for (auto& entry : order) {
+		DLOG_INFO(LOCAL_PREFIX "%-30s %8" PRId64 "µs %8" PRId64 "µs %8" PRId64 "µs%s", entry->name.c_str(),
+				  us(entry->time_prepare), us(entry->time_wait), us(entry->time_initialize),
+				  entry->initialized ? "" : " (failed)");
+	}
+	DLOG_INFO(LOCAL_PREFIX "Start-up took %" PRId64 "µs in total.",
+			  us(std::chrono::high_resolution_clock::now() - begin));
+
+	return success;
+}
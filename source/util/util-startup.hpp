@@ -0,0 +1,80 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+#include "common.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <list>
+#include <mutex>
+
+namespace util {
+	/** Runs a set of start-up steps in dependency order and reports how long each one took.
+	 *
+	 * Every step has an 'initialize' function, which runs on the thread calling run() once everything the step depends
+	 * on is initialized, and an optional 'prepare' function. All 'prepare' functions start on the thread pool right
+	 * away and run in parallel, so they may only do work that does not depend on other steps and does not touch libOBS
+	 * registration or the graphics subsystem, such as reading files or probing libraries. A step is only initialized
+	 * once its own 'prepare' function has finished. If a step fails, everything that depends on it is skipped.
+	 */
+	class startup {
+		public:
+		typedef std::function<void()> function_t;
+
+		private:
+		struct step {
+			std::string              name;
+			std::vector<std::string> dependencies;
+			function_t               prepare;
+			function_t               initialize;
+
+			std::mutex              lock;
+			std::condition_variable cv;
+			bool                    prepared;
+			std::exception_ptr      error;
+			bool                    initialized;
+
+			std::chrono::nanoseconds time_prepare;
+			std::chrono::nanoseconds time_wait;
+			std::chrono::nanoseconds time_initialize;
+		};
+
+		std::list<std::shared_ptr<step>> _steps;
+
+		public:
+		startup();
+		~startup();
+
+		/** Add a step. Dependencies are referenced by name and must be added before run() is called. */
+		void add(std::string name, std::vector<std::string> dependencies, function_t initialize,
+				 function_t prepare = nullptr);
+
+		/** Run all steps and log a timing report.
+		 *
+		 * @return false if any step failed or was skipped.
+		 */
+		bool run(std::shared_ptr<util::threadpool> threadpool);
+
+		private:
+		std::vector<std::shared_ptr<step>> sort();
+	};
+} // namespace util
@@ -0,0 +1,183 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "test.hpp"
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#ifdef ENABLE_FILTER_BLUR
+#include "gfx/blur/gfx-blur-cpu.hpp"
+
+// Largest difference a CPU blur may have from its hand-computed result.
+#define CPU_BLUR_TOLERANCE 1e-5
+
+using namespace streamfx::test;
+
+// Samples an image like a GPU would, with linear filtering and clamped addressing. Texel centers are at .5 offsets.
+static void sample_clamped(gfx::blur::cpu::image const& input, double_t u, double_t v, double_t weight, double_t* out)
+{
+	int32_t  width  = static_cast<int32_t>(input.get_width());
+	int32_t  height = static_cast<int32_t>(input.get_height());
+	double_t px     = u * width - .5;
+	double_t py     = v * height - .5;
+	int32_t  x0     = static_cast<int32_t>(std::floor(px));
+	int32_t  y0     = static_cast<int32_t>(std::floor(py));
+	double_t fx     = px - x0;
+	double_t fy     = py - y0;
+
+	auto texel = [&input, width, height](int32_t x, int32_t y) {
+		return input.at(static_cast<uint32_t>(std::clamp(x, 0, width - 1)),
+						static_cast<uint32_t>(std::clamp(y, 0, height - 1)));
+	};
+	for (std::size_t idx = 0; idx < 4; idx++) {
+		double_t top    = texel(x0, y0)[idx] * (1. - fx) + texel(x0 + 1, y0)[idx] * fx;
+		double_t bottom = texel(x0, y0 + 1)[idx] * (1. - fx) + texel(x0 + 1, y0 + 1)[idx] * fx;
+		out[idx] += (top * (1. - fy) + bottom * fy) * weight;
+	}
+}
+
+// Convolves with taps given as offsets in texels of the output, or of the input if 'in_output' is false.
+static void convolve_reference(gfx::blur::cpu::image const& input, gfx::blur::cpu::image& output, uint32_t width,
+							   uint32_t height, std::vector<std::array<double_t, 3>> const& taps, bool in_output)
+{
+	double_t scale_x = 1. / (in_output ? width : input.get_width());
+	double_t scale_y = 1. / (in_output ? height : input.get_height());
+
+	output.resize(width, height);
+	for (uint32_t y = 0; y < height; y++) {
+		for (uint32_t x = 0; x < width; x++) {
+			double_t acc[4] = {0., 0., 0., 0.};
+			for (auto const& tap : taps) {
+				sample_clamped(input, (x + .5) / width + tap[0] * scale_x, (y + .5) / height + tap[1] * scale_y,
+							   tap[2], acc);
+			}
+			for (std::size_t idx = 0; idx < 4; idx++) {
+				output.at(x, y)[idx] = static_cast<float_t>(acc[idx]);
+			}
+		}
+	}
+}
+
+// Builds the taps of a horizontal or vertical pass from the one-sided weights of a kernel.
+static std::vector<std::array<double_t, 3>> mirror_reference(std::vector<std::pair<double_t, double_t>> const& line,
+															 bool vertical)
+{
+	std::vector<std::array<double_t, 3>> taps;
+	for (auto const& kv : line) {
+		for (double_t sign : {1., -1.}) {
+			taps.push_back({vertical ? 0. : kv.first * sign, vertical ? kv.first * sign : 0., kv.second});
+			if (kv.first == 0.)
+				break;
+		}
+	}
+	return taps;
+}
+
+/** Compares every CPU blur algorithm and instruction set against a result calculated from hand-written taps.
+ *
+ * The image is 7x5 and the blur 3 texels wide, so that most taps are clamped at an edge, and Dual Filtering has to
+ * downsample an odd size.
+ */
+TEST_CASE(blur_cpu, false)
+{
+	gfx::blur::cpu::image input{7, 5};
+	for (uint32_t y = 0; y < input.get_height(); y++) {
+		for (uint32_t x = 0; x < input.get_width(); x++) {
+			for (uint32_t idx = 0; idx < 4; idx++) {
+				input.at(x, y)[idx] = static_cast<float_t>((x * 7 + y * 13 + idx * 5) % 17) / 16.f;
+			}
+		}
+	}
+
+	// Box weighs all 7 texels equally, the linear variant samples between two texels to read both at once. The
+	// Gaussian weights are those of gaussian_data::generate_kernel(3), the linear variant merges them the same way.
+	double_t box = 1. / 7.;
+	double_t g[] = {0.327007741, 0.234216228, 0.0860584974, 0.0162214022};
+	std::vector<std::pair<gfx::blur::cpu::algorithm, std::vector<std::pair<double_t, double_t>>>> lines = {
+		{gfx::blur::cpu::algorithm::Box, {{0., box}, {1., box}, {2., box}, {3., box}}},
+		{gfx::blur::cpu::algorithm::BoxLinear, {{0., box}, {1.5, box * 2.}, {3., box}}},
+		{gfx::blur::cpu::algorithm::Gaussian, {{0., g[0]}, {1., g[1]}, {2., g[2]}, {3., g[3]}}},
+		{gfx::blur::cpu::algorithm::GaussianLinear, {{0., g[0]}, {1.5, g[1] + g[2]}, {3., g[3]}}},
+	};
+
+	std::vector<std::pair<gfx::blur::cpu::algorithm, gfx::blur::cpu::image>> expected;
+	for (auto const& line : lines) {
+		gfx::blur::cpu::image temp;
+		gfx::blur::cpu::image result;
+		convolve_reference(input, temp, 7, 5, mirror_reference(line.second, false), true);
+		convolve_reference(temp, result, 7, 5, mirror_reference(line.second, true), true);
+		expected.emplace_back(line.first, result);
+	}
+	{ // One level: the center and four diagonal texels down to 3x2, then four edges and four corners back up.
+		gfx::blur::cpu::image half;
+		gfx::blur::cpu::image result;
+		convolve_reference(input, half, 3, 2,
+						   {{0., 0., .5}, {-.5, -.5, .125}, {.5, .5, .125}, {.5, -.5, .125}, {-.5, .5, .125}}, true);
+		convolve_reference(half, result, 7, 5,
+						   {{-1., 0., 1. / 12.},
+							{1., 0., 1. / 12.},
+							{0., 1., 1. / 12.},
+							{0., -1., 1. / 12.},
+							{-.5, .5, 2. / 12.},
+							{.5, .5, 2. / 12.},
+							{.5, -.5, 2. / 12.},
+							{-.5, -.5, 2. / 12.}},
+						   false);
+		expected.emplace_back(gfx::blur::cpu::algorithm::DualFiltering, result);
+	}
+
+	const char* names[] = {"Box", "Box Linear", "Gaussian", "Gaussian Linear", "Dual Filtering"};
+	std::string failures;
+	for (auto isa : {gfx::blur::cpu::instruction_set::Scalar, gfx::blur::cpu::instruction_set::AVX2,
+					 gfx::blur::cpu::instruction_set::NEON}) {
+		if (!gfx::blur::cpu::is_instruction_set_supported(isa))
+			continue;
+
+		for (auto& kv : expected) {
+			gfx::blur::cpu::blur blur{kv.first, gfx::blur::type::Area};
+			blur.set_instruction_set(isa);
+			blur.set_size((kv.first == gfx::blur::cpu::algorithm::DualFiltering) ? 1. : 3.);
+			blur.set_step_scale(1., 1.);
+
+			gfx::blur::cpu::image output;
+			blur.render(input, output);
+
+			double_t error = std::numeric_limits<double_t>::infinity();
+			if ((output.get_width() == kv.second.get_width()) && (output.get_height() == kv.second.get_height())) {
+				error = 0.;
+				for (std::size_t idx = 0; idx < std::size_t(output.get_width()) * output.get_height() * 4; idx++) {
+					error = std::max<double_t>(error, std::fabs(output.data()[idx] - kv.second.data()[idx]));
+				}
+			}
+
+			std::printf("  %s (%s): %g\n", names[static_cast<std::size_t>(kv.first)], gfx::blur::cpu::to_string(isa),
+						error);
+			if (error > CPU_BLUR_TOLERANCE) {
+				failures += std::string(failures.empty() ? "" : ", ") + names[static_cast<std::size_t>(kv.first)] + " ("
+							+ gfx::blur::cpu::to_string(isa) + ")";
+			}
+		}
+	}
+	if (!failures.empty())
+		throw failure("Differs from the expected result: " + failures + ".");
+}
+#endif
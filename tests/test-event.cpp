@@ -0,0 +1,134 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "test.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "util/util-event.hpp"
+
+// Time each contention case runs for.
+#define EVENT_DURATION std::chrono::milliseconds(500)
+// Listeners the writer adds before clearing the event and starting over.
+#define EVENT_LISTENERS 64
+
+// Listeners are called in order, and the listen and silence callbacks only when the event fills or empties.
+TEST_CASE(event, false)
+{
+	util::event<int32_t> event;
+	std::vector<int32_t> order;
+	int32_t              filled  = 0;
+	int32_t              cleared = 0;
+
+	event.set_listen_callback([&filled]() { filled++; });
+	event.set_silence_callback([&cleared]() { cleared++; });
+
+	std::function<void(int32_t)> first  = [&order](int32_t value) { order.push_back(value); };
+	std::function<void(int32_t)> second = [&order](int32_t value) { order.push_back(value * 10); };
+	event.add(first);
+	event.add(second);
+	TEST_ASSERT(filled == 1);
+
+	event(2);
+	TEST_ASSERT((order == std::vector<int32_t>{2, 20}));
+
+	event.clear();
+	TEST_ASSERT(event.empty() && (cleared == 1));
+	event(3);
+	TEST_ASSERT(order.size() == 2);
+}
+
+/** Calls an event from several threads, once alone and once while another thread keeps changing its listeners.
+ *
+ * Logs the call rate and the slowest call of each case. Every call must reach the listener, and the callers must keep
+ * making progress while the listeners change.
+ */
+TEST_CASE(event_contention, false)
+{
+	std::size_t callers = std::max<std::size_t>(std::thread::hardware_concurrency(), 2) - 1;
+
+	for (bool contended : {false, true}) {
+		util::event<int32_t>  event;
+		std::atomic<int64_t>  sink{0};
+		std::atomic<bool>     stop{false};
+		std::atomic<uint64_t> calls{0};
+		std::atomic<uint64_t> changes{0};
+		std::atomic<int64_t>  slowest{0};
+
+		auto listener = [&sink](int32_t value) { sink.fetch_add(value, std::memory_order_relaxed); };
+		event.add(listener);
+
+		std::vector<std::thread> threads;
+		for (std::size_t idx = 0; idx < callers; idx++) {
+			threads.emplace_back([&event, &stop, &calls, &slowest]() {
+				uint64_t count = 0;
+				int64_t  worst = 0;
+				while (!stop.load(std::memory_order_relaxed)) {
+					auto start = std::chrono::high_resolution_clock::now();
+					event(1);
+					auto time = std::chrono::high_resolution_clock::now() - start;
+					worst     = std::max<int64_t>(worst, std::chrono::nanoseconds(time).count());
+					count++;
+				}
+				calls += count;
+				for (int64_t value = slowest.load(); (value < worst) && !slowest.compare_exchange_weak(value, worst);) {
+				}
+			});
+		}
+		if (contended) {
+			threads.emplace_back([&event, &stop, &changes, &listener]() {
+				uint64_t count = 0;
+				while (!stop.load(std::memory_order_relaxed)) {
+					event.add([](int32_t) {});
+					if ((++count % EVENT_LISTENERS) == 0) {
+						event.clear();
+						event.add(listener);
+					}
+				}
+				changes += count;
+			});
+		}
+
+		std::this_thread::sleep_for(EVENT_DURATION);
+		stop = true;
+		for (auto& thread : threads) {
+			thread.join();
+		}
+
+		double_t seconds = std::chrono::duration<double_t>(EVENT_DURATION).count();
+		std::printf("  %" PRIu64 " callers%s: %.0f calls/s, slowest call %.3fms, %.0f changes/s\n",
+					static_cast<uint64_t>(callers), contended ? " and a writer" : "",
+					static_cast<double_t>(calls.load()) / seconds, static_cast<double_t>(slowest.load()) / 1000000.,
+					static_cast<double_t>(changes.load()) / seconds);
+
+		TEST_ASSERT(calls.load() > 0);
+		if (contended) {
+			// Calls between clearing the event and adding the listener back find no listener.
+			TEST_ASSERT(static_cast<uint64_t>(sink.load()) <= calls.load());
+			TEST_ASSERT(changes.load() > 0);
+		} else {
+			TEST_ASSERT(static_cast<uint64_t>(sink.load()) == calls.load());
+		}
+	}
+}
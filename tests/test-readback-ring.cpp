@@ -0,0 +1,120 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "test.hpp"
+#include <cinttypes>
+#include <cstdio>
+#include <vector>
+#include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-readback-ring.hpp"
+#include "obs/gs/gs-texture.hpp"
+
+// Frames staged into the ring, one per rendered frame, and their size.
+#define READBACK_FRAMES 16
+#define READBACK_SIZE 16
+
+using namespace streamfx::test;
+
+static uint8_t readback_value(uint64_t tag, uint32_t x, uint32_t y, uint32_t channel)
+{
+	return static_cast<uint8_t>(tag * 31 + x * 7 + y * 3 + channel * 64);
+}
+
+/** Stages one frame into a readback ring per rendered frame, and maps every frame that became ready.
+ *
+ * Each frame is a distinct texture, so that a frame handed out in the wrong order or with the wrong contents is
+ * noticed. Frames are a rendered frame apart like in the encoders, so mapping must never wait for the GPU.
+ */
+TEST_CASE(readback_ring, true)
+{
+	std::shared_ptr<gs::readback_ring>        ring;
+	std::vector<std::shared_ptr<gs::texture>> textures;
+	uint64_t                                  staged   = 0;
+	uint64_t                                  mapped   = 0;
+	uint64_t                                  expected = 0;
+
+	auto step = [&]() {
+		if (!ring)
+			ring = std::make_shared<gs::readback_ring>(3, 1);
+
+		if (staged < READBACK_FRAMES) {
+			std::vector<uint8_t> pixels(READBACK_SIZE * READBACK_SIZE * 4);
+			for (uint32_t y = 0; y < READBACK_SIZE; y++) {
+				for (uint32_t x = 0; x < READBACK_SIZE; x++) {
+					for (uint32_t c = 0; c < 4; c++) {
+						pixels[(y * READBACK_SIZE + x) * 4 + c] = readback_value(staged, x, y, c);
+					}
+				}
+			}
+
+			const uint8_t* data = pixels.data();
+			textures.push_back(std::make_shared<gs::texture>(READBACK_SIZE, READBACK_SIZE, GS_RGBA, uint32_t(1), &data,
+															 gs::texture::flags::None));
+			ring->stage(textures.back()->get_object(), staged);
+			staged++;
+		}
+
+		gs::readback_ring::frame frame;
+		while (ring->try_map(frame)) {
+			bool intact = (frame.width == READBACK_SIZE) && (frame.height == READBACK_SIZE);
+			for (uint32_t y = 0; intact && (y < READBACK_SIZE); y++) {
+				const uint8_t* row = frame.data + static_cast<std::size_t>(frame.linesize) * y;
+				for (uint32_t x = 0; intact && (x < READBACK_SIZE); x++) {
+					for (uint32_t c = 0; c < 4; c++) {
+						intact = intact && (row[x * 4 + c] == readback_value(frame.tag, x, y, c));
+					}
+				}
+			}
+			ring->unmap(frame);
+
+			TEST_ASSERT(frame.tag == expected);
+			TEST_ASSERT(intact);
+			expected++;
+			mapped++;
+		}
+
+		return staged < READBACK_FRAMES;
+	};
+
+	try {
+		run_per_frame(step);
+	} catch (...) {
+		auto gctx = gs::context();
+		ring.reset();
+		textures.clear();
+		throw;
+	}
+
+	auto stats = ring->get_statistics();
+	std::printf("  %" PRIu64 " of %" PRIu64 " frames mapped, %" PRIu64 " dropped, %" PRIu64
+				" stalls, slowest map %.3fms\n",
+				mapped, static_cast<uint64_t>(READBACK_FRAMES - 1), stats.dropped, stats.stalls,
+				static_cast<double_t>(stats.map_maximum.count()) / 1000000.);
+	{
+		auto gctx = gs::context();
+		ring.reset();
+		textures.clear();
+	}
+
+	// The last frame has no newer frame after it, so it is never ready.
+	TEST_ASSERT(mapped == (READBACK_FRAMES - 1));
+	TEST_ASSERT(stats.dropped == 0);
+	TEST_ASSERT(stats.stalls == 0);
+}
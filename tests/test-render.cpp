@@ -0,0 +1,763 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "test.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <locale>
+#include <sstream>
+#include <vector>
+#include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
+#include "obs/gs/gs-texture.hpp"
+#include "obs/obs-source-factory.hpp"
+#include "obs/obs-tools.hpp"
+
+#ifdef ENABLE_FILTER_BLUR
+#include "gfx/blur/gfx-blur-cpu.hpp"
+#endif
+
+#define KEY_WIDTH "Width"
+#define KEY_HEIGHT "Height"
+#define KEY_MIRROR "Mirror"
+
+// Size of golden images. Small, so that they are quick to render on a software renderer and cheap to keep around.
+#define GOLDEN_WIDTH 256
+#define GOLDEN_HEIGHT 144
+// Frames rendered before a frame is compared or measured, so that lazily created resources exist and caches are warm.
+#define WARMUP_FRAMES 10
+// Frames per measured batch, and number of batches. The fastest and the median batch are reported.
+#define BATCH_FRAMES 30
+#define BATCHES 5
+// Frames that differ more than this from their golden image fail.
+#define MINIMUM_PSNR 40.0
+// Frames that differ more than this from their CPU reference fail. Lower than MINIMUM_PSNR, as the GPU rounds every
+// intermediate pass to 8 bits, while the CPU reference is calculated in floating point.
+#define MINIMUM_REFERENCE_PSNR 35.0
+
+namespace streamfx::test {
+	/** Test input: gradients, a checkerboard and a soft-edged disc on a transparent border.
+	 *
+	 * The content only depends on the size and on whether it is mirrored, so that the output of every filter is
+	 * reproducible. The mirrored variant is used where a second, different input is needed.
+	 */
+	class pattern_instance : public obs::source_instance {
+		uint32_t                     _width;
+		uint32_t                     _height;
+		bool                         _mirror;
+		std::shared_ptr<gs::texture> _texture;
+
+		public:
+		pattern_instance(obs_data_t* data, obs_source_t* self);
+		virtual ~pattern_instance();
+
+		virtual uint32_t get_width() override;
+		virtual uint32_t get_height() override;
+
+		virtual void update(obs_data_t* data) override;
+
+		virtual void video_render(gs_effect_t* effect) override;
+	};
+
+	class pattern_factory : public obs::source_factory<test::pattern_factory, test::pattern_instance> {
+		public:
+		pattern_factory();
+		virtual ~pattern_factory();
+
+		virtual const char* get_name() override;
+
+		virtual void get_defaults2(obs_data_t* data) override;
+
+		public: // Singleton
+		static void initialize();
+	};
+} // namespace streamfx::test
+
+using namespace streamfx::test;
+
+// Generates the pattern as 8-bit RGBA, on the CPU so that it is identical everywhere.
+static void generate_pattern(uint32_t width, uint32_t height, bool mirror, std::vector<uint8_t>& pixels)
+{
+	pixels.resize(static_cast<std::size_t>(width) * height * 4);
+	for (uint32_t y = 0; y < height; y++) {
+		for (uint32_t x = 0; x < width; x++) {
+			uint8_t* px = pixels.data() + (static_cast<std::size_t>(y) * width + (mirror ? width - 1 - x : x)) * 4;
+			float_t  u  = (x + .5f) / width;
+			float_t  v  = (y + .5f) / height;
+
+			// Leave a transparent border, so that filters working on edges and alpha have something to do.
+			if ((u < .05f) || (u > .95f) || (v < .05f) || (v > .95f)) {
+				px[0] = px[1] = px[2] = px[3] = 0;
+				continue;
+			}
+
+			float_t rgb[3] = {u, v, 1.f - u};
+			if ((((x / 32) + (y / 32)) % 2) != 0) {
+				for (auto& c : rgb)
+					c *= .75f;
+			}
+
+			// A disc with a soft edge a few pixels wide.
+			float_t dx   = u - .5f;
+			float_t dy   = (v - .5f) * height / width;
+			float_t disc = std::clamp((.2f - std::sqrt(dx * dx + dy * dy)) * width / 4.f, 0.f, 1.f);
+			for (std::size_t idx = 0; idx < 3; idx++) {
+				px[idx] = static_cast<uint8_t>(std::lround(util::math::lerp(rgb[idx], 1.f, disc) * 255.f));
+			}
+			px[3] = 255;
+		}
+	}
+}
+
+pattern_instance::pattern_instance(obs_data_t* data, obs_source_t* self)
+	: obs::source_instance(data, self), _width(0), _height(0), _mirror(false), _texture()
+{
+	update(data);
+}
+
+pattern_instance::~pattern_instance() {}
+
+uint32_t pattern_instance::get_width()
+{
+	return _width;
+}
+
+uint32_t pattern_instance::get_height()
+{
+	return _height;
+}
+
+void pattern_instance::update(obs_data_t* data)
+{
+	uint32_t width  = static_cast<uint32_t>(std::clamp<int64_t>(obs_data_get_int(data, KEY_WIDTH), 1, 16384));
+	uint32_t height = static_cast<uint32_t>(std::clamp<int64_t>(obs_data_get_int(data, KEY_HEIGHT), 1, 16384));
+	bool     mirror = obs_data_get_bool(data, KEY_MIRROR);
+	if ((width != _width) || (height != _height) || (mirror != _mirror)) {
+		_width  = width;
+		_height = height;
+		_mirror = mirror;
+		_texture.reset();
+	}
+}
+
+void pattern_instance::video_render(gs_effect_t* effect)
+{
+	if (!_texture) {
+		std::vector<uint8_t> pixels;
+		generate_pattern(_width, _height, _mirror, pixels);
+
+		const uint8_t* data = pixels.data();
+		_texture =
+			std::make_shared<gs::texture>(_width, _height, GS_RGBA, uint32_t(1), &data, gs::texture::flags::None);
+	}
+
+	gs_effect_t* default_effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+	gs_effect_set_texture(gs_effect_get_param_by_name(default_effect, "image"), _texture->get_object());
+	while (gs_effect_loop(default_effect, "Draw")) {
+		gs_draw_sprite(nullptr, 0, _width, _height);
+	}
+}
+
+pattern_factory::pattern_factory()
+{
+	_info.id           = PREFIX "test-pattern";
+	_info.type         = OBS_SOURCE_TYPE_INPUT;
+	_info.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW | OBS_SOURCE_CAP_DISABLED;
+
+	finish_setup();
+}
+
+pattern_factory::~pattern_factory() {}
+
+const char* pattern_factory::get_name()
+{
+	return "Test Pattern";
+}
+
+void pattern_factory::get_defaults2(obs_data_t* data)
+{
+	obs_data_set_default_int(data, KEY_WIDTH, 1920);
+	obs_data_set_default_int(data, KEY_HEIGHT, 1080);
+	obs_data_set_default_bool(data, KEY_MIRROR, false);
+}
+
+// libOBS keeps using the registered source info until it shuts down, so the factory lives until the process exits.
+static std::shared_ptr<pattern_factory> _pattern_factory_instance = nullptr;
+
+void streamfx::test::pattern_factory::initialize()
+{
+	if (!_pattern_factory_instance)
+		_pattern_factory_instance = std::make_shared<pattern_factory>();
+}
+
+static void write_pam(std::filesystem::path file, uint32_t width, uint32_t height, const std::vector<uint8_t>& pixels)
+{
+	std::ofstream stream(file, std::ios::binary | std::ios::trunc);
+	if (!stream.is_open() || stream.bad())
+		throw std::runtime_error("Failed to write '" + file.u8string() + "'.");
+
+	stream << "P7\nWIDTH " << width << "\nHEIGHT " << height << "\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n";
+	stream.write(reinterpret_cast<const char*>(pixels.data()), static_cast<std::streamsize>(pixels.size()));
+}
+
+static bool read_pam(std::filesystem::path file, uint32_t& width, uint32_t& height, std::vector<uint8_t>& pixels)
+{
+	std::ifstream stream(file, std::ios::binary);
+	if (!stream.is_open() || stream.bad())
+		return false;
+
+	std::string line;
+	if (!std::getline(stream, line) || (line != "P7"))
+		return false;
+
+	uint32_t depth = 0;
+	width = height = 0;
+	while (std::getline(stream, line) && (line != "ENDHDR")) {
+		std::istringstream parser(line);
+		std::string        key;
+		parser >> key;
+		if (key == "WIDTH") {
+			parser >> width;
+		} else if (key == "HEIGHT") {
+			parser >> height;
+		} else if (key == "DEPTH") {
+			parser >> depth;
+		}
+	}
+	if ((depth != 4) || !width || !height)
+		return false;
+
+	pixels.resize(static_cast<std::size_t>(width) * height * 4);
+	stream.read(reinterpret_cast<char*>(pixels.data()), static_cast<std::streamsize>(pixels.size()));
+	return stream.gcount() == static_cast<std::streamsize>(pixels.size());
+}
+
+static double_t calculate_psnr(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b)
+{
+	if (a.size() != b.size())
+		return 0.;
+
+	double_t error = 0.;
+	for (std::size_t idx = 0; idx < a.size(); idx++) {
+		double_t delta = static_cast<double_t>(a[idx]) - static_cast<double_t>(b[idx]);
+		error += delta * delta;
+	}
+	error /= static_cast<double_t>(a.size());
+	return (error > 0.) ? 10. * std::log10(255. * 255. / error) : std::numeric_limits<double_t>::infinity();
+}
+
+#ifdef ENABLE_FILTER_BLUR
+// Blurs the pattern with the CPU reference of the blur filter, and composites it like scene::render does.
+static void generate_blur_reference(gfx::blur::cpu::algorithm algorithm, double_t size, uint32_t width,
+									uint32_t height, std::vector<uint8_t>& pixels)
+{
+	generate_pattern(width, height, false, pixels);
+
+	gfx::blur::cpu::image input{width, height};
+	gfx::blur::cpu::image output;
+	for (uint32_t y = 0; y < height; y++) {
+		for (uint32_t x = 0; x < width; x++) {
+			const uint8_t* px = pixels.data() + (static_cast<std::size_t>(y) * width + x) * 4;
+			float_t*       to = input.at(x, y);
+			for (std::size_t idx = 0; idx < 4; idx++) {
+				to[idx] = px[idx] / 255.f;
+			}
+		}
+	}
+
+	gfx::blur::cpu::blur blur{algorithm, gfx::blur::type::Area};
+	blur.set_instruction_set(gfx::blur::cpu::get_best_instruction_set());
+	blur.set_size(size);
+	blur.set_step_scale(1., 1.);
+	blur.render(input, output);
+
+	// The render target is cleared to transparent black and blended with the source alpha, alpha included.
+	for (uint32_t y = 0; y < height; y++) {
+		for (uint32_t x = 0; x < width; x++) {
+			const float_t* px    = output.at(x, y);
+			uint8_t*       to    = pixels.data() + (static_cast<std::size_t>(y) * width + x) * 4;
+			float_t        alpha = std::clamp(px[3], 0.f, 1.f);
+			for (std::size_t idx = 0; idx < 4; idx++) {
+				to[idx] = static_cast<uint8_t>(std::lround(std::clamp(px[idx], 0.f, 1.f) * alpha * 255.f));
+			}
+		}
+	}
+}
+#endif
+
+enum class kind {
+	Filter,
+	Source,
+	Transition,
+};
+
+struct render_case {
+	std::string name;
+	std::string id;
+	kind        type;
+
+	// Applies the settings of the case, for the resolution it is rendered at.
+	std::function<void(obs_data_t*, uint32_t, uint32_t)> configure;
+
+	// Whether the output is reproducible and can be compared against a golden image.
+	bool golden;
+
+	// Calculates the expected frame for a resolution on the CPU, if the case has a reference implementation.
+	std::function<void(uint32_t, uint32_t, std::vector<uint8_t>&)> reference;
+};
+
+static std::string data_file(std::string file)
+{
+	return (get_options().data / std::filesystem::u8path(file)).u8string();
+}
+
+// Every filter, source and transition the plugin was built with, configured so that it changes its input.
+static std::vector<render_case> get_cases()
+{
+	std::vector<render_case> cases;
+
+#ifdef ENABLE_FILTER_BLUR
+	std::pair<const char*, gfx::blur::cpu::algorithm> blurs[] = {
+		{"box", gfx::blur::cpu::algorithm::Box},
+		{"box_linear", gfx::blur::cpu::algorithm::BoxLinear},
+		{"gaussian", gfx::blur::cpu::algorithm::Gaussian},
+		{"gaussian_linear", gfx::blur::cpu::algorithm::GaussianLinear},
+		{"dual_filtering", gfx::blur::cpu::algorithm::DualFiltering},
+	};
+	for (auto blur : blurs) {
+		auto configure = [type = blur.first](obs_data_t* data, uint32_t, uint32_t) {
+			obs_data_set_string(data, "Filter.Blur.Type", type);
+			obs_data_set_double(data, "Filter.Blur.Size", 15);
+		};
+		auto reference = [algorithm = blur.second](uint32_t width, uint32_t height, std::vector<uint8_t>& pixels) {
+			generate_blur_reference(algorithm, 15, width, height, pixels);
+		};
+		cases.push_back(
+			{std::string("blur-") + blur.first, PREFIX "filter-blur", kind::Filter, configure, true, reference});
+	}
+#endif
+#ifdef ENABLE_FILTER_COLOR_GRADE
+	cases.push_back({"color-grade", PREFIX "filter-color-grade", kind::Filter,
+					 [](obs_data_t* data, uint32_t, uint32_t) {
+						 obs_data_set_double(data, "Filter.ColorGrade.Lift.Blue", 10.);
+						 obs_data_set_double(data, "Filter.ColorGrade.Gamma.All", -20.);
+						 obs_data_set_double(data, "Filter.ColorGrade.Gain.Red", 120.);
+						 obs_data_set_double(data, "Filter.ColorGrade.Correction.Hue", 30.);
+					 },
+					 true});
+#endif
+#ifdef ENABLE_FILTER_DISPLACEMENT
+	cases.push_back({"displacement", PREFIX "filter-displacement", kind::Filter,
+					 [](obs_data_t* data, uint32_t, uint32_t) {
+						 obs_data_set_string(data, "Filter.Displacement.File",
+											 data_file("examples/normal-maps/stretch-middle.png").c_str());
+						 obs_data_set_double(data, "Filter.Displacement.Scale", 20.);
+					 },
+					 true});
+#endif
+#ifdef ENABLE_FILTER_DYNAMIC_MASK
+	// Takes the alpha channel from the red channel of the mirrored pattern, which scene::create adds as "Test Mask".
+	cases.push_back({"dynamic-mask", PREFIX "filter-dynamic-mask", kind::Filter,
+					 [](obs_data_t* data, uint32_t, uint32_t) {
+						 obs_data_set_string(data, "Filter.DynamicMask.Input", "Test Mask");
+						 obs_data_set_double(data, "Filter.DynamicMask.Channel.Value.Channel.Alpha", 0.);
+						 obs_data_set_double(data, "Filter.DynamicMask.Channel.Input.Channel.Alpha.Channel.Red", 1.);
+					 },
+					 true});
+#endif
+#ifdef ENABLE_FILTER_NVIDIA_FACE_TRACKING
+	// The replayed regions are smoothed over time, so the zoom depends on how long the frame took and is not compared.
+	cases.push_back({"face-tracking", PREFIX "filter-nvidia-face-tracking", kind::Filter,
+					 [](obs_data_t* data, uint32_t, uint32_t) {
+						 obs_data_set_int(data, "Tracker.Backend", 2);
+						 obs_data_set_string(data, "Tracker.File",
+											 data_file("examples/face-tracking/replay.txt").c_str());
+					 },
+					 false});
+#endif
+#ifdef ENABLE_FILTER_SDF_EFFECTS
+	cases.push_back({"sdf-effects", PREFIX "filter-sdf-effects", kind::Filter,
+					 [](obs_data_t* data, uint32_t, uint32_t) {
+						 obs_data_set_bool(data, "Filter.SDFEffects.Shadow.Outer", true);
+						 obs_data_set_bool(data, "Filter.SDFEffects.Glow.Outer", true);
+						 obs_data_set_bool(data, "Filter.SDFEffects.Outline", true);
+					 },
+					 true});
+#endif
+#ifdef ENABLE_FILTER_SHADER
+	cases.push_back({"shader-filter", PREFIX "filter-shader", kind::Filter,
+					 [](obs_data_t* data, uint32_t, uint32_t) {
+						 obs_data_set_string(data, "Shader.Shader.File",
+											 data_file("examples/shaders/filter/pixelation.effect").c_str());
+					 },
+					 true});
+#endif
+#ifdef ENABLE_FILTER_TRANSFORM
+	cases.push_back({"transform", PREFIX "filter-transform", kind::Filter,
+					 [](obs_data_t* data, uint32_t, uint32_t) {
+						 obs_data_set_double(data, "Filter.Transform.Rotation.Z", 30.);
+					 },
+					 true});
+#endif
+#ifdef ENABLE_SOURCE_SHADER
+	// The example sources all animate, so a shader that only depends on the size is used instead.
+	cases.push_back({"shader-source", PREFIX "source-shader", kind::Source,
+					 [](obs_data_t* data, uint32_t width, uint32_t height) {
+						 auto file = get_options().tests / "shaders" / "source-rings.effect";
+						 obs_data_set_string(data, "Shader.Shader.File", file.u8string().c_str());
+						 obs_data_set_string(data, "Shader.Shader.Size.Width", std::to_string(width).c_str());
+						 obs_data_set_string(data, "Shader.Shader.Size.Height", std::to_string(height).c_str());
+					 },
+					 true});
+#endif
+#ifdef ENABLE_TRANSITION_SHADER
+	cases.push_back({"shader-transition", PREFIX "transition-shader", kind::Transition,
+					 [](obs_data_t* data, uint32_t, uint32_t) {
+						 obs_data_set_string(data, "Shader.Shader.File",
+											 data_file("examples/shaders/transition/color-shift.effect").c_str());
+					 },
+					 true});
+#endif
+
+	return cases;
+}
+
+/** Renders one case into a render target and reads it back.
+ *
+ * Filters are added to the pattern, and transitions are held half way between the pattern and its mirrored variant.
+ * Every source is created through the factory libOBS registered for it, like OBS Studio would.
+ */
+class scene {
+	std::shared_ptr<obs_source_t>     _inputs[2];
+	std::shared_ptr<obs_source_t>     _mask;
+	std::shared_ptr<obs_source_t>     _filter;
+	std::shared_ptr<obs_source_t>     _target;
+	std::shared_ptr<gs::rendertarget> _rt;
+	gs_stagesurf_t*                   _stage;
+	std::vector<uint8_t>              _pixels;
+
+	public:
+	scene() : _inputs(), _mask(), _filter(), _target(), _rt(), _stage(nullptr), _pixels() {}
+
+	~scene()
+	{
+		auto gctx = gs::context();
+		release();
+		if (_stage)
+			gs_stagesurface_destroy(_stage);
+		_rt.reset();
+	}
+
+	const std::vector<uint8_t>& get_pixels()
+	{
+		return _pixels;
+	}
+
+	static std::shared_ptr<obs_source_t> create_source(const char* id, const char* name, obs_data_t* settings,
+													   bool visible = false)
+	{
+		obs_source_t* source =
+			visible ? obs_source_create(id, name, settings, nullptr) : obs_source_create_private(id, name, settings);
+		if (!source)
+			throw std::runtime_error(std::string("Failed to create '") + id + "'.");
+		return std::shared_ptr<obs_source_t>(source, obs::obs_source_deleter);
+	}
+
+	static std::shared_ptr<obs_source_t> create_pattern(const char* name, uint32_t width, uint32_t height, bool mirror,
+														bool visible = false)
+	{
+		std::shared_ptr<obs_data_t> settings{obs_data_create(), obs::obs_data_deleter};
+		obs_data_set_int(settings.get(), KEY_WIDTH, width);
+		obs_data_set_int(settings.get(), KEY_HEIGHT, height);
+		obs_data_set_bool(settings.get(), KEY_MIRROR, mirror);
+		return create_source(PREFIX "test-pattern", name, settings.get(), visible);
+	}
+
+	void create(const render_case& current, uint32_t width, uint32_t height)
+	{
+		std::shared_ptr<obs_data_t> settings{obs_data_create(), obs::obs_data_deleter};
+		current.configure(settings.get(), width, height);
+
+		if (current.type != kind::Source) {
+			_inputs[0] = create_pattern("Test Input A", width, height, false);
+			_inputs[1] = create_pattern("Test Input B", width, height, true);
+			// Filters can only find sources by name that are not private.
+			_mask = create_pattern("Test Mask", width, height, true, true);
+		}
+
+		switch (current.type) {
+		case kind::Filter:
+			_filter = create_source(current.id.c_str(), "Test Filter", settings.get());
+			obs_source_filter_add(_inputs[0].get(), _filter.get());
+			_target = _inputs[0];
+			break;
+		case kind::Source:
+			_target = create_source(current.id.c_str(), "Test Source", settings.get());
+			break;
+		case kind::Transition:
+			_target = create_source(current.id.c_str(), "Test Transition", settings.get());
+			obs_transition_set_size(_target.get(), width, height);
+			obs_transition_set(_target.get(), _inputs[0].get());
+			obs_transition_start(_target.get(), OBS_TRANSITION_MODE_MANUAL, 1000, _inputs[1].get());
+			obs_transition_set_manual_time(_target.get(), .5f);
+			break;
+		}
+		obs_source_inc_showing(_target.get());
+	}
+
+	void release()
+	{
+		if (_target)
+			obs_source_dec_showing(_target.get());
+		if (_filter && _inputs[0])
+			obs_source_filter_remove(_inputs[0].get(), _filter.get());
+		if (_mask)
+			obs_source_remove(_mask.get());
+		_target.reset();
+		_filter.reset();
+		_mask.reset();
+		_inputs[0].reset();
+		_inputs[1].reset();
+	}
+
+	void render(uint32_t width, uint32_t height)
+	{
+		if (!_rt)
+			_rt = std::make_shared<gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+
+		uint32_t sw = obs_source_get_width(_target.get());
+		uint32_t sh = obs_source_get_height(_target.get());
+
+		auto op  = _rt->render(width, height);
+		vec4 clr = {0., 0., 0., 0.};
+		gs_clear(GS_CLEAR_COLOR, &clr, 0., 0);
+		gs_ortho(0., static_cast<float_t>(sw ? sw : width), 0., static_cast<float_t>(sh ? sh : height), -1., 1.);
+
+		gs_blend_state_push();
+		gs_reset_blend_state();
+		gs_enable_depth_test(false);
+		obs_source_video_render(_target.get());
+		gs_blend_state_pop();
+	}
+
+	// Reading back the frame waits for the GPU to finish everything that was queued.
+	void read_back(uint32_t width, uint32_t height)
+	{
+		if (!_stage || (gs_stagesurface_get_width(_stage) != width)
+			|| (gs_stagesurface_get_height(_stage) != height)) {
+			if (_stage)
+				gs_stagesurface_destroy(_stage);
+			_stage = gs_stagesurface_create(width, height, GS_RGBA);
+			if (!_stage)
+				throw std::runtime_error("Failed to create staging surface.");
+		}
+		gs_stage_texture(_stage, _rt->get_object());
+
+		uint8_t* data;
+		uint32_t linesize;
+		if (!gs_stagesurface_map(_stage, &data, &linesize))
+			throw std::runtime_error("Failed to read back frame.");
+
+		std::size_t row_size = static_cast<std::size_t>(width) * 4;
+		_pixels.resize(row_size * height);
+		for (uint32_t y = 0; y < height; y++) {
+			std::memcpy(_pixels.data() + row_size * y, data + static_cast<std::size_t>(linesize) * y, row_size);
+		}
+		gs_stagesurface_unmap(_stage);
+	}
+};
+
+static void throw_failures(const std::vector<std::string>& failures)
+{
+	if (failures.empty())
+		return;
+
+	std::string message;
+	for (auto& entry : failures) {
+		message += (message.empty() ? "" : ", ") + entry;
+	}
+	throw failure(message + ".");
+}
+
+static std::string format_psnr(double_t value)
+{
+	std::stringstream str;
+	str.imbue(std::locale::classic());
+	str.precision(2);
+	str << std::fixed << value;
+	return str.str();
+}
+
+/** Renders every case at a small size and compares the frame against its golden image in 'golden/<case>.pam'.
+ *
+ * With --update-golden the golden images are replaced instead. Cases with a CPU reference are also compared against
+ * it, so that a golden image can not silently capture a broken frame. Each case is rendered for a few frames first,
+ * with libOBS ticking it in between, and every frame is written to the output directory.
+ */
+TEST_CASE(render, true)
+{
+	auto cases = get_cases();
+	TEST_ASSERT(!cases.empty());
+
+	auto  golden_path = get_options().tests / "golden";
+	auto& output_path = get_options().output;
+	if (get_options().update_golden)
+		std::filesystem::create_directories(golden_path);
+
+	std::vector<std::string> failures;
+	std::size_t              index = 0;
+	std::size_t              frame = 0;
+	scene                    current;
+	pattern_factory::initialize();
+	run_per_frame([&]() {
+		auto& test = cases[index];
+		try {
+			if (frame == 0) {
+				current.create(test, GOLDEN_WIDTH, GOLDEN_HEIGHT);
+			} else {
+				current.render(GOLDEN_WIDTH, GOLDEN_HEIGHT);
+			}
+			if (++frame <= WARMUP_FRAMES)
+				return true;
+
+			current.read_back(GOLDEN_WIDTH, GOLDEN_HEIGHT);
+			auto& pixels = current.get_pixels();
+			write_pam(output_path / (test.name + ".pam"), GOLDEN_WIDTH, GOLDEN_HEIGHT, pixels);
+
+			std::string status;
+			if (test.reference) {
+				std::vector<uint8_t> reference;
+				test.reference(GOLDEN_WIDTH, GOLDEN_HEIGHT, reference);
+				write_pam(output_path / (test.name + ".reference.pam"), GOLDEN_WIDTH, GOLDEN_HEIGHT, reference);
+
+				double_t psnr = calculate_psnr(pixels, reference);
+				status += " reference " + format_psnr(psnr) + "dB";
+				if (psnr < MINIMUM_REFERENCE_PSNR)
+					failures.push_back(test.name + " differs from its CPU reference");
+			}
+
+			if (!test.golden) {
+				status += ", not reproducible";
+			} else if (get_options().update_golden) {
+				write_pam(golden_path / (test.name + ".pam"), GOLDEN_WIDTH, GOLDEN_HEIGHT, pixels);
+				status += ", golden image updated";
+			} else {
+				uint32_t             width;
+				uint32_t             height;
+				std::vector<uint8_t> golden;
+				if (!read_pam(golden_path / (test.name + ".pam"), width, height, golden)) {
+					failures.push_back(test.name + " has no golden image");
+				} else {
+					double_t psnr = 0.;
+					if ((width == GOLDEN_WIDTH) && (height == GOLDEN_HEIGHT))
+						psnr = calculate_psnr(pixels, golden);
+					status += ", golden " + format_psnr(psnr) + "dB";
+					if (psnr < MINIMUM_PSNR)
+						failures.push_back(test.name + " differs from its golden image");
+				}
+			}
+			std::printf("  %s:%s\n", test.name.c_str(), status.c_str());
+		} catch (const std::exception& ex) {
+			failures.push_back(test.name + " failed: " + ex.what());
+		}
+
+		current.release();
+		frame = 0;
+		return ++index < cases.size();
+	});
+
+	throw_failures(failures);
+}
+
+/** Measures how long every case takes per frame at common resolutions, and writes the times to 'report.csv'.
+ *
+ * Creating and measuring a case happen on separate frames, so that libOBS ticks the new sources at least once before
+ * they are rendered. Use a software renderer (for example Mesa llvmpipe through LIBGL_ALWAYS_SOFTWARE=1) to compare
+ * machines without a GPU.
+ */
+TEST_CASE(benchmark, true)
+{
+	auto cases = get_cases();
+	TEST_ASSERT(!cases.empty());
+
+	std::pair<uint32_t, uint32_t> resolutions[]    = {{1280, 720}, {1920, 1080}, {3840, 2160}};
+	constexpr std::size_t         resolution_count = sizeof(resolutions) / sizeof(resolutions[0]);
+
+	std::ofstream csv(get_options().output / "report.csv", std::ios::trunc);
+	csv.imbue(std::locale::classic());
+	csv << "Case,Width,Height,Best (ms),Median (ms)\n";
+
+	std::vector<std::string> failures;
+	std::size_t              index   = 0;
+	bool                     created = false;
+	scene                    current;
+	pattern_factory::initialize();
+	std::printf("  %-36s %10s %10s\n", "Case", "Best", "Median");
+	run_per_frame([&]() {
+		auto&       test   = cases[index / resolution_count];
+		auto        size   = resolutions[index % resolution_count];
+		std::string name   = test.name + "-" + std::to_string(size.first) + "x" + std::to_string(size.second);
+		uint32_t    width  = size.first;
+		uint32_t    height = size.second;
+
+		try {
+			if (!created) {
+				current.create(test, width, height);
+				created = true;
+				return true;
+			}
+
+			for (std::size_t frame = 0; frame < WARMUP_FRAMES; frame++) {
+				current.render(width, height);
+			}
+			current.read_back(width, height);
+
+			std::vector<double_t> batches;
+			for (std::size_t batch = 0; batch < BATCHES; batch++) {
+				auto start = std::chrono::high_resolution_clock::now();
+				for (std::size_t frame = 0; frame < BATCH_FRAMES; frame++) {
+					current.render(width, height);
+				}
+				current.read_back(width, height);
+				std::chrono::duration<double_t, std::milli> time = std::chrono::high_resolution_clock::now() - start;
+				batches.push_back(time.count() / BATCH_FRAMES);
+			}
+			std::sort(batches.begin(), batches.end());
+
+			double_t best   = batches.front();
+			double_t median = batches[batches.size() / 2];
+			std::printf("  %-36s %8.3fms %8.3fms\n", name.c_str(), best, median);
+			csv << name << "," << width << "," << height << "," << best << "," << median << "\n";
+			write_pam(get_options().output / (name + ".pam"), width, height, current.get_pixels());
+		} catch (const std::exception& ex) {
+			failures.push_back(name + " failed: " + ex.what());
+		}
+
+		current.release();
+		created = false;
+		return ++index < (cases.size() * resolution_count);
+	});
+
+	throw_failures(failures);
+}
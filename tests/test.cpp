@@ -0,0 +1,210 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "test.hpp"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <exception>
+#include <future>
+#include <vector>
+
+struct test_entry {
+	std::string           name;
+	bool                  graphics;
+	std::function<void()> function;
+};
+
+static std::vector<test_entry>& get_registry()
+{
+	static std::vector<test_entry> registry;
+	return registry;
+}
+
+static streamfx::test::options _options = {};
+
+streamfx::test::options const& streamfx::test::get_options()
+{
+	return _options;
+}
+
+streamfx::test::registration::registration(const char* name, bool graphics, std::function<void()> function)
+{
+	get_registry().push_back({name, graphics, function});
+}
+
+void streamfx::test::run_per_frame(std::function<bool()> step)
+{
+	struct state {
+		std::function<bool()> step;
+		std::promise<void>    done;
+		bool                  finished;
+	} data{step, {}, false};
+	auto done = data.done.get_future();
+
+	auto callback = [](void* ptr, uint32_t, uint32_t) {
+		auto* data = reinterpret_cast<state*>(ptr);
+		if (data->finished)
+			return;
+
+		try {
+			if (data->step())
+				return;
+			data->done.set_value();
+		} catch (...) {
+			data->done.set_exception(std::current_exception());
+		}
+		data->finished = true;
+	};
+
+	obs_add_main_render_callback(callback, &data);
+	done.wait();
+	obs_remove_main_render_callback(callback, &data);
+	done.get();
+}
+
+void streamfx::test::fail(const char* file, int line, const char* expression)
+{
+	throw failure(std::string(file) + ":" + std::to_string(line) + ": " + expression);
+}
+
+// Starts libOBS without a window, and loads the StreamFX module into it like OBS Studio would.
+static void start_obs()
+{
+	if (!obs_startup("en-US", nullptr, nullptr))
+		throw std::runtime_error("Failed to start libOBS.");
+
+	obs_video_info ovi  = {};
+	ovi.graphics_module = _options.graphics.c_str();
+	ovi.fps_num         = 60;
+	ovi.fps_den         = 1;
+	ovi.base_width      = 1280;
+	ovi.base_height     = 720;
+	ovi.output_width    = 1280;
+	ovi.output_height   = 720;
+	ovi.output_format   = VIDEO_FORMAT_RGBA;
+	ovi.adapter         = 0;
+	ovi.gpu_conversion  = false;
+	ovi.colorspace      = VIDEO_CS_709;
+	ovi.range           = VIDEO_RANGE_PARTIAL;
+	ovi.scale_type      = OBS_SCALE_BILINEAR;
+	if (int error = obs_reset_video(&ovi); error != OBS_VIDEO_SUCCESS)
+		throw std::runtime_error("Failed to start graphics with '" + _options.graphics + "', error "
+								 + std::to_string(error) + ".");
+
+	obs_module_t* module = nullptr;
+	std::string   file   = _options.module.u8string();
+	std::string   data   = _options.data.u8string();
+	if (obs_open_module(&module, file.c_str(), data.c_str()) != MODULE_SUCCESS)
+		throw std::runtime_error("Failed to open '" + file + "'.");
+	if (!obs_init_module(module))
+		throw std::runtime_error("Failed to load '" + file + "'.");
+	obs_post_load_modules();
+}
+
+static std::filesystem::path next_value(int& idx, int argc, const char* argv[])
+{
+	if (++idx >= argc)
+		throw std::invalid_argument(std::string("Missing value for '") + argv[idx - 1] + "'.");
+	return std::filesystem::u8path(argv[idx]);
+}
+
+static void print_usage()
+{
+	std::printf("Usage: [--module <file>] [--data <directory>] [--graphics <module>] [--tests <directory>]\n"
+				"       [--update-golden] [--output <directory>] [--list] [test ...]\n"
+				"Runs all tests if none are named.\n");
+}
+
+int main(int argc, const char* argv[])
+try {
+	_options.graphics      = "libobs-opengl";
+	_options.update_golden = false;
+	_options.output        = std::filesystem::current_path();
+
+	std::vector<std::string> names;
+	for (int idx = 1; idx < argc; idx++) {
+		std::string arg   = argv[idx];
+		auto        value = [&idx, argc, argv]() { return next_value(idx, argc, argv); };
+
+		if (arg == "--module") {
+			_options.module = value();
+		} else if (arg == "--data") {
+			_options.data = value();
+		} else if (arg == "--graphics") {
+			_options.graphics = value().u8string();
+		} else if (arg == "--tests") {
+			_options.tests = value();
+		} else if (arg == "--update-golden") {
+			_options.update_golden = true;
+		} else if (arg == "--output") {
+			_options.output = value();
+		} else if (arg == "--list") {
+			for (auto& entry : get_registry()) {
+				std::printf("%s\n", entry.name.c_str());
+			}
+			return 0;
+		} else if ((arg == "--help") || (arg.substr(0, 2) == "--")) {
+			print_usage();
+			return (arg == "--help") ? 0 : 1;
+		} else {
+			names.push_back(arg);
+		}
+	}
+
+	std::vector<test_entry const*> tests;
+	for (auto& entry : get_registry()) {
+		if (names.empty() || (std::find(names.begin(), names.end(), entry.name) != names.end()))
+			tests.push_back(&entry);
+	}
+	if (tests.empty() || (!names.empty() && (tests.size() != names.size()))) {
+		std::printf("Unknown test, use --list to list them.\n");
+		return 1;
+	}
+	std::filesystem::create_directories(_options.output);
+
+	bool graphics = std::any_of(tests.begin(), tests.end(), [](test_entry const* entry) { return entry->graphics; });
+	if (graphics)
+		start_obs();
+
+	std::size_t failures = 0;
+	for (auto entry : tests) {
+		std::printf("[ RUN    ] %s\n", entry->name.c_str());
+		std::fflush(stdout);
+		try {
+			entry->function();
+			std::printf("[     OK ] %s\n", entry->name.c_str());
+		} catch (const std::exception& ex) {
+			std::printf("[ FAILED ] %s: %s\n", entry->name.c_str(), ex.what());
+			failures++;
+		}
+		std::fflush(stdout);
+	}
+
+	if (graphics)
+		obs_shutdown();
+
+	std::printf("%" PRIu64 " of %" PRIu64 " tests passed.\n", static_cast<uint64_t>(tests.size() - failures),
+				static_cast<uint64_t>(tests.size()));
+	return failures ? 1 : 0;
+} catch (const std::exception& ex) {
+	std::printf("%s\n", ex.what());
+	return 1;
+}
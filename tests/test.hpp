@@ -0,0 +1,80 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+#include "common.hpp"
+#include <filesystem>
+#include <functional>
+#include <string>
+
+namespace streamfx::test {
+	class failure : public std::runtime_error {
+		public:
+		failure(const std::string& message) : std::runtime_error(message) {}
+	};
+
+	struct options {
+		// StreamFX binary loaded into libOBS for tests that need graphics, and its data directory.
+		std::filesystem::path module;
+		std::filesystem::path data;
+
+		// Graphics module libOBS renders with, libobs-opengl so that Mesa llvmpipe can be used without a GPU.
+		std::string graphics;
+
+		// Files the tests use: golden images in 'golden', which are replaced if 'update_golden' is set, and shaders in
+		// 'shaders'.
+		std::filesystem::path tests;
+		bool                  update_golden;
+
+		// Rendered images and reports are written here.
+		std::filesystem::path output;
+	};
+
+	options const& get_options();
+
+	/** Registers a test case with the test executable.
+	 *
+	 * Tests that need graphics only run once libOBS was started headless, with the StreamFX module loaded into it.
+	 */
+	class registration {
+		public:
+		registration(const char* name, bool graphics, std::function<void()> function);
+	};
+
+	/** Call a function from the main render callback once per frame until it returns false.
+	 *
+	 * Blocks the calling thread until then, and rethrows whatever the function threw.
+	 */
+	void run_per_frame(std::function<bool()> step);
+
+	// Throws a failure naming the expression that did not hold, see TEST_ASSERT.
+	[[noreturn]] void fail(const char* file, int line, const char* expression);
+} // namespace streamfx::test
+
+#define TEST_CASE(NAME, GRAPHICS)                                                                  \
+	static void                           test_##NAME();                                           \
+	static ::streamfx::test::registration test_registration_##NAME(#NAME, GRAPHICS, &test_##NAME); \
+	static void                           test_##NAME()
+
+#define TEST_ASSERT(EXPRESSION)                                      \
+	do {                                                             \
+		if (!(EXPRESSION))                                           \
+			::streamfx::test::fail(__FILE__, __LINE__, #EXPRESSION); \
+	} while (false)